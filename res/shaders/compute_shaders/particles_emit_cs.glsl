@@ -0,0 +1,66 @@
+#version 440
+
+// One invocation per emitter that is spawning this frame
+layout (local_size_x = 64) in;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/particle_buffers.glsl"
+
+// Emitter spawn timers are run on the CPU, we just get told how many particles to spawn.
+// Must match ParticleManager::GpuEmitter
+struct Emitter {
+    vec3  Position;
+    uint  SystemIndex;
+    vec3  Velocity;
+    // The spawn timer before this frame's particles were spawned, will be <= 0
+    float FirstSpawnTime;
+    vec4  Color;
+    vec2  LifetimeRange;
+    float SpawnInterval;
+    uint  SpawnCount;
+};
+layout (std430, binding = 4) buffer b_Emitters {
+    Emitter emitters[];
+};
+
+uniform int u_EmitterCount;
+
+// See https://thebookofshaders.com/10/
+// Returns a random number between 0 and 1
+float rand(vec2 seed) {
+    return fract(sin(dot(seed, vec2(12.9898, 78.233))) * 43758.5453123);
+}
+
+void main() {
+    uint ix = gl_GlobalInvocationID.x;
+    if (ix >= uint(u_EmitterCount)) {
+        return;
+    }
+
+    Emitter emitter = emitters[ix];
+    uint system = emitter.SystemIndex;
+    float timer = emitter.FirstSpawnTime;
+
+    for (uint spawn = 0; spawn < emitter.SpawnCount; spawn++) {
+        // Pop an index from the system's free list, if the system is full we drop the particle
+        int freeSlot = atomicAdd(freeCounts[system], -1) - 1;
+        if (freeSlot < 0) {
+            atomicAdd(freeCounts[system], 1);
+            break;
+        }
+        uint index = freeIndices[systems[system].PoolOffset + uint(freeSlot)];
+
+        Particle particle;
+        particle.Position    = emitter.Position + emitter.Velocity * (-timer);
+        particle.SystemIndex = system;
+        particle.Velocity    = emitter.Velocity;
+        particle.Lifetime    = mix(emitter.LifetimeRange.x, emitter.LifetimeRange.y, rand(vec2(float(index), u_Time + timer)));
+        particle.Color       = emitter.Color;
+        particles[index] = particle;
+
+        // New particles are simulated along with the rest this frame
+        aliveIndices[atomicAdd(aliveCount, 1)] = index;
+
+        timer += emitter.SpawnInterval;
+    }
+}
@@ -0,0 +1,75 @@
+#version 440
+
+layout (local_size_x = 256) in;
+
+// The existing pool and alive list are bound to their usual slots
+#include "../fragments/particle_buffers.glsl"
+
+// The buffers we are moving the particles into
+layout (std430, binding = 9) buffer b_NewParticles {
+    Particle newParticles[];
+};
+layout (std430, binding = 10) buffer b_NewAliveList {
+    uint newAliveCount;
+    uint newAliveInstanceCount;
+    uint newAliveFirst;
+    uint newAliveBaseInstance;
+    uint newAliveIndices[];
+};
+// Maps old system indices to new ones, removed systems map to INVALID_SYSTEM
+layout (std430, binding = 11) buffer b_SystemRemap {
+    uint systemRemap[];
+};
+
+// The new free list, free counts and system table are bound to the regular slots, since
+// the old versions aren't needed
+#define INVALID_SYSTEM 0xFFFFFFFF
+
+#define PASS_MOVE_PARTICLES 0 // One invocation per old alive list entry, moves particles into their system's new range
+#define PASS_BUILD_FREE     1 // One invocation per slot in each system's range (y is the system), rebuilds the free lists
+
+uniform int u_ResizePass;
+
+void main() {
+    if (u_ResizePass == PASS_MOVE_PARTICLES) {
+        uint ix = gl_GlobalInvocationID.x;
+        if (ix >= aliveCount) {
+            return;
+        }
+
+        Particle particle = particles[aliveIndices[ix]];
+        uint system = systemRemap[particle.SystemIndex];
+        if (system == INVALID_SYSTEM) {
+            return;
+        }
+
+        // We use the live counts to pack particles into the front of each range, if the range
+        // has shrunk then the particles that don't fit are dropped
+        uint slot = atomicAdd(liveCounts[system], 1);
+        if (slot >= systems[system].PoolSize) {
+            return;
+        }
+
+        uint index = systems[system].PoolOffset + slot;
+        particle.SystemIndex = system;
+        newParticles[index] = particle;
+        newAliveIndices[atomicAdd(newAliveCount, 1)] = index;
+    } else {
+        uint slot = gl_GlobalInvocationID.x;
+        uint system = gl_GlobalInvocationID.y;
+        uint size = systems[system].PoolSize;
+        if (slot >= size) {
+            return;
+        }
+
+        // Everything after the particles we kept is free
+        uint kept = min(liveCounts[system], size);
+        if (slot >= kept) {
+            uint offset = systems[system].PoolOffset;
+            freeIndices[offset + slot - kept] = offset + slot;
+        }
+        if (slot == 0) {
+            freeCounts[system] = int(size - kept);
+        }
+    }
+}
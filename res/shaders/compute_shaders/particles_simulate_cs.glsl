@@ -0,0 +1,41 @@
+#version 440
+
+// One invocation per living particle, across all systems
+layout (local_size_x = 256) in;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/particle_buffers.glsl"
+
+void main() {
+    uint ix = gl_GlobalInvocationID.x;
+    if (ix >= aliveCount) {
+        return;
+    }
+
+    uint index = aliveIndices[ix];
+    Particle particle = particles[index];
+    SystemParams system = systems[particle.SystemIndex];
+
+    // Particles in disabled systems are frozen in place
+    if ((system.Flags & SYSTEM_FLAG_ENABLED) == 0) {
+        survivorIndices[atomicAdd(survivorCount, 1)] = index;
+        atomicAdd(liveCounts[particle.SystemIndex], 1);
+        return;
+    }
+
+    particle.Lifetime -= u_DeltaTime;
+
+    if (particle.Lifetime > 0) {
+        // Update position and apply forces
+        particle.Position += particle.Velocity * u_DeltaTime;
+        particle.Velocity += system.Gravity * u_DeltaTime;
+        particles[index] = particle;
+
+        survivorIndices[atomicAdd(survivorCount, 1)] = index;
+        atomicAdd(liveCounts[particle.SystemIndex], 1);
+    } else {
+        // Return the slot to the system's free list so it's emitters can re-use it
+        int freeSlot = atomicAdd(freeCounts[particle.SystemIndex], 1);
+        freeIndices[system.PoolOffset + uint(freeSlot)] = index;
+    }
+}
@@ -0,0 +1,103 @@
+#version 440
+
+// Each workgroup handles a block of 1024 entries, with every invocation handling a pair
+layout (local_size_x = 512) in;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/particle_buffers.glsl"
+
+// The entries that we're sorting, the key is the particle's depth from the camera
+struct SortEntry {
+    float Key;
+    uint  Index;
+};
+layout (std430, binding = 5) buffer b_SortedParticles {
+    SortEntry sorted[];
+};
+
+#define PASS_LOCAL_SORT  0 // Builds the sort keys and fully sorts each block in shared memory
+#define PASS_GLOBAL_STEP 1 // Performs a single compare and swap step for distances larger than a block
+#define PASS_LOCAL_MERGE 2 // Finishes a merge once the distances fit within a block
+
+#define BLOCK_SIZE 1024
+
+uniform int  u_SortPass;
+// The size of the bitonic sequences being merged
+uniform int u_K;
+// The distance between entries being compared, only used for global steps
+uniform int u_J;
+
+shared SortEntry s_Entries[BLOCK_SIZE];
+
+// Sorts the pair of entries into descending order, unless they're in a sequence that needs to be ascending
+void CompareSwap(inout SortEntry a, inout SortEntry b, uint globalIndex, uint k) {
+    bool descending = (globalIndex & k) == 0;
+    if ((a.Key < b.Key) == descending) {
+        SortEntry temp = a;
+        a = b;
+        b = temp;
+    }
+}
+
+// Performs all the steps for sequence size k with distances from j down to 1 in shared memory
+void SortShared(uint k, uint j, uint blockStart) {
+    uint thread = gl_LocalInvocationID.x;
+    for (; j > 0; j >>= 1) {
+        barrier();
+        uint ix = (thread / j) * j * 2 + (thread % j);
+        CompareSwap(s_Entries[ix], s_Entries[ix + j], blockStart + ix, k);
+    }
+    barrier();
+}
+
+void main() {
+    uint thread = gl_LocalInvocationID.x;
+    uint blockStart = gl_WorkGroupID.x * BLOCK_SIZE;
+
+    switch (u_SortPass) {
+        case PASS_LOCAL_SORT:
+            // Living particles are keyed by view depth, padding entries get the smallest key so they end up last
+            for (uint ix = thread; ix < BLOCK_SIZE; ix += gl_WorkGroupSize.x) {
+                uint entry = blockStart + ix;
+                if (entry < aliveCount) {
+                    uint index = aliveIndices[entry];
+                    s_Entries[ix].Key = -(u_View * vec4(particles[index].Position, 1)).z;
+                    s_Entries[ix].Index = index;
+                } else {
+                    s_Entries[ix].Key = -3.402823466e+38;
+                    s_Entries[ix].Index = 0;
+                }
+            }
+            for (uint k = 2; k <= BLOCK_SIZE; k <<= 1) {
+                SortShared(k, k >> 1, blockStart);
+            }
+            break;
+
+        case PASS_GLOBAL_STEP:
+            {
+                uint j = uint(u_J);
+                uint pair = gl_GlobalInvocationID.x;
+                uint ix = (pair / j) * j * 2 + (pair % j);
+                SortEntry a = sorted[ix];
+                SortEntry b = sorted[ix + j];
+                CompareSwap(a, b, ix, uint(u_K));
+                sorted[ix] = a;
+                sorted[ix + j] = b;
+            }
+            return;
+
+        case PASS_LOCAL_MERGE:
+            for (uint ix = thread; ix < BLOCK_SIZE; ix += gl_WorkGroupSize.x) {
+                s_Entries[ix] = sorted[blockStart + ix];
+            }
+            SortShared(uint(u_K), BLOCK_SIZE >> 1, blockStart);
+            break;
+
+        default:
+            return;
+    }
+
+    for (uint ix = thread; ix < BLOCK_SIZE; ix += gl_WorkGroupSize.x) {
+        sorted[blockStart + ix] = s_Entries[ix];
+    }
+}
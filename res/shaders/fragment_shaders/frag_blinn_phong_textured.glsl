@@ -15,8 +15,6 @@ layout(location = 0) out vec4 frag_color;
 struct Material {
 	sampler2D Diffuse;
 	float     Shininess;
-	int		  Toggle;
-	bool	  ToggleOn;
 };
 // Create a uniform for the material
 uniform Material u_Material;
@@ -24,6 +22,14 @@ uniform Material u_Material;
 // Create a uniform for 1D LUT for ramp
 uniform sampler1D s_ToonTerm;
 
+// The lighting mode is selected by shader keywords, only one of these should be enabled at a time:
+//    LIGHTING_AMBIENT_ONLY   - no lighting, only the diffuse color
+//    LIGHTING_SPECULAR_ONLY  - only specular highlights
+//    LIGHTING_TOON           - banded diffuse lighting
+//    LIGHTING_DIFFUSE_RAMP   - full lighting, remapped through s_ToonTerm
+//    LIGHTING_SPECULAR_RAMP  - full lighting, with shininess from s_ToonTerm
+// If none are enabled, full ambient + diffuse + specular lighting is used
+
 ////////////////////////////////////////////////////////////////
 ///////////// Application Level Uniforms ///////////////////////
 ////////////////////////////////////////////////////////////////
@@ -41,56 +47,30 @@ uniform sampler1D s_ToonTerm;
 void main() {
 	// Normalize our input normal
 	vec3 normal = normalize(inNormal);
-	vec3 lightAccumulation;
 	vec3 result;
-	vec3 V = normalize(u_CamPos.xyz - inWorldPos);
-	float red = texture(s_ToonTerm, result.r).r;
-
-	lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
-
 
 	// Get the albedo from the diffuse / albedo map
 	vec4 textureColor = texture(u_Material.Diffuse, inUV);
 
-	if (u_Material.Toggle == 1) { //ambient only
-		result = inColor * textureColor.rgb;
-	}
-
-	if (u_Material.Toggle == 2) { //specular only
-		lightAccumulation = CalcSpecOnly(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
-		result = lightAccumulation;
-	}
-
-	if (u_Material.Toggle == 3) { //ambient + specular
-		// combine for the final result
-		result = lightAccumulation  * inColor * textureColor.rgb;
-	}
-
-	if (u_Material.Toggle == 4) { //toon shading 
-		lightAccumulation = CalcToonShadingOnly(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
-		result = lightAccumulation * inColor * textureColor.rgb;
-	}
-
-	if (u_Material.Toggle == 5) { //Diffuse warp/ramp
-		//lightAccumulation = CalcRampDiffuseOnly(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess, red);
-		//result = lightAccumulation * inColor * textureColor.rgb;
-		lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
-		result = lightAccumulation * inColor * textureColor.rgb;
-		if (u_Material.ToggleOn) {
-			result.r = texture(s_ToonTerm, result.r).r;
-			result.g = texture(s_ToonTerm, result.g).g;
-			result.b = texture(s_ToonTerm, result.b).b;
-		}
-	}
-
-	if (u_Material.Toggle == 6) { //Specular warp/ramp
-		if (u_Material.ToggleOn)
-			lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, texture(s_ToonTerm, inColor.r).r);
-		else 
-			lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
-		result = lightAccumulation * inColor * textureColor.rgb;	
-	}
+#if defined(LIGHTING_AMBIENT_ONLY)
+	result = inColor * textureColor.rgb;
+#elif defined(LIGHTING_SPECULAR_ONLY)
+	result = CalcSpecOnly(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
+#elif defined(LIGHTING_TOON)
+	vec3 lightAccumulation = CalcToonShadingOnly(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
+	result = lightAccumulation * inColor * textureColor.rgb;
+#elif defined(LIGHTING_SPECULAR_RAMP)
+	vec3 lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, texture(s_ToonTerm, inColor.r).r);
+	result = lightAccumulation * inColor * textureColor.rgb;
+#else
+	vec3 lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
+	result = lightAccumulation * inColor * textureColor.rgb;
+	#if defined(LIGHTING_DIFFUSE_RAMP)
+	result.r = texture(s_ToonTerm, result.r).r;
+	result.g = texture(s_ToonTerm, result.g).g;
+	result.b = texture(s_ToonTerm, result.b).b;
+	#endif
+#endif
 
 	frag_color = vec4(ColorCorrect(result), textureColor.a);
 }
-
@@ -1,10 +1,33 @@
 #version 450
 
 layout(location = 0) in vec4 fragColor;
+// The distance over which particles fade out as they approach geometry, 0 disables soft particles
+layout(location = 1) flat in float fragSoftDistance;
 
 out vec4 frag_color;
 
-void main() { 
-	frag_color = fragColor;
+#include "../fragments/frame_uniforms.glsl"
+
+// The depth buffer of the scene that the particles are drawn on top of
+layout (binding = 0) uniform sampler2D s_Depth;
+
+// Converts a value from the depth buffer into a distance from the camera
+float LinearizeDepth(float depth) {
+    float ndc = depth * 2.0 - 1.0;
+    return u_Projection[3][2] / (ndc + u_Projection[2][2]);
 }
 
+void main() { 
+	// Fade towards the edges of the point so particles look like soft blobs
+	vec2 offset = gl_PointCoord * 2.0 - 1.0;
+	float alpha = fragColor.a * clamp(1.0 - dot(offset, offset), 0.0, 1.0);
+
+	// Fade out particles that are close to intersecting the scene, to hide the hard edges
+	if (fragSoftDistance > 0.0) {
+		float sceneDepth = LinearizeDepth(texelFetch(s_Depth, ivec2(gl_FragCoord.xy), 0).r);
+		float particleDepth = LinearizeDepth(gl_FragCoord.z);
+		alpha *= clamp((sceneDepth - particleDepth) / fragSoftDistance, 0.0, 1.0);
+	}
+
+	frag_color = vec4(fragColor.rgb, alpha);
+}
@@ -7,6 +7,9 @@ uniform layout (binding=14) sampler3D s_ColorCorrection;
 // Function for applying color correction
 vec3 ColorCorrect(vec3 inputColor) {
     // If our color correction flag is set, we perform the color lookup
+    // NOTE: this is deliberately not a shader keyword. The flag is frame level state that is the same
+    // for every fragment of every draw, so the branch never diverges, while a keyword would need a
+    // variant of every shader that includes this file to be compiled and swapped whenever it's toggled
     if (IsFlagSet(FLAG_ENABLE_COLOR_CORRECTION)) {
         return texture(s_ColorCorrection, inputColor).rgb;
     }
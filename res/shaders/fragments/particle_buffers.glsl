@@ -0,0 +1,66 @@
+// Shared layout for the particle simulation buffers, see ParticleManager
+struct Particle {
+    vec3  Position;
+    // The index of the system that owns this particle in b_Systems
+    uint  SystemIndex;
+    vec3  Velocity;
+    float Lifetime;
+    vec4  Color;
+};
+
+// Per-system parameters, uploaded by the CPU every frame. Must match ParticleManager::SystemParams
+struct SystemParams {
+    vec3  Gravity;
+    // The range of the pool (and free list) that belongs to this system
+    uint  PoolOffset;
+    uint  PoolSize;
+    float SoftDistance;
+    uint  Flags;
+    uint  Padding;
+};
+
+#define SYSTEM_FLAG_ENABLED (1 << 0)
+
+// The pool that all particles live in, particles are only accessed via the alive and free lists
+layout (std430, binding = 0) buffer b_Particles {
+    Particle particles[];
+};
+
+// Indices into the pool that are not in use, each system owns the range of the free list that
+// matches it's range in the pool. Spawning pops from the end and dying pushes to the end
+layout (std430, binding = 1) buffer b_FreeList {
+    uint freeIndices[];
+};
+
+// Indices of living particles at the start of the frame, the header doubles as the
+// arguments for glDrawArraysIndirect so that the GPU can tell itself how many particles to draw
+layout (std430, binding = 2) buffer b_AliveList {
+    uint aliveCount;
+    uint aliveInstanceCount;
+    uint aliveFirst;
+    uint aliveBaseInstance;
+    uint aliveIndices[];
+};
+
+// Indices of the particles that survived this frame's simulation
+layout (std430, binding = 3) buffer b_SurvivorList {
+    uint survivorCount;
+    uint survivorInstanceCount;
+    uint survivorFirst;
+    uint survivorBaseInstance;
+    uint survivorIndices[];
+};
+
+layout (std430, binding = 6) buffer b_Systems {
+    SystemParams systems[];
+};
+
+// The number of free slots left in each system's range of the free list
+layout (std430, binding = 7) buffer b_FreeCounts {
+    int freeCounts[];
+};
+
+// The number of particles that survived this frame in each system, for reporting
+layout (std430, binding = 8) buffer b_LiveCounts {
+    uint liveCounts[];
+};
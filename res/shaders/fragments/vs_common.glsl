@@ -5,7 +5,8 @@ layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec2 inUV;
 
-layout(location = 4) in vec3 inTangent;
+// Packed vertices don't have a bitangent, and store it's handedness in the tangent's w instead
+layout(location = 4) in vec4 inTangent;
 layout(location = 5) in vec3 inBiTangent;
 
 // Standard vertex shader outputs
@@ -17,3 +18,8 @@ layout(location = 4) out mat3 outTBN;
 
 // Include the matrices and frame level parameters
 #include "frame_uniforms.glsl"
+
+// Gets the object space bitangent, deriving it from the normal and tangent if the mesh does not store it
+vec3 GetBiTangent() {
+	return dot(inBiTangent, inBiTangent) > 0.0 ? inBiTangent : cross(inNormal, inTangent.xyz) * inTangent.w;
+}
@@ -15,8 +15,8 @@ void main() {
 	outNormal = mat3(u_NormalMatrix) * inNormal;
 
     // We use a TBN matrix for tangent space normal mapping
-    vec3 T = normalize(vec3(mat3(u_NormalMatrix) * inTangent));
-    vec3 B = normalize(vec3(mat3(u_NormalMatrix) * inBiTangent));
+    vec3 T = normalize(vec3(mat3(u_NormalMatrix) * inTangent.xyz));
+    vec3 B = normalize(vec3(mat3(u_NormalMatrix) * GetBiTangent()));
     vec3 N = normalize(vec3(mat3(u_NormalMatrix) * inNormal));
     mat3 TBN = mat3(T, B, N);
 
@@ -21,8 +21,8 @@ void main() {
 	outNormal = mat3(inNormalMatrix) * inNormal;
 
     // We use a TBN matrix for tangent space normal mapping
-    vec3 T = normalize(vec3(mat3(inNormalMatrix) * inTangent));
-    vec3 B = normalize(vec3(mat3(inNormalMatrix) * inBiTangent));
+    vec3 T = normalize(vec3(mat3(inNormalMatrix) * inTangent.xyz));
+    vec3 B = normalize(vec3(mat3(inNormalMatrix) * GetBiTangent()));
     vec3 N = normalize(vec3(mat3(inNormalMatrix) * inNormal));
     mat3 TBN = mat3(T, B, N);
 
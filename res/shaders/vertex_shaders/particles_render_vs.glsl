@@ -1,14 +1,66 @@
 #version 450
 
-layout (location = 1) in vec3  inPosition;
+#if defined(CPU_PARTICLES)
+// The CPU simulation stores each component in it's own array, so positions come in as separate attributes
+layout (location = 0) in float inPositionX;
+layout (location = 1) in float inPositionY;
+layout (location = 2) in float inPositionZ;
 layout (location = 3) in vec4  inColor;
+#endif
 
 layout (location = 0) out vec4 fragColor;
+// The soft particle distance of the system that this particle belongs to
+layout (location = 1) flat out float fragSoftDistance;
 
 #include "../fragments/frame_uniforms.glsl"
 
+#if defined(CPU_PARTICLES)
+// CPU systems are drawn one at a time, so they pass their soft distance directly
+uniform float u_SoftDistance;
+#endif
+
+#if !defined(CPU_PARTICLES)
+#include "../fragments/particle_buffers.glsl"
+#endif
+
+#if defined(SORTED_PARTICLES)
+// Particle indices sorted back to front, see particles_sort_cs.glsl
+struct SortEntry {
+    float Key;
+    uint  Index;
+};
+layout (std430, binding = 5) readonly buffer b_SortedParticles {
+    SortEntry sorted[];
+};
+#endif
+
 void main() {
-    gl_Position = u_ViewProjection * vec4(inPosition, 1);
-    fragColor = inColor;
+#if defined(CPU_PARTICLES)
+    vec3 position = vec3(inPositionX, inPositionY, inPositionZ);
+    vec4 color = inColor;
+    fragSoftDistance = u_SoftDistance;
+#else
+    // We draw one point per living particle, so the vertex ID indexes into the alive or sorted list
+    #if defined(SORTED_PARTICLES)
+    Particle particle = particles[sorted[gl_VertexID].Index];
+    #else
+    Particle particle = particles[aliveIndices[gl_VertexID]];
+    #endif
+    vec3 position = particle.Position;
+    vec4 color = particle.Color;
+    fragSoftDistance = systems[particle.SystemIndex].SoftDistance;
+
+    // All systems are drawn together, so we cull the particles of disabled systems by
+    // moving them outside of the clip volume
+    if ((systems[particle.SystemIndex].Flags & SYSTEM_FLAG_ENABLED) == 0) {
+        gl_Position = vec4(0, 0, 2, 1);
+        fragColor = vec4(0);
+        gl_PointSize = 0.0;
+        return;
+    }
+#endif
+
+    gl_Position = u_ViewProjection * vec4(position, 1);
+    fragColor = color;
     gl_PointSize = 10.0; 
-}
\ No newline at end of file
+}
@@ -12,6 +12,7 @@
 #include "Utils/FileHelpers.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/AssetCooker.h"
 
 // Graphics
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -59,6 +60,7 @@
 #include "Layers/ImGuiDebugLayer.h"
 #include "Layers/InstancedRenderingTestLayer.h"
 #include "Layers/ParticleLayer.h"
+#include "Layers/ShaderReloadLayer.h"
 
 Application* Application::_singleton = nullptr;
 std::string Application::_applicationName = "INFR-2350U - DEMO";
@@ -116,6 +118,13 @@ bool Application::LoadScene(const std::string& path) {
 	if (std::filesystem::exists(path)) { 
 
 		std::string manifestPath = std::filesystem::path(path).stem().string() + "-manifest.json";
+		#ifdef USE_COOKED_ASSETS
+		// Release builds load the manifest written by AssetCooker, so they never have to parse source assets
+		std::string cookedPath = AssetCooker::GetCookedManifestPath(manifestPath);
+		if (std::filesystem::exists(cookedPath)) {
+			manifestPath = cookedPath;
+		}
+		#endif
 		if (std::filesystem::exists(manifestPath)) {
 			LOG_INFO("Loading manifest from \"{}\"", manifestPath);
 			ResourceManager::LoadManifest(manifestPath);
@@ -159,6 +168,7 @@ void Application::_Run()
 	// If we're in editor mode, we add all the editor layers
 	if (_isEditor) {
 		_layers.push_back(std::make_shared<ImGuiDebugLayer>());
+		_layers.push_back(std::make_shared<ShaderReloadLayer>());
 	}
 
 	// Either load the settings, or use the defaults
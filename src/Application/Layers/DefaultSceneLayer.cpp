@@ -109,6 +109,16 @@ void DefaultSceneLayer::_CreateScene()
 			{ ShaderPartType::Fragment, "shaders/fragment_shaders/frag_blinn_phong_textured.glsl" }
 		});
 		basicShader->SetDebugName("Blinn-phong");
+		basicShader->AddKeyword("LIGHTING_AMBIENT_ONLY");
+		basicShader->AddKeyword("LIGHTING_SPECULAR_ONLY");
+		basicShader->AddKeyword("LIGHTING_TOON");
+		basicShader->AddKeyword("LIGHTING_DIFFUSE_RAMP");
+		basicShader->AddKeyword("LIGHTING_SPECULAR_RAMP");
+
+		// Compile the lighting variants up front so that switching modes doesn't hitch
+		for (const std::string& keyword : basicShader->GetKeywords()) {
+			basicShader->GetVariant(basicShader->GetKeywordBit(keyword));
+		}
 
 		// This shader handles our basic materials without reflections (cause they expensive)
 		ShaderProgram::Sptr specShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
@@ -207,8 +217,6 @@ void DefaultSceneLayer::_CreateScene()
 			carMaterial->Name = "Car";
 			carMaterial->Set("u_Material.Diffuse", carTexture);
 			carMaterial->Set("u_Material.Shininess", 0.1f);
-			carMaterial->Set("u_Material.Toggle", 3);
-			carMaterial->Set("u_Material.ToggleOn", false);
 			carMaterial->Set("s_ToonTerm", toonLut);  
 		}
 
@@ -217,8 +225,6 @@ void DefaultSceneLayer::_CreateScene()
 			roadMaterial->Name = "Road";
 			roadMaterial->Set("u_Material.Diffuse", roadTexture);
 			roadMaterial->Set("u_Material.Shininess", 0.1f);
-			roadMaterial->Set("u_Material.Toggle", 3);
-			roadMaterial->Set("u_Material.ToggleOn", false);
 			roadMaterial->Set("s_ToonTerm", toonLut);
 		}
 
@@ -227,8 +233,6 @@ void DefaultSceneLayer::_CreateScene()
 			autumnMaterial->Name = "Autumn";
 			autumnMaterial->Set("u_Material.Diffuse", autumnTexture);
 			autumnMaterial->Set("u_Material.Shininess", 0.1f);
-			autumnMaterial->Set("u_Material.Toggle", 3);
-			autumnMaterial->Set("u_Material.ToggleOn", false);
 			autumnMaterial->Set("s_ToonTerm", toonLut);
 		}
 
@@ -237,8 +241,6 @@ void DefaultSceneLayer::_CreateScene()
 			groundMaterial->Name = "Ground";
 			groundMaterial->Set("u_Material.Diffuse", groundTexture);
 			groundMaterial->Set("u_Material.Shininess", 0.1f);
-			groundMaterial->Set("u_Material.Toggle", 3);
-			groundMaterial->Set("u_Material.ToggleOn", false);
 			groundMaterial->Set("s_ToonTerm", toonLut);
 		}
 
@@ -247,8 +249,6 @@ void DefaultSceneLayer::_CreateScene()
 			skyMaterial->Name = "Sky"; 
 			skyMaterial->Set("u_Material.Diffuse", skyTexture);
 			skyMaterial->Set("u_Material.Shininess", 0.1f);
-			skyMaterial->Set("u_Material.Toggle", 3); 
-			skyMaterial->Set("u_Material.ToggleOn", false);
 			skyMaterial->Set("s_ToonTerm", toonLut);  
 		}
 		
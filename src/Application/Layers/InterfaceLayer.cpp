@@ -21,6 +21,7 @@ void InterfaceLayer::OnRender(const Framebuffer::Sptr& prevLayer) {
 	// We can use the application's viewport to set our OpenGL viewport, as well as clip rendering to that area
 	const glm::uvec4& viewport = app.GetPrimaryViewport();
 	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+	GuiBatcher::SetViewport(viewport);
 
 	// Disable culling
 	glDisable(GL_CULL_FACE);
@@ -1,9 +1,14 @@
 #include "ParticleLayer.h"
 #include "Gameplay/Components/ParticleSystem.h"
 #include "Application/Application.h"
+#include "Application/Layers/RenderLayer.h"
+#include "Application/Timing.h"
 
 ParticleLayer::ParticleLayer() :
-	ApplicationLayer()
+	ApplicationLayer(),
+	_manager(nullptr),
+	_systems(),
+	_sceneDepth(nullptr)
 {
 	Name = "Particles";
 	Overrides = AppLayerFunctions::OnUpdate | AppLayerFunctions::OnRender;
@@ -19,19 +24,62 @@ void ParticleLayer::OnUpdate()
 	// Only update the particle systems when the game is playing, so we can edit them in
 	// the inspector
 	if (app.CurrentScene()->IsPlaying) {
-		app.CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
-			if (system->IsEnabled) {
-				system->Update();
-			}
-		});
+		_CollectSystems();
+		_manager->Update(_systems, Timing::Current().DeltaTime());
 	}
 }
 
 void ParticleLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 {
-	Application::Get().CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
-		if (system->IsEnabled) {
-			system->Render();
-		}
-	});
+	Application& app = Application::Get();
+
+	// Sampling a depth texture that is attached to the bound framebuffer is a feedback loop even with depth
+	// writes off, so the soft particle shader reads from a copy of the scene's depth instead
+	const Framebuffer::Sptr& primary = app.GetLayer<RenderLayer>()->GetPrimaryFBO();
+	_CopySceneDepth(primary);
+	primary->Bind();
+	_sceneDepth->BindAttachment(RenderTargetAttachment::DepthStencil, 0);
+
+	// Particles are alpha blended over the scene, and test against it's depth without writing to it
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthMask(GL_FALSE);
+
+	_CollectSystems();
+	_manager->Render(_systems);
+
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+}
+
+void ParticleLayer::_CollectSystems()
+{
+	if (_manager == nullptr) {
+		_manager = std::make_unique<ParticleManager>();
+	}
+
+	// Disabled systems are passed along too, so that the manager can keep their particles around
+	_systems.clear();
+	Application::Get().CurrentScene()->Components().Each<ParticleSystem>([&](const ParticleSystem::Sptr& system) {
+		_systems.push_back(system.get());
+	}, true);
 }
+
+
+void ParticleLayer::_CopySceneDepth(const Framebuffer::Sptr& source)
+{
+	// Create or resize our copy so it always matches the primary framebuffer
+	if (_sceneDepth == nullptr) {
+		FramebufferDescriptor descriptor;
+		descriptor.Width = source->GetWidth();
+		descriptor.Height = source->GetHeight();
+		descriptor.RenderTargets[RenderTargetAttachment::DepthStencil] ={ true, RenderTargetType::DepthStencil };
+		_sceneDepth = std::make_shared<Framebuffer>(descriptor);
+		_sceneDepth->SetDebugName("ParticleSceneDepth");
+	}
+	else if (_sceneDepth->GetSize() != source->GetSize()) {
+		_sceneDepth->Resize(source->GetSize());
+	}
+
+	Framebuffer::Blit(source, _sceneDepth, BufferFlags::Depth, MagFilter::Nearest);
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "../ApplicationLayer.h"
+#include "Gameplay/Particles/ParticleManager.h"
 
 
 class ParticleLayer : public ApplicationLayer {
@@ -11,4 +12,15 @@ public:
 	void OnUpdate() override;
 	void OnRender(const Framebuffer::Sptr& prevLayer) override;
 
+protected:
+	// Shares shaders and buffers between all the particle systems in the scene, created on first use
+	// so that it's shaders are loaded after the graphics context exists
+	ParticleManager::Uptr _manager;
+	// The particle systems in the current scene, collected each update and render
+	std::vector<ParticleSystem*> _systems;
+	// A copy of the scene's depth buffer for soft particles, since they can't sample the one they're depth tested against
+	Framebuffer::Sptr _sceneDepth;
+
+	void _CollectSystems();
+	void _CopySceneDepth(const Framebuffer::Sptr& source);
 };
\ No newline at end of file
@@ -23,6 +23,7 @@ RenderLayer::RenderLayer() :
 	_frameUniforms(nullptr),
 	_instanceUniforms(nullptr),
 	_renderFlags(RenderFlags::EnableColorCorrection),
+	_drawStats(),
 	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
 {
 	Name = "Rendering";
@@ -94,6 +95,12 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	_frameUniforms->Update();
 
 	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
+	glm::vec3 cameraPos = camera->GetGameObject()->GetPosition();
+
+	_drawStats.DrawCalls = 0;
+	_drawStats.Triangles = 0;
+	_drawStats.FullDetailTriangles = 0;
+	std::fill(_drawStats.ObjectsPerLod.begin(), _drawStats.ObjectsPerLod.end(), 0);
 
 	// Render all our objects
 	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
@@ -116,7 +123,7 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 		// Note: This is a good reason why we should be sorting the render components in ComponentManager
 		if (renderable->GetMaterial() != currentMat) {
 			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
+			shader = currentMat->GetActiveShader();
 
 			shader->Bind();
 			currentMat->Apply();
@@ -132,8 +139,18 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
 		_instanceUniforms->Update();
 
-		// Draw the object
-		renderable->GetMesh()->Draw();
+		// Draw the object, using a lower detail LOD if it's far enough away that nobody will notice
+		VertexArrayObject::Sptr mesh = renderable->SelectLod(frameData.u_Projection, cameraPos, (float)_primaryFBO->GetHeight());
+		mesh->Draw();
+
+		int lod = renderable->GetCurrentLod();
+		if (lod >= (int)_drawStats.ObjectsPerLod.size()) {
+			_drawStats.ObjectsPerLod.resize(lod + 1, 0);
+		}
+		_drawStats.ObjectsPerLod[lod]++;
+		_drawStats.DrawCalls++;
+		_drawStats.Triangles += mesh->GetElementCount() / 3;
+		_drawStats.FullDetailTriangles += renderable->GetMesh()->GetElementCount() / 3;
 	});
 
 	// Use our cubemap to draw our skybox
@@ -216,3 +233,7 @@ void RenderLayer::SetRenderFlags(RenderFlags value) {
 RenderFlags RenderLayer::GetRenderFlags() const {
 	return _renderFlags;
 }
+
+const RenderLayer::DrawStats& RenderLayer::GetDrawStats() const {
+	return _drawStats;
+}
@@ -44,6 +44,16 @@ public:
 		glm::mat4 u_NormalMatrix;
 	};
 
+	// Counts of what was drawn in the last frame, so we can measure how much the LODs are saving
+	struct DrawStats {
+		uint32_t DrawCalls = 0;
+		uint32_t Triangles = 0;
+		// The triangles we would have drawn if every object used its full detail mesh
+		uint32_t FullDetailTriangles = 0;
+		// The number of objects drawn with each LOD, where 0 is the full detail mesh
+		std::vector<uint32_t> ObjectsPerLod;
+	};
+
 	RenderLayer();
 	virtual ~RenderLayer();
 
@@ -61,6 +71,11 @@ public:
 	void SetRenderFlags(RenderFlags value);
 	RenderFlags GetRenderFlags() const;
 
+	/// <summary>
+	/// Gets the draw counts from the last frame that was rendered
+	/// </summary>
+	const DrawStats& GetDrawStats() const;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
@@ -73,6 +88,7 @@ protected:
 	bool              _blitFbo;
 	glm::vec4         _clearColor;
 	RenderFlags       _renderFlags;
+	DrawStats         _drawStats;
 
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
@@ -0,0 +1,64 @@
+#include "ShaderReloadLayer.h"
+#include <algorithm>
+#include "../Timing.h"
+#include "Graphics/ShaderProgram.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+ShaderReloadLayer::ShaderReloadLayer() :
+	ApplicationLayer(),
+	_watcher(nullptr),
+	_reloading(),
+	_rescanTimer(0.0f)
+{
+	Name = "Shader Reloading";
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnUpdate;
+}
+
+ShaderReloadLayer::~ShaderReloadLayer() = default;
+
+void ShaderReloadLayer::OnAppLoad(const nlohmann::json& config)
+{
+	_watcher = std::make_unique<FileWatcher>();
+}
+
+void ShaderReloadLayer::OnUpdate()
+{
+	// Swap in any programs that have finished compiling, without waiting on the ones that haven't
+	for (auto it = _reloading.begin(); it != _reloading.end(); ) {
+		(*it)->PollReload();
+		it = (*it)->IsReloading() ? it + 1 : _reloading.erase(it);
+	}
+
+	// Shaders can be created at any time, so every so often we make sure we're watching all their files
+	_rescanTimer -= Timing::Current().UnscaledDeltaTime();
+	if (_rescanTimer <= 0.0f) {
+		_rescanTimer = 1.0f;
+		ResourceManager::Each<ShaderProgram>([&](const ShaderProgram::Sptr& shader) {
+			for (const std::string& file : shader->GetSourceFiles()) {
+				_watcher->Watch(file);
+			}
+		});
+	}
+
+	// Checking for changes is cheap, since the filesystem is polled on the watcher's thread
+	std::vector<std::string> changes = _watcher->PollChanges();
+	if (changes.empty()) {
+		return;
+	}
+
+	// Reload any shaders that depend on a modified file
+	ResourceManager::Each<ShaderProgram>([&](const ShaderProgram::Sptr& shader) {
+		for (const std::string& file : shader->GetSourceFiles()) {
+			if (std::find(changes.begin(), changes.end(), file) != changes.end()) {
+				shader->Reload();
+				if (shader->IsReloading() && std::find(_reloading.begin(), _reloading.end(), shader) == _reloading.end()) {
+					_reloading.push_back(shader);
+				}
+				break;
+			}
+		}
+	});
+
+	// A reload can pull in new includes, so we should make sure we're watching them
+	_rescanTimer = 0.0f;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "../ApplicationLayer.h"
+#include "Utils/FileWatcher.h"
+#include "Graphics/ShaderProgram.h"
+
+/**
+ * Watches the source files of all loaded shaders, and reloads shaders when
+ * they or any of the files they include are modified. Shaders keep rendering
+ * with their old programs until the new ones have finished compiling
+ */
+class ShaderReloadLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(ShaderReloadLayer)
+
+	ShaderReloadLayer();
+	virtual ~ShaderReloadLayer();
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnUpdate() override;
+
+protected:
+	FileWatcher::Uptr _watcher;
+	// Shaders that are compiling new programs, polled every frame until they are done
+	std::vector<ShaderProgram::Sptr> _reloading;
+	// Time until we next check for new shaders to watch
+	float             _rescanTimer;
+};
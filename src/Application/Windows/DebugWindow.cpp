@@ -37,4 +37,14 @@ void DebugWindow::RenderMenuBar()
 	if (changed) {
 		renderLayer->SetRenderFlags(flags);
 	}
+
+	ImGui::Separator();
+
+	// Show how many triangles the LODs are saving us, along with how many objects landed in each LOD
+	const RenderLayer::DrawStats& stats = renderLayer->GetDrawStats();
+	float saved = stats.FullDetailTriangles > 0 ? 100.0f * (1.0f - stats.Triangles / (float)stats.FullDetailTriangles) : 0.0f;
+	ImGui::Text("Draws: %u  Tris: %u / %u (%.1f%% saved)", stats.DrawCalls, stats.Triangles, stats.FullDetailTriangles, saved);
+	for (size_t ix = 0; ix < stats.ObjectsPerLod.size(); ix++) {
+		ImGui::Text(" LOD%u: %u", (uint32_t)ix, stats.ObjectsPerLod[ix]);
+	}
 }
@@ -3,12 +3,14 @@
 #include "Gameplay/GameObject.h"
 #include "Utils/ImGuiHelper.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Utils/HashedString.h"
 
 GuiPanel::GuiPanel() :
 	_borderRadius(-1),
 	_color(glm::vec4(1.0f)),
 	_texture(nullptr),
-	_transform(nullptr)
+	_transform(nullptr),
+	_geometry()
 { }
 
 GuiPanel::~GuiPanel() = default;
@@ -47,9 +49,20 @@ void GuiPanel::Awake() {
 
 void GuiPanel::StartGUI() {
 	Texture2D::Sptr tex = _texture != nullptr ? _texture : GuiBatcher::GetDefaultTexture();
-
-	GuiBatcher::PushRect(glm::vec2(0,0), _transform->GetSize(), _color, tex, _borderRadius < 0 ? GuiBatcher::GetDefaultBorderRadius() : _borderRadius);
-
+	int radius = _borderRadius < 0 ? GuiBatcher::GetDefaultBorderRadius() : _borderRadius;
+	glm::vec2 size = _transform->GetSize();
+
+	// Only re-generate the nine-slice if something that affects it has changed
+	Texture2D* texPtr = tex.get();
+	uint32_t hash = Fnv1a32(&texPtr, sizeof(Texture2D*));
+	hash = Fnv1a32(&_color, sizeof(glm::vec4), hash);
+	hash = Fnv1a32(&size, sizeof(glm::vec2), hash);
+	hash = Fnv1a32(&radius, sizeof(int), hash);
+
+	if (GuiBatcher::BeginCachedGeometry(_geometry, hash)) {
+		GuiBatcher::PushRect(glm::vec2(0,0), size, _color, tex, radius);
+		GuiBatcher::EndCachedGeometry();
+	}
 }
 
 void GuiPanel::FinishGUI() {
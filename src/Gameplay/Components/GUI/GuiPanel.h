@@ -3,6 +3,7 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/GUI/RectTransform.h"
 #include "Graphics/Textures/Texture2D.h"
+#include "Graphics/GuiBatcher.h"
 
 /// <summary>
 /// Draws a textured background for UI components
@@ -59,4 +60,7 @@ protected:
 	glm::vec4       _color;
 
 	RectTransform::Sptr _transform;
+
+	// The nine-slice quads from the last time the panel changed
+	GuiGeometryCache _geometry;
 };
\ No newline at end of file
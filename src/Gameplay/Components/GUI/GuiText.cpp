@@ -1,12 +1,10 @@
 #include "Gameplay/Components/GUI/GuiText.h"
-#include <locale>
-#include <codecvt>
 #include "Graphics/GuiBatcher.h"
 #include "Utils/ImGuiHelper.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Gameplay/GameObject.h"
-
-std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> StringConvert;
+#include "Utils/HashedString.h"
+#include "Utils/StringUtils.h"
 
 GuiText::GuiText() :
 	IComponent(),
@@ -14,7 +12,9 @@ GuiText::GuiText() :
 	_color(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)),
 	_font(nullptr),
 	_textSize(glm::vec2(0.0f)),
-	_textScale(1.0f)
+	_textScale(1.0f),
+	_transform(nullptr),
+	_geometry()
 { }
 
 GuiText::~GuiText() = default;
@@ -28,11 +28,11 @@ const glm::vec4& GuiText::GetColor() const {
 }
 
 std::string GuiText::GetText() const {
-	return StringConvert.to_bytes(_text);
+	return StringTools::WideToUtf8(_text);
 }
 
 void GuiText::SetText(const std::string& value) {
-	SetTextUnicode(StringConvert.from_bytes(value));
+	SetTextUnicode(StringTools::Utf8ToWide(value));
 }
 
 const std::wstring& GuiText::GetTextUnicode() const {
@@ -79,18 +79,33 @@ void GuiText::RenderGUI()
 	if (_font != nullptr && !_text.empty()) {
 		glm::vec2 position = _transform->GetSize() / 2.0f;
 		position -= _textSize / 2.0f;
-		GuiBatcher::RenderText(_text, _font, position, _color, _textScale);
+
+		// Most text is static, so we only lay out the glyphs again if something that affects them has changed
+		Font* font = _font.get();
+		uint32_t hash = Fnv1a32(_text.data(), _text.size() * sizeof(wchar_t));
+		hash = Fnv1a32(&font, sizeof(Font*), hash);
+		// Glyph UVs change when the font's atlas grows
+		uint32_t atlasGeneration = _font->GetAtlasGeneration();
+		hash = Fnv1a32(&atlasGeneration, sizeof(uint32_t), hash);
+		hash = Fnv1a32(&_color, sizeof(glm::vec4), hash);
+		hash = Fnv1a32(&position, sizeof(glm::vec2), hash);
+		hash = Fnv1a32(&_textScale, sizeof(float), hash);
+
+		if (GuiBatcher::BeginCachedGeometry(_geometry, hash)) {
+			GuiBatcher::RenderText(_text, _font, position, _color, _textScale);
+			GuiBatcher::EndCachedGeometry();
+		}
 	}
 }
 
 void GuiText::RenderImGui()
 {
 	static char buffer[4096];
-	std::string ascii = StringConvert.to_bytes(_text);
+	std::string ascii = StringTools::WideToUtf8(_text);
 	memcpy(buffer, ascii.data(), ascii.size());
 
 	if (LABEL_LEFT(ImGui::InputTextMultiline, "Text", buffer, 4096)) {
-		_text = StringConvert.from_bytes(buffer);
+		_text = StringTools::Utf8ToWide(buffer);
 		if (_font != nullptr) {
 			_textSize = _font->MeausureString(_text, _textScale);
 		}
@@ -2,6 +2,7 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/GUI/RectTransform.h"
 #include "Graphics/Font.h"
+#include "Graphics/GuiBatcher.h"
 
 /// <summary>
 /// Renders text for UI components
@@ -82,4 +83,7 @@ protected:
 	float           _textScale;
 
 	RectTransform::Sptr _transform;
+
+	// The glyph quads from the last time the text changed
+	GuiGeometryCache _geometry;
 };
\ No newline at end of file
@@ -12,6 +12,7 @@ RectTransform::RectTransform() :
 	_position({0.0f, 0.0f}),
 	_halfSize({0.5f, 0.5f}),
 	_rotation(0.0f),
+	_clipChildren(false),
 	_transform(glm::mat3(1.0f)),
 	_transformDirty(true)
 { }
@@ -68,6 +69,14 @@ const glm::mat3& RectTransform::GetLocalTransform() const {
 	return _transform;
 }
 
+void RectTransform::SetClipChildren(bool value) {
+	_clipChildren = value;
+}
+
+bool RectTransform::GetClipChildren() const {
+	return _clipChildren;
+}
+
 void RectTransform::RenderImGui()
 {
 	_transformDirty |= LABEL_LEFT(ImGui::DragFloat2, "Position", &_position.x, 0.01f);
@@ -88,25 +97,32 @@ void RectTransform::RenderImGui()
 	if (LABEL_LEFT(ImGui::DragFloat2, "Max     ", &temp.x, 0.1f)) {
 		SetMax(temp);
 	}
+	LABEL_LEFT(ImGui::Checkbox, "Clip    ", &_clipChildren);
 }
 
 nlohmann::json RectTransform::ToJson() const {
 	return {
 		{ "position",   _position },
 		{ "half_scale", _halfSize },
-		{ "rotation",   _rotation }
+		{ "rotation",   _rotation },
+		{ "clip",       _clipChildren }
 	};
 }
 
 void RectTransform::StartGUI() {
-	//GuiBatcher::PushScissorRect(_position - _halfSize, _position + _halfSize);
 	GuiBatcher::PushModelTransform(GetLocalTransform());
+	// The local transform puts our top left corner at the origin
+	if (_clipChildren) {
+		GuiBatcher::PushScissorRect(glm::vec2(0.0f), GetSize());
+	}
 }
 
 void RectTransform::FinishGUI()
 {
+	if (_clipChildren) {
+		GuiBatcher::PopScissorRect();
+	}
 	GuiBatcher::PopModelTransform();
-	//GuiBatcher::PopScissorRect();
 }
 
 RectTransform::Sptr RectTransform::FromJson(const nlohmann::json& blob)
@@ -115,6 +131,7 @@ RectTransform::Sptr RectTransform::FromJson(const nlohmann::json& blob)
 	result->_position = JsonGet(blob, "position", result->_position);
 	result->_halfSize = JsonGet(blob, "half_scale", result->_halfSize);
 	result->_rotation = JsonGet(blob, "rotation", 0.0f);
+	result->_clipChildren = JsonGet(blob, "clip", false);
 	return result;
 }
 
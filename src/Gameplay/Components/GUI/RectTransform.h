@@ -67,6 +67,16 @@ public:
 	/// </summary>
 	const glm::mat3& GetLocalTransform() const;
 
+	/// <summary>
+	/// Sets whether this element and it's children are clipped to the bounds of this transform,
+	/// useful for scrolling lists since children outside the bounds are skipped entirely
+	/// </summary>
+	void SetClipChildren(bool value);
+	/// <summary>
+	/// Gets whether this element and it's children are clipped to the bounds of this transform
+	/// </summary>
+	bool GetClipChildren() const;
+
 public:
 	// Inherited from IComponent
 
@@ -82,6 +92,7 @@ protected:
 	glm::vec2 _position;
 	glm::vec2 _halfSize;
 	float     _rotation;
+	bool      _clipChildren;
 
 	mutable glm::mat3 _transform;
 	mutable bool _transformDirty;
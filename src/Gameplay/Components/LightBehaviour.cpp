@@ -57,39 +57,29 @@ void LightBehaviour::Update(float deltaTime)
 	}
 
 	if (InputEngine::GetKeyState(GLFW_KEY_2) == ButtonState::Pressed) { //Ambient Lighting Only
-		_renderer->GetMaterial()->Set("u_Material.Toggle", 1);
+		_SetLightingMode("LIGHTING_AMBIENT_ONLY");
 	}
 
 	if (InputEngine::GetKeyState(GLFW_KEY_3) == ButtonState::Pressed) { //Specular Lighting Only
-		_renderer->GetMaterial()->Set("u_Material.Toggle", 2);
+		_SetLightingMode("LIGHTING_SPECULAR_ONLY");
 	}
 
 	if (InputEngine::GetKeyState(GLFW_KEY_4) == ButtonState::Pressed) { //Ambient + Specular
-		_renderer->GetMaterial()->Set("u_Material.Toggle", 3);
+		_SetLightingMode(nullptr);
 	}
 
 	if (InputEngine::GetKeyState(GLFW_KEY_5) == ButtonState::Pressed) { //Ambient + Specular CUSTOM SHADER
-		_renderer->GetMaterial()->Set("u_Material.Toggle", 4);
+		_SetLightingMode("LIGHTING_TOON");
 	}
 
 	if (InputEngine::GetKeyState(GLFW_KEY_6) == ButtonState::Pressed) { //Diffuse warp/ramp
-		_renderer->GetMaterial()->Set("u_Material.Toggle", 5);
 		warpDiffuseOn = !warpDiffuseOn;
-
-		if (warpDiffuseOn)
-			_renderer->GetMaterial()->Set("u_Material.ToggleOn", true);
-		else
-			_renderer->GetMaterial()->Set("u_Material.ToggleOn", false);
+		_SetLightingMode(warpDiffuseOn ? "LIGHTING_DIFFUSE_RAMP" : nullptr);
 	}
 
 	if (InputEngine::GetKeyState(GLFW_KEY_7) == ButtonState::Pressed) { //Spec warp/ramp
-		_renderer->GetMaterial()->Set("u_Material.Toggle", 6);
 		warpSpecOn = !warpSpecOn;
-
-		if (warpSpecOn)
-			_renderer->GetMaterial()->Set("u_Material.ToggleOn", true);
-		else
-			_renderer->GetMaterial()->Set("u_Material.ToggleOn", false);
+		_SetLightingMode(warpSpecOn ? "LIGHTING_SPECULAR_RAMP" : nullptr);
 	}
 
 	//make diffuse warp false when another button is pressed
@@ -120,3 +110,21 @@ void LightBehaviour::Update(float deltaTime)
 
 }
 
+void LightBehaviour::_SetLightingMode(const char* keyword)
+{
+	// The lighting modes are mutually exclusive, so we disable them all before enabling the
+	// selected one, to avoid compiling variants with multiple modes enabled
+	static const char* modes[] ={
+		"LIGHTING_AMBIENT_ONLY",
+		"LIGHTING_SPECULAR_ONLY",
+		"LIGHTING_TOON",
+		"LIGHTING_DIFFUSE_RAMP",
+		"LIGHTING_SPECULAR_RAMP"
+	};
+	for (const char* mode : modes) {
+		_renderer->GetMaterial()->SetKeyword(mode, false);
+	}
+	if (keyword != nullptr) {
+		_renderer->GetMaterial()->SetKeyword(keyword, true);
+	}
+}
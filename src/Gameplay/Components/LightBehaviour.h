@@ -27,6 +27,12 @@ protected:
 	float light;
 	RenderComponent::Sptr _renderer;
 	bool lightOn = true, ambientOn, warpDiffuseOn, warpSpecOn;
+
+	/// <summary>
+	/// Enables the given lighting mode keyword on our material, disabling all others
+	/// </summary>
+	/// <param name="keyword">The keyword for the lighting mode, or nullptr for the default lighting</param>
+	void _SetLightingMode(const char* keyword);
 	//Texture3D::Sptr lutWarm;
 	//Texture3D::Sptr lutCool;
 	//Texture3D::Sptr lutFilm;
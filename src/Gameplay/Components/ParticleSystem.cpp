@@ -4,178 +4,101 @@
 #include "Application/Application.h"
 #include "Utils/ImGuiHelper.h"
 
+namespace {
+	uint32_t nextSystemId = 0;
+}
+
 ParticleSystem::ParticleSystem() :
 	IComponent(),
 	_hasInit(false),
+	_id(nextSystemId++),
+	_backend(ParticleBackend::Gpu),
 	_maxParticles(1000),
 	_numParticles(0),
-	_particleBuffers(),
-	_feedbackBuffers(),
-	_query(0),
-	_currentVertexBuffer(0),
-	_currentFeedbackBuffer(1),
-	_updateShader(nullptr),
-	_renderShader(nullptr),
+	_simulationMs(0.0f),
+	_sortMs(0.0f),
+	_cpuSimulator(nullptr),
+	_cpuVertexBuffer(0),
 	_gravity({ 0, 0, -9.81f }),
+	_depthSort(true),
+	_softDistance(0.5f),
 	_emitters()
 { }
 
 ParticleSystem::~ParticleSystem()
 {
-	if (_hasInit) {
-		glDeleteBuffers(2, _particleBuffers);
-		glDeleteTransformFeedbacks(2, _feedbackBuffers);
-		glDeleteQueries(1, &_query);
-		_updateShader = nullptr;
-		_renderShader = nullptr;
+	if (_cpuVertexBuffer != 0) {
+		glDeleteBuffers(1, &_cpuVertexBuffer);
 	}
 }
 
-void ParticleSystem::Update()
+void ParticleSystem::Update(float deltaTime)
 {
-	// If we haven't previously initialized our data, initialize it now
-	if (!_hasInit) {
-		// Allocate some temp space for particles, so we can init the emitters
-		size_t dataSize = (_maxParticles + _emitters.size()) * sizeof(ParticleData);
-		ParticleData* data = new ParticleData[_maxParticles + _emitters.size()];
-		memset(data, 0, dataSize);
-
-		// Add all emitter to the the particle list at the beginning
-		for (int ix = 0; ix < _emitters.size(); ix++) {
-			data[ix] = _emitters[ix];
-		}
-
-		// We essentially use double buffering, hence the 2 buffers
-		glCreateTransformFeedbacks(2, _feedbackBuffers);
-		glCreateBuffers(2, _particleBuffers);
-
-		// Set up our first transform feedback buffer to write to the first buffer
-		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[0]);
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[0]);
-		glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[0]);
-
-		// Set up the second transform feedback buffer to write to the second buffer
-		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[1]);
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[1]);
-		glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[1]);
-
-		// We create a query object to track the number of particles we're simulating
-		glGenQueries(1, &_query);
-
-		// We no longer need the CPU copy
-		delete[] data;
+	// CPU systems step themselves with the scene, so they keep running without a graphics context. GPU
+	// systems are all simulated together by the particle manager
+	if (_backend == ParticleBackend::Cpu) {
+		_UpdateCpu(deltaTime);
 	}
+}
 
-
-	// Disable rasterization, this is update only
-	glEnable(GL_RASTERIZER_DISCARD);
-
-	// Make sure no VAOs are bound
-	glBindVertexArray(0);
-
-	// Bind the buffer and transform feedback
-	glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
-	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[_currentFeedbackBuffer]);
-
-	// Enable our attributes, aside from color since it doesn't impact simulation
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
-	glEnableVertexAttribArray(4);
-	glEnableVertexAttribArray(5);
-
-	glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ParticleData), 0); // type
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Position)); // position
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Velocity)); // velocity
-	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Color)); // color 
-	glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Lifetime)); // metadata 
-	glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Metadata)); // metadata 
-
-	// Bind the update shader and send our relevant uniforms
-	_updateShader->Bind();
-	_updateShader->SetUniform("u_Gravity", _gravity);
-
-	// Our particles are points that we're simulating
-	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, _query);
-	glBeginTransformFeedback(GL_POINTS);
-
-	// If this is our first pass, we use drawArrays to get the initial state, otherwise we use transform feedback for rendering
+void ParticleSystem::_UpdateCpu(float deltaTime)
+{
+	// The CPU simulation doesn't touch OpenGL, the vertex buffer is only created when we render
 	if (!_hasInit) {
-		glDrawArrays(GL_POINTS, 0, _emitters.size());
-	}
-	else {
-		glDrawTransformFeedback(GL_POINTS, _feedbackBuffers[_currentVertexBuffer]);
+		_cpuSimulator = std::make_unique<CpuParticleSimulator>(_maxParticles);
+		_hasInit = true;
 	}
 
-	// End of transform feedback
-	glEndTransformFeedback();
-	glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
-
-	// Use our query to get the number of particles
-	glGetQueryObjectuiv(_query, GL_QUERY_RESULT, &_numParticles);
-	if (_numParticles >= _emitters.size()) {
-		_numParticles -= _emitters.size();
-	}
-	else {
-		_numParticles = 0;
-	}
-
-	// Clean up our state
-	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
-
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(2);
-	glDisableVertexAttribArray(3);
-	glDisableVertexAttribArray(4);
-	glDisableVertexAttribArray(5);
-
-	// Re-enable rasterization for later OpenGL calls
-	glDisable(GL_RASTERIZER_DISCARD);
-
-	_hasInit = true;
-
-	// Double-buffering, swap which buffers we're operating on
-	_currentVertexBuffer = _currentFeedbackBuffer;
-	_currentFeedbackBuffer = (_currentFeedbackBuffer + 1) & 0x01;
+	_cpuSimulator->Update(_emitters, _gravity, deltaTime);
+	_numParticles = _cpuSimulator->GetParticleCount();
+	_simulationMs = _cpuSimulator->GetLastUpdateTime();
 }
 
-void ParticleSystem::Render()
+void ParticleSystem::_RenderCpu(const ShaderProgram::Sptr& shader)
 {
-	// Make sure that we've actually initialized our stuff
-	if (_hasInit) {
+	uint32_t count = _cpuSimulator->GetParticleCount();
+	if (count == 0) {
+		return;
+	}
 
-		// We're using our particle rendering shader
-		_renderShader->Bind();
+	// The vertex buffer holds each of the simulator's arrays one after another, so we can upload them without repacking
+	GLsizeiptr floatArraySize = (GLsizeiptr)_maxParticles * sizeof(float);
+	if (_cpuVertexBuffer == 0) {
+		glCreateBuffers(1, &_cpuVertexBuffer);
+		glNamedBufferData(_cpuVertexBuffer, floatArraySize * 3 + _maxParticles * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+	}
+	glNamedBufferSubData(_cpuVertexBuffer, 0,                  count * sizeof(float), _cpuSimulator->GetPositionsX());
+	glNamedBufferSubData(_cpuVertexBuffer, floatArraySize,     count * sizeof(float), _cpuSimulator->GetPositionsY());
+	glNamedBufferSubData(_cpuVertexBuffer, floatArraySize * 2, count * sizeof(float), _cpuSimulator->GetPositionsZ());
+	glNamedBufferSubData(_cpuVertexBuffer, floatArraySize * 3, count * sizeof(glm::vec4), _cpuSimulator->GetColors());
 
-		// Make sure no VAOs are bound
-		glBindVertexArray(0);
+	// The manager gives us the variant that reads particles from vertex attributes instead of the storage buffers
+	shader->Bind();
+	shader->SetUniform("u_SoftDistance"_hs, _softDistance);
 
-		// Bind the current feedback buffer as our drawing buffer
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
+	// Make sure no VAOs are bound
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, _cpuVertexBuffer);
 
-		// Enable just position and color
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Position)); // position
-		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Color)); // color 
+	for (int ix = 0; ix < 4; ix++) {
+		glEnableVertexAttribArray(ix);
+	}
+	glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), (const GLvoid*)0); // position x
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (const GLvoid*)(floatArraySize)); // position y
+	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float), (const GLvoid*)(floatArraySize * 2)); // position z
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (const GLvoid*)(floatArraySize * 3)); // color
 
-		// Draw our particles using whatever data we have in transform feedback buffer
-		glDrawTransformFeedback(GL_POINTS, _feedbackBuffers[_currentVertexBuffer]);
+	glDrawArrays(GL_POINTS, 0, count);
 
-		// Clean up after ourselves
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(3);
+	// Clean up after ourselves
+	for (int ix = 0; ix < 4; ix++) {
+		glDisableVertexAttribArray(ix);
 	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void ParticleSystem::AddEmitter(const glm::vec3& position, const glm::vec3& direction, float emitRate /*= 1.0f*/, const glm::vec4& color /*= glm::vec4(1.0f)*/)
 {
-	LOG_ASSERT(!_hasInit, "Cannot add an emitter after the particle system has been initialized");
-
 	ParticleData emitter;
 	emitter.Type     = ParticleType::Emitter; 
 	emitter.Position = position; 
@@ -187,89 +110,120 @@ void ParticleSystem::AddEmitter(const glm::vec3& position, const glm::vec3& dire
 	_emitters.push_back(emitter); 
 }
 
+void ParticleSystem::RemoveEmitter(size_t index)
+{
+	LOG_ASSERT(index < _emitters.size(), "Emitter index out of range!");
+	_emitters.erase(_emitters.begin() + index);
+}
+
+void ParticleSystem::SetEmitterPosition(size_t index, const glm::vec3& position)
+{
+	LOG_ASSERT(index < _emitters.size(), "Emitter index out of range!");
+	_emitters[index].Position = position;
+}
+
+void ParticleSystem::SetMaxParticles(uint32_t maxParticles)
+{
+	LOG_ASSERT(maxParticles > 0, "Particle systems must have room for at least one particle!");
+	if (maxParticles == _maxParticles) {
+		return;
+	}
+
+	// GPU systems are moved into their new range of the shared pool by the particle manager
+	if (_hasInit) {
+		if (_backend == ParticleBackend::Cpu) {
+			_cpuSimulator->Resize(maxParticles);
+
+			// The vertex buffer will be re-created at the new size when we next render
+			if (_cpuVertexBuffer != 0) {
+				glDeleteBuffers(1, &_cpuVertexBuffer);
+				_cpuVertexBuffer = 0;
+			}
+		}
+		LOG_INFO("Resized particle pool from {} to {} particles", _maxParticles, maxParticles);
+	}
+
+	_maxParticles = maxParticles;
+}
+
+void ParticleSystem::SetBackend(ParticleBackend backend)
+{
+	LOG_ASSERT(!_hasInit, "Cannot change the backend after the particle system has been initialized");
+	_backend = backend;
+}
+
 void ParticleSystem::RenderImGui()
 {
 	LABEL_LEFT(ImGui::LabelText, "Particle Count", "%u", _numParticles);
+	// We only resize once the user is done typing, since resizing a running system re-allocates the pool
+	int maxParticles = static_cast<int>(_maxParticles);
+	LABEL_LEFT(ImGui::InputInt, "Max Particles ", &maxParticles, 100, 1000);
+	if (ImGui::IsItemDeactivatedAfterEdit() && maxParticles > 0) {
+		SetMaxParticles(static_cast<uint32_t>(maxParticles));
+	}
+	LABEL_LEFT(ImGui::LabelText, "Sim Time (ms) ", "%.3f", _simulationMs);
+	if (_backend == ParticleBackend::Gpu && _depthSort) {
+		LABEL_LEFT(ImGui::LabelText, "Sort Time (ms)", "%.3f", _sortMs);
+	}
+
+	LABEL_LEFT(ImGui::Checkbox, "Depth Sort    ", &_depthSort);
+	LABEL_LEFT(ImGui::DragFloat, "Soft Distance ", &_softDistance, 0.01f, 0.0f);
 
-	Application& app = Application::Get();
+	// The backend can only be changed before the system is initialized
+	if (!_hasInit) {
+		int backend = (int)_backend;
+		if (LABEL_LEFT(ImGui::Combo, "Backend       ", &backend, "GPU\0CPU\0")) {
+			_backend = (ParticleBackend)backend;
+		}
+	}
 
 	ImGui::Separator();
 	ImGui::Text("Emitters:");
 
-	// We can't add or edit emitters once the system has started
-	if (!app.CurrentScene()->IsPlaying) {
-		for (int ix = 0; ix < _emitters.size(); ix++) {
-			auto& emitter = _emitters[ix];
-
-			ImGui::PushID(&emitter);
-			if (ImGui::CollapsingHeader("Emitter")) {
-				LABEL_LEFT(ImGui::DragFloat3, "Position  ", &emitter.Position.x, 0.1f);
-				LABEL_LEFT(ImGui::DragFloat3, "Velocity  ", &emitter.Velocity.x, 0.01f);
-				LABEL_LEFT(ImGui::ColorPicker4, "Color     ", &emitter.Color.x);
-				float spawnRate = 1.0f / emitter.Lifetime;
-				if (LABEL_LEFT(ImGui::DragFloat, "Spawn Rate", &spawnRate, 0.1f, 0.1f)) {
-					emitter.Lifetime = 1.0f / spawnRate;
-					emitter.Metadata.x = emitter.Lifetime;
-				}
-				glm::vec2 lifeRange = { emitter.Metadata.z, emitter.Metadata.w };
-				if (LABEL_LEFT(ImGui::DragFloat2, "Lifetime  ", &lifeRange.x, 0.1f, 0.0f)) {
-					emitter.Metadata.z = lifeRange.x;
-					emitter.Metadata.w = lifeRange.y;
-				}
-
-				if (ImGuiHelper::WarningButton("Delete")) {
-					_emitters.erase(_emitters.begin() + ix);
-					ix--;
+	for (int ix = 0; ix < _emitters.size(); ix++) {
+		auto& emitter = _emitters[ix];
+
+		ImGui::PushID(&emitter);
+		if (ImGui::CollapsingHeader("Emitter")) {
+			LABEL_LEFT(ImGui::DragFloat3, "Position  ", &emitter.Position.x, 0.1f);
+			LABEL_LEFT(ImGui::DragFloat3, "Velocity  ", &emitter.Velocity.x, 0.01f);
+			LABEL_LEFT(ImGui::ColorPicker4, "Color     ", &emitter.Color.x);
+			float spawnRate = 1.0f / emitter.Metadata.x;
+			if (LABEL_LEFT(ImGui::DragFloat, "Spawn Rate", &spawnRate, 0.1f, 0.1f)) {
+				emitter.Metadata.x = 1.0f / spawnRate;
+				// Once running, the lifetime is the emitter's spawn timer
+				if (!_hasInit) {
+					emitter.Lifetime = emitter.Metadata.x;
 				}
 			}
+			glm::vec2 lifeRange = { emitter.Metadata.z, emitter.Metadata.w };
+			if (LABEL_LEFT(ImGui::DragFloat2, "Lifetime  ", &lifeRange.x, 0.1f, 0.0f)) {
+				emitter.Metadata.z = lifeRange.x;
+				emitter.Metadata.w = lifeRange.y;
+			}
 
-			ImGui::PopID();
+			if (ImGuiHelper::WarningButton("Delete")) {
+				RemoveEmitter(ix);
+				ix--;
+			}
 		}
 
-		ImGui::Separator();
-		if (ImGui::Button("Add Emitter")) {
-			ParticleData emitter;
-			emitter.Type = ParticleType::Emitter;
-			emitter.Position = glm::vec3(0.0f);
-			emitter.Velocity = glm::vec3(0.0f);
-			emitter.Color    = glm::vec4(1.0f);
-			emitter.Lifetime = 1.0f; 
-			emitter.Metadata = { 1.0f, 0.0f, 1.0f, 1.0f };
-			_emitters.push_back(emitter);
-		}
+		ImGui::PopID();
 	}
-}
 
-void ParticleSystem::Awake()
-{
-	// There are the things we want the feedback buffers to track
-	const char const* varyings[6] = {
-		"out_Type",  
-		"out_Position",
-		"out_Velocity",
-		"out_Color", 
-		"out_Lifetime",
-		"out_Metadata" 
-	}; 
-
-	// This is our transform feedback shader
-	_updateShader = ShaderProgram::Create();
-	_updateShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_sim_vs.glsl", ShaderPartType::Vertex);
- 	_updateShader->LoadShaderPartFromFile("shaders/geometry_shaders/particle_sim_gs.glsl", ShaderPartType::Geometry);
-	_updateShader->RegisterVaryings(varyings, 6, true); // Here we call glTransformFeedbackVaryings, and let it know we want interleaved data
-	_updateShader->Link(); 
-
-	// This shader will render the particles
-	_renderShader = ShaderProgram::Create();
-	_renderShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_render_vs.glsl", ShaderPartType::Vertex);
-	_renderShader->LoadShaderPartFromFile("shaders/fragment_shaders/particles_render_fs.glsl", ShaderPartType::Fragment);
-	_renderShader->Link(); 
+	ImGui::Separator();
+	if (ImGui::Button("Add Emitter")) {
+		AddEmitter(glm::vec3(0.0f), glm::vec3(0.0f));
+	}
 }
 
 nlohmann::json ParticleSystem::ToJson() const {
 	nlohmann::json result = {
 		{ "gravity", _gravity },
-		{ "max_particles", _maxParticles }
+		{ "max_particles", _maxParticles },
+		{ "backend", ~_backend },
+		{ "depth_sort", _depthSort },
+		{ "soft_distance", _softDistance }
 	};
 
 	// Add emitters to the JSON data
@@ -278,7 +232,7 @@ nlohmann::json ParticleSystem::ToJson() const {
 		nlohmann::json blob = {
 			{ "position", emitter.Position },
 			{ "velocity", emitter.Velocity },
-			{ "spawn_rate", emitter.Lifetime },
+			{ "spawn_rate", emitter.Metadata.x },
 			{ "color", emitter.Color },
 			{ "cone_angle", emitter.Metadata.y },
 			{ "lifetime_range", glm::vec2(emitter.Metadata.z, emitter.Metadata.w) }
@@ -293,7 +247,10 @@ ParticleSystem::Sptr ParticleSystem::FromJson(const nlohmann::json& blob) {
 	ParticleSystem::Sptr result = std::make_shared<ParticleSystem>();
 
 	result->_gravity = JsonGet(blob, "gravity", result->_gravity);
-	result->_maxParticles = JsonGet(blob, "max_particled", result->_maxParticles);
+	result->_backend = JsonParseEnum(ParticleBackend, blob, "backend", ParticleBackend::Gpu);
+	result->_depthSort = JsonGet(blob, "depth_sort", result->_depthSort);
+	result->_softDistance = JsonGet(blob, "soft_distance", result->_softDistance);
+	result->_maxParticles = JsonGet(blob, "max_particles", result->_maxParticles);
 
 	if (blob.contains("emitters") && blob["emitters"].is_array()) {
 		for (const auto& data : blob["emitters"]) {
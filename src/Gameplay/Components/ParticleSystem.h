@@ -1,10 +1,16 @@
 #pragma once
 #include "Gameplay/Components/IComponent.h"
 #include "Graphics/ShaderProgram.h"
+#include "Gameplay/Particles/ParticleData.h"
+#include "Gameplay/Particles/CpuParticleSimulator.h"
 
-ENUM(ParticleType, uint32_t,
-	Emitter       = 0,
-	Particle      = 1
+/// <summary>
+/// Where a particle system is simulated, GPU systems use compute shaders, while CPU systems
+/// can run without a graphics context and can be inspected by gameplay code
+/// </summary>
+ENUM(ParticleBackend, uint32_t,
+	Gpu = 0,
+	Cpu = 1
 );
 
 class ParticleSystem : public Gameplay::IComponent{
@@ -14,46 +20,78 @@ public:
 	ParticleSystem();
 	~ParticleSystem();
 
-	void Update();
-	void Render();
-
+	/// <summary>
+	/// Adds a new emitter to this system, emitters can be added while the system is running
+	/// </summary>
 	void AddEmitter(const glm::vec3& position, const glm::vec3& direction, float emitRate = 1.0f, const glm::vec4& color = glm::vec4(1.0f));
+	/// <summary>
+	/// Removes the emitter at the given index, particles that it has already spawned will live out their lifetimes
+	/// </summary>
+	void RemoveEmitter(size_t index);
+	/// <summary>
+	/// Moves the emitter at the given index, without resetting it's spawn timer
+	/// </summary>
+	void SetEmitterPosition(size_t index, const glm::vec3& position);
+	size_t GetEmitterCount() const { return _emitters.size(); }
+
+	/// <summary>
+	/// Changes the size of the particle pool. If the system is running the living particles are moved into
+	/// the new pool, if the pool is shrinking then the particles that don't fit are removed. GPU systems
+	/// are moved by the particle manager on the next update or render
+	/// </summary>
+	void SetMaxParticles(uint32_t maxParticles);
+	uint32_t GetMaxParticles() const { return _maxParticles; }
+
+	/// <summary>
+	/// Selects where this system is simulated, must be called before the first update
+	/// </summary>
+	void SetBackend(ParticleBackend backend);
+	ParticleBackend GetBackend() const { return _backend; }
+	/// <summary>
+	/// Gets the CPU simulator for this system, so gameplay code can read particle data.
+	/// Will be nullptr for GPU systems, or before the first update
+	/// </summary>
+	const CpuParticleSimulator* GetCpuSimulator() const { return _cpuSimulator.get(); }
 
 	// Inherited from IComponent
 
+	virtual void Update(float deltaTime) override;
 	virtual void RenderImGui() override;
-	virtual void Awake() override;
 	virtual nlohmann::json ToJson() const override;
 	static ParticleSystem::Sptr FromJson(const nlohmann::json& blob);
 	MAKE_TYPENAME(ParticleSystem);
 
 protected:
-	struct ParticleData {
-		ParticleType Type;     // uint32_t, 0 for emitters, 1 for particles
-		glm::vec3    Position;
-		glm::vec3    Velocity; // For emitters, this is initial velocity
-		glm::vec4    Color;
-		float        Lifetime; // For emitters, this is the time to next particle spawn
-
-		// For emitters, x is time to next particle, y is max deviation from direction in radians, z-w is lifetime range
-		glm::vec4    Metadata;
-	};
+	// The manager owns the GPU data for all systems, and drives the update of GPU systems and the render of all systems
+	friend class ParticleManager;
 
 	bool _hasInit;
+	// Uniquely identifies this system to the particle manager, since the pointer may be re-used
+	uint32_t _id;
 
+	ParticleBackend _backend;
 	uint32_t _maxParticles;
-	GLuint _numParticles;
 
-	uint32_t _particleBuffers[2];
-	uint32_t _feedbackBuffers[2];
-	uint32_t _query;
+	// The most recent particle count that has been read back, this will be a few frames stale for GPU systems
+	uint32_t _numParticles;
+	// The most recent time spent in simulation and sorting, in milliseconds. GPU systems are simulated
+	// together, so these will be the times for all GPU systems
+	float    _simulationMs;
+	float    _sortMs;
 
-	uint32_t _currentVertexBuffer;
-	uint32_t _currentFeedbackBuffer;
+	// Only used by the CPU backend, positions and colors are uploaded to the vertex buffer for rendering
+	CpuParticleSimulator::Uptr _cpuSimulator;
+	GLuint                     _cpuVertexBuffer;
 
-	ShaderProgram::Sptr _updateShader;
-	ShaderProgram::Sptr _renderShader;
 	glm::vec3           _gravity;
 
+	// If true, GPU particles are sorted back to front before rendering so they blend correctly
+	bool                _depthSort;
+	// The distance over which particles fade out when near scene geometry, 0 disables soft particles
+	float               _softDistance;
+
 	std::vector<ParticleData> _emitters;
+
+	void _UpdateCpu(float deltaTime);
+	void _RenderCpu(const ShaderProgram::Sptr& shader);
 };
\ No newline at end of file
@@ -3,21 +3,28 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
 
+// How far an LOD's surface can be from the full detail mesh on screen, in pixels
+const float LOD_PIXEL_ERROR = 1.0f;
+// How much further under the threshold an LOD needs to be before we switch down to it
+const float LOD_HYSTERESIS  = 0.25f;
 
 RenderComponent::RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material) :
 	_mesh(mesh), 
 	_material(material), 
+	_currentLod(0),
 	_meshBuilderParams(std::vector<MeshBuilderParam>()) 
 { }
 
 RenderComponent::RenderComponent() : 
 	_mesh(nullptr), 
 	_material(nullptr), 
+	_currentLod(0),
 	_meshBuilderParams(std::vector<MeshBuilderParam>())
 { }
 
 void RenderComponent::SetMesh(const Gameplay::MeshResource::Sptr& mesh) {
 	_mesh = mesh;
+	_currentLod = 0;
 }
 
 const Gameplay::MeshResource::Sptr& RenderComponent::GetMeshResource() const {
@@ -28,6 +35,47 @@ VertexArrayObject::Sptr RenderComponent::GetMesh() const {
 	return _mesh ? _mesh->Mesh : nullptr;
 }
 
+VertexArrayObject::Sptr RenderComponent::SelectLod(const glm::mat4& projection, const glm::vec3& cameraPos, float viewportHeight) {
+	// We need bounds to know how big the mesh is
+	if (_mesh == nullptr || _mesh->Mesh == nullptr || _mesh->Lods.empty() || !_mesh->Mesh->HasBounds() || _mesh->LodBias <= 0.0f) {
+		_currentLod = 0;
+		return GetMesh();
+	}
+
+	// LOD errors are relative to the largest dimension of the mesh, so we need to know how big that is in the world
+	const glm::mat4& transform = GetGameObject()->GetTransform();
+	glm::vec3 size = _mesh->Mesh->GetBoundsMax() - _mesh->Mesh->GetBoundsMin();
+	glm::vec3 center = glm::vec3(transform * glm::vec4((_mesh->Mesh->GetBoundsMin() + _mesh->Mesh->GetBoundsMax()) * 0.5f, 1.0f));
+	float scale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+	float extent = glm::max(size.x, glm::max(size.y, size.z)) * scale;
+
+	// Work out how many pixels a unit in world space covers at the mesh's distance, orthographic projections don't depend on distance
+	float pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+	if (projection[3][3] == 0.0f) {
+		pixelsPerUnit /= glm::max(glm::length(center - cameraPos), 0.0001f);
+	}
+	float threshold = LOD_PIXEL_ERROR * _mesh->LodBias;
+
+	// Errors go up with each LOD, so we can stop at the first one that is too big
+	int lod = 0;
+	for (size_t ix = 0; ix < _mesh->Lods.size(); ix++) {
+		float error = _mesh->Lods[ix].Error * extent * pixelsPerUnit;
+		// Moving to a lower detail LOD than we are currently at needs some extra headroom
+		float limit = (int)ix + 1 > _currentLod ? threshold * (1.0f - LOD_HYSTERESIS) : threshold;
+		if (error > limit) {
+			break;
+		}
+		lod = (int)ix + 1;
+	}
+
+	_currentLod = lod;
+	return _currentLod == 0 ? GetMesh() : _mesh->Lods[_currentLod - 1].Mesh;
+}
+
+int RenderComponent::GetCurrentLod() const {
+	return _currentLod;
+}
+
 void RenderComponent::SetMaterial(const Gameplay::Material::Sptr& mat) {
 	_material = mat;
 }
@@ -54,6 +102,10 @@ RenderComponent::Sptr RenderComponent::FromJson(const nlohmann::json& data) {
 void RenderComponent::RenderImGui() {
 	ImGui::Text("Indexed:   %s", GetMesh() != nullptr ? (_mesh->Mesh->GetIndexBuffer() != nullptr ? "true" : "false") : "N/A");
 	ImGui::Text("Triangles: %d", GetMesh() != nullptr ? (_mesh->Mesh->GetElementCount() / 3) : 0);
+	if (_mesh != nullptr && !_mesh->Lods.empty()) {
+		ImGui::Text("LOD:       %d / %d (%d triangles)", _currentLod, (int)_mesh->Lods.size(),
+					_currentLod == 0 ? _mesh->Mesh->GetElementCount() / 3 : _mesh->Lods[_currentLod - 1].Mesh->GetElementCount() / 3);
+	}
 	ImGui::Text("Source:    %s", (_mesh == nullptr || _mesh->Filename.empty()) ? "Generated" : _mesh->Filename.c_str());
 	ImGui::Separator();
 	ImGui::Text("Material:  %s", _material != nullptr ? _material->Name.c_str() : "NULL");
@@ -26,6 +26,20 @@ public:
 	/// </summary>
 	VertexArrayObject::Sptr GetMesh() const;
 	/// <summary>
+	/// Picks which of the mesh's LODs to render, based on how far the LOD's surface would be from the full detail
+	/// mesh on screen. Switching to a lower detail LOD needs some extra headroom, so objects that are right on the
+	/// threshold don't flicker back and forth between LODs
+	/// </summary>
+	/// <param name="projection">The camera's projection matrix</param>
+	/// <param name="cameraPos">The camera's position in world space</param>
+	/// <param name="viewportHeight">The height of the viewport in pixels</param>
+	/// <returns>The VAO for the selected LOD</returns>
+	VertexArrayObject::Sptr SelectLod(const glm::mat4& projection, const glm::vec3& cameraPos, float viewportHeight);
+	/// <summary>
+	/// Gets the LOD picked by the last call to SelectLod, where 0 is the full detail mesh
+	/// </summary>
+	int GetCurrentLod() const;
+	/// <summary>
 	/// Gets the material that this renderer is using
 	/// </summary>
 	const Gameplay::Material::Sptr& GetMaterial() const;
@@ -54,6 +68,8 @@ protected:
 	Gameplay::MeshResource::Sptr _mesh;
 	// The object's material
 	Gameplay::Material::Sptr      _material;
+	// The LOD we picked last frame, 0 is the full detail mesh
+	int                           _currentLod;
 
 	// If we want to use MeshFactory, we can populate this list
 	std::vector<MeshBuilderParam> _meshBuilderParams;
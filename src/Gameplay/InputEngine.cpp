@@ -1,7 +1,6 @@
 #include "Gameplay/InputEngine.h"
-#include <locale>
-#include <codecvt>
 #include "Application/Application.h"
+#include "Utils/StringUtils.h"
 
 GLFWwindow* InputEngine::__window = nullptr;
 glm::dvec2 InputEngine::__mousePos  = glm::dvec2(0.0);
@@ -57,8 +56,7 @@ std::wstring InputEngine::GetInputText() {
 }
 
 std::string InputEngine::GetInputTextAscii() {
-	static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> StringConvert;
-	return StringConvert.to_bytes(__inputText);
+	return StringTools::WideToUtf8(__inputText);
 }
 
 void InputEngine::EndFrame() {
@@ -12,6 +12,9 @@ namespace Gameplay {
 	Material::Material(const ShaderProgram::Sptr& shader) :
 		IResource(),
 		_shader(shader),
+		_variant(shader),
+		_keywordMask(0),
+		_variantRevision(shader != nullptr ? shader->GetRevision() : 0),
 		_uniforms(std::unordered_map<std::string, UniformData>())
 	{
 		_PopulateUniforms();
@@ -20,6 +23,9 @@ namespace Gameplay {
 	Material::Material() :
 		IResource(),
 		_shader(nullptr),
+		_variant(nullptr),
+		_keywordMask(0),
+		_variantRevision(0),
 		_uniforms(std::unordered_map<std::string, UniformData>())
 	{ }
 
@@ -60,13 +66,50 @@ namespace Gameplay {
 		return _shader;
 	}
 
+	const ShaderProgram::Sptr& Material::GetActiveShader() const {
+		return _variant;
+	}
+
+	void Material::SetKeyword(const std::string& keyword, bool enabled) {
+		if (_shader == nullptr) {
+			LOG_WARN("Failed to set keyword \"{}\" in material \"{}\", material has no shader", keyword, Name);
+			return;
+		}
+
+		uint32_t bit = _shader->GetKeywordBit(keyword);
+		if (bit == 0) {
+			LOG_WARN("Shader \"{}\" has no keyword \"{}\", ignoring for material \"{}\"", _shader->GetDebugName(), keyword, Name);
+			return;
+		}
+
+		uint32_t mask = enabled ? (_keywordMask | bit) : (_keywordMask & ~bit);
+		if (mask != _keywordMask) {
+			_keywordMask = mask;
+			_SelectVariant();
+		}
+	}
+
+	bool Material::IsKeywordEnabled(const std::string& keyword) const {
+		return _shader != nullptr && (_keywordMask & _shader->GetKeywordBit(keyword)) != 0;
+	}
+
 	void Material::Apply() {
-		if (_shader != nullptr) {
+		if (_variant != nullptr) {
+			// If the shader has been reloaded, our uniform locations may be out of date
+			if (_variant->GetRevision() != _variantRevision) {
+				_SelectVariant();
+			}
+
 			// Skip the reserved # of texture slots
 			int textureSlot = 0;
 			
 			// Iterate over the uniforms map
 			for (auto&[name, data] : _uniforms) {
+				// Skip uniforms that are not used by the active variant
+				if (data.Location < 0) {
+					continue;
+				}
+
 				// The typecode is basically the underlying type of the uniform
 				// ex: float, matrix, texture, etc...
 				ShaderDataTypecode typeCode = GetShaderDataTypeCode(data.Type);
@@ -85,13 +128,13 @@ namespace Gameplay {
 							ITexture::Unbind(textureSlot);
 						}
 						// Send the slot to the shader
-						_shader->SetUniform(data.Location, data.Type, &textureSlot);
+						_variant->SetUniform(data.Location, data.Type, &textureSlot);
 						textureSlot++;
 					}
 				}
 				// The uniform is a plain ol' value type, send it in
 				else {
-					_shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
+					_variant->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
 				}
 			}
 		}
@@ -105,7 +148,7 @@ namespace Gameplay {
 		ImGuiHelper::ResourceDragSource(this, Name);
 
 		if (open) {
-			ImGui::Text("Shader: %s", _shader != nullptr ? _shader->GetDebugName().c_str() : "null");
+			ImGui::Text("Shader: %s", _variant != nullptr ? _variant->GetDebugName().c_str() : "null");
 			// Draw all of our valid uniforms
 			for (auto&[key, value] : _uniforms) {
 				if (value.Location != -2 && value.Location != -1) {
@@ -132,7 +175,14 @@ namespace Gameplay {
 		result->OverrideGUID(Guid(data["guid"]));
 		result->Name = data["name"].get<std::string>();
 		result->_shader = ResourceManager::Get<ShaderProgram>(Guid(data["shader"]));
-		result->_PopulateUniforms();
+
+		// Keywords need to be resolved first, since they determine which uniforms exist
+		if (data.contains("keywords") && data["keywords"].is_array()) {
+			for (auto& keyword : data["keywords"]) {
+				result->_keywordMask |= result->_shader->GetKeywordBit(keyword.get<std::string>());
+			}
+		}
+		result->_SelectVariant();
 
 		// material specific parameters'
 		if (data.contains("parameters") && data["parameters"].is_object()) {
@@ -141,6 +191,7 @@ namespace Gameplay {
 				// Try loading a uniform from the blob, if successful, store it
 				Material::UniformData uniform = Material::UniformData::FromJson(value, key, result->_shader);
 				if (uniform.Location != -2) {
+					uniform.Location = result->_GetVariantLocation(key);
 					result->_uniforms[key] = uniform;
 				}
 			}
@@ -156,9 +207,19 @@ namespace Gameplay {
 			{ "parameters", nlohmann::json() }
 		};
 
+		// Store the enabled keywords by name, since bits may change if the shader's keywords do
+		if (_keywordMask != 0) {
+			result["keywords"] = nlohmann::json::array();
+			for (const std::string& keyword : _shader->GetKeywords()) {
+				if (_keywordMask & _shader->GetKeywordBit(keyword)) {
+					result["keywords"].push_back(keyword);
+				}
+			}
+		}
+
 		// Store all the uniforms
 		for (auto& [key, value] : _uniforms) {
-			if (value.Location != -1) {
+			if (value.Type != ShaderDataType::None) {
 				result["parameters"][key] = value.ToJson();
 			}
 		}
@@ -171,13 +232,14 @@ namespace Gameplay {
 		UniformData& data = _uniforms[name];
 		if (data.Location == -2) {
 			ShaderProgram::UniformInfo uniform;
-			if (_shader->FindUniform(name, &uniform)) {
+			if (_shader != nullptr && _shader->FindVariantUniform(name, &uniform)) {
 				// Ignoring our reserved textures
 				if (GetShaderDataTypeCode(uniform.Type) == ShaderDataTypecode::Texture && uniform.Binding >= MAX_TEXTURE_SLOTS) {
 					data.Location = -1;
 				}
 				else {
 					data = UniformData(name, _shader);
+					data.Location = _GetVariantLocation(name);
 				}
 			} else {
 				data.Location = -1;
@@ -188,12 +250,39 @@ namespace Gameplay {
 
 	void Material::_PopulateUniforms()
 	{
-		const auto& uniforms = _shader->GetUniforms();
+		const auto& uniforms = _variant->GetUniforms();
 		for (const auto& [key, value] : uniforms) {
 			_uniforms[key] = _GetUniform(key);
 		}
 	}
 
+	void Material::_SelectVariant()
+	{
+		_variant = _keywordMask == 0 ? _shader : _shader->GetVariant(_keywordMask);
+		_variantRevision = _variant->GetRevision();
+
+		// Make sure we have entries for any uniforms that only exist in this variant
+		_PopulateUniforms();
+
+		// Uniform locations can differ between variants, so we need to look them all up again
+		for (auto& [key, value] : _uniforms) {
+			if (value.Type != ShaderDataType::None) {
+				ShaderProgram::UniformInfo uniform;
+				// If the uniform's type was changed in a reload, our stored value is no longer valid
+				if (_shader->FindVariantUniform(key, &uniform) && uniform.Type != value.Type) {
+					value = UniformData(key, _shader);
+				}
+				value.Location = _GetVariantLocation(key);
+			}
+		}
+	}
+
+	int Material::_GetVariantLocation(const std::string& name)
+	{
+		ShaderProgram::UniformInfo uniform;
+		return _variant->FindUniform(name, &uniform) ? uniform.Location : -1;
+	}
+
 	bool Material::UniformData::RenderImGui() {
 		ImGui::PushID(Name.c_str());
 
@@ -403,7 +492,7 @@ namespace Gameplay {
 	{
 		// We extract the uniform info from the shader to populate our info
 		ShaderProgram::UniformInfo uniform;
-		if (shader != nullptr && shader->FindUniform(uniformName, &uniform)) {
+		if (shader != nullptr && shader->FindVariantUniform(uniformName, &uniform)) {
 			Name = uniformName;
 			Location = uniform.Location;
 			Type = uniform.Type;
@@ -59,6 +59,24 @@ namespace Gameplay {
 		/// Gets the shader that this material is using
 		/// </summary>
 		const ShaderProgram::Sptr& GetShader() const;
+		/// <summary>
+		/// Gets the shader variant that this material will render with, based on
+		/// the keywords that are enabled for the material
+		/// </summary>
+		const ShaderProgram::Sptr& GetActiveShader() const;
+
+		/// <summary>
+		/// Enables or disables a shader keyword for this material, selecting which
+		/// variant of the shader the material will render with
+		/// </summary>
+		/// <param name="keyword">The name of the keyword, must be registered with the shader</param>
+		/// <param name="enabled">True to enable the keyword, false to disable it</param>
+		void SetKeyword(const std::string& keyword, bool enabled);
+		/// <summary>
+		/// Returns true if the given shader keyword is enabled for this material
+		/// </summary>
+		/// <param name="keyword">The name of the keyword to check</param>
+		bool IsKeywordEnabled(const std::string& keyword) const;
 
 		/// <summary>
 		/// Handles applying this material's state to the OpenGL pipeline
@@ -171,11 +189,33 @@ namespace Gameplay {
 		/// </summary>
 		ShaderProgram::Sptr    _shader;
 		/// <summary>
+		/// The variant of the shader selected by our keywords, or the shader itself if
+		/// no keywords are enabled
+		/// </summary>
+		ShaderProgram::Sptr    _variant;
+		/// <summary>
+		/// The mask of keywords that are enabled for this material
+		/// </summary>
+		uint32_t               _keywordMask;
+		/// <summary>
+		/// The revision of the variant when we last looked up uniform locations
+		/// </summary>
+		uint32_t               _variantRevision;
+		/// <summary>
 		/// The uniforms that the material will be modifying
 		/// </summary>
 		std::unordered_map<std::string, UniformData> _uniforms;
 
 		UniformData& _GetUniform(const std::string& name);
 		void _PopulateUniforms();
+		/// <summary>
+		/// Selects the shader variant for our keyword mask, and updates uniform
+		/// locations to match the selected variant
+		/// </summary>
+		void _SelectVariant();
+		/// <summary>
+		/// Gets the location of a uniform in the active variant, or -1 if the variant does not use it
+		/// </summary>
+		int _GetVariantLocation(const std::string& name);
 	};
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <filesystem>
 
 #include "Utils/ObjLoader.h"
+#include "Utils/OptimizedObjLoader.h"
+#include "Utils/StringUtils.h"
 
 namespace Gameplay {
 	MeshResource::MeshResource() :
@@ -9,7 +11,11 @@ namespace Gameplay {
 		Filename(""),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		Lods(std::vector<MeshLod>()),
+		LodBias(1.0f),
+		BulletTriMesh(nullptr),
+		CollisionData(nullptr),
+		KeepCollisionData(false)
 	{ }
 
 	MeshResource::MeshResource(const std::string& filename) :
@@ -17,9 +23,14 @@ namespace Gameplay {
 		Filename(filename),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		Lods(std::vector<MeshLod>()),
+		LodBias(1.0f),
+		BulletTriMesh(nullptr),
+		CollisionData(std::make_shared<MeshCollisionData>()),
+		KeepCollisionData(false)
 	{
-		Mesh = ObjLoader::LoadFromFile(filename);
+		Mesh = ObjLoader::LoadFromFile(filename, true, CollisionData.get());
+		_FinishCollisionData();
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -36,12 +47,22 @@ namespace Gameplay {
 		} else {
 			result["filename"] = Filename.empty() ? "null" : Filename;
 		}
+		if (LodBias != 1.0f) {
+			result["lod_bias"] = LodBias;
+		}
+		if (KeepCollisionData) {
+			result["keep_collision_data"] = true;
+		}
 		return result;
 	}
 
 	MeshResource::Sptr MeshResource::FromJson(const nlohmann::json & blob)
 	{
 		MeshResource::Sptr result = std::make_shared<MeshResource>();
+		result->LodBias = JsonGet(blob, "lod_bias", 1.0f);
+		result->KeepCollisionData = JsonGet(blob, "keep_collision_data", false);
+		result->CollisionData = std::make_shared<MeshCollisionData>();
+		MeshCollisionData* collision = result->CollisionData.get();
 		if (blob.contains("params") && blob["params"].is_array()) {
 			std::vector<nlohmann::json> meshbuilderParams = blob["params"].get<std::vector<nlohmann::json>>();
 			MeshBuilder<VertexPosNormTexColTangents> mesh;
@@ -51,18 +72,31 @@ namespace Gameplay {
 				MeshFactory::AddParameterized(mesh, p);
 			}
 			MeshFactory::CalculateTBN(mesh);
+			mesh.GetCollisionData(*collision);
 			result->Mesh = mesh.Bake();
 		} else {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
 			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
 				#ifdef OPTIMIZED_OBJ_LOADER
-				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
+				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename, &result->Lods, collision, result->KeepCollisionData);
 				#else
-				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
+				// Cooked manifests point straight at binary meshes, which only the optimized loader can read
+				std::string extension = std::filesystem::path(result->Filename).extension().string();
+				StringTools::ToLower(extension);
+				if (extension == ".bin") {
+					result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename, &result->Lods, collision, result->KeepCollisionData);
+				} else {
+					result->Mesh = ObjLoader::LoadFromFile(result->Filename, true, collision);
+				}
 				#endif
 
 			}
 		}
+		// Nothing to collide with if we didn't load anything
+		if (result->Mesh == nullptr) {
+			result->CollisionData = nullptr;
+		}
+		result->_FinishCollisionData();
 		return result;
 	}
 
@@ -73,6 +107,31 @@ namespace Gameplay {
 		}
 		MeshFactory::CalculateTBN(mesh);
 		Mesh = mesh.Bake();
+		Lods.clear();
+
+		// The old collision data no longer matches the mesh
+		BulletTriMesh = nullptr;
+		CollisionData = std::make_shared<MeshCollisionData>();
+		mesh.GetCollisionData(*CollisionData);
+		_FinishCollisionData();
+	}
+
+	void MeshResource::_FinishCollisionData() {
+		if (CollisionData == nullptr) {
+			return;
+		}
+
+		// Cooked meshes come with their hull, everything else builds one now, so colliders never need to read the mesh
+		// back from the GPU. The hull is only a few dozen points, so it's cheap to keep for every mesh
+		if (CollisionData->HullVertices.empty()) {
+			CollisionData->BuildHull();
+		}
+
+		// The positions and indices are a full copy of the mesh, so we only hang on to them if they were asked for
+		if (!KeepCollisionData) {
+			CollisionData->Positions = std::vector<glm::vec3>();
+			CollisionData->Indices = std::vector<uint32_t>();
+		}
 	}
 
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
@@ -2,6 +2,8 @@
 #include "Utils/ResourceManager/IResource.h"
 #include "Graphics/VertexArrayObject.h"
 #include "Utils/MeshFactory.h"
+#include "Utils/OptimizedObjLoader.h"
+#include "Utils/MeshCollisionData.h"
 
 // bullet triangle mesh pre-declaration
 class btTriangleMesh;
@@ -40,6 +42,15 @@ namespace Gameplay {
 		/// The VAO for rendering this mesh in OpenGL
 		/// </summary>
 		VertexArrayObject::Sptr         Mesh;
+		/// <summary>
+		/// Lower detail versions of Mesh from highest to lowest detail, only binary mesh files have LODs
+		/// </summary>
+		std::vector<MeshLod>            Lods;
+		/// <summary>
+		/// Scales how much error is allowed before switching to a lower detail LOD, higher values will switch to
+		/// lower detail LODs sooner, and 0 will always use the full detail mesh
+		/// </summary>
+		float                           LodBias;
 
 
 		/// <summary>
@@ -50,6 +61,16 @@ namespace Gameplay {
 		/// Allows for bullet to generate a triangle mesh from this mesh and cache it
 		/// </summary>
 		std::shared_ptr<btTriangleMesh> BulletTriMesh;
+		/// <summary>
+		/// A CPU side copy of the mesh's convex hull, so colliders can be built without reading the mesh back
+		/// from the GPU. Also holds the mesh's triangles if KeepCollisionData was set when the mesh was loaded
+		/// </summary>
+		MeshCollisionData::Sptr         CollisionData;
+		/// <summary>
+		/// Whether to keep a CPU side copy of the mesh's triangles as well as it's hull, false by default. Convex
+		/// mesh colliders turn this on for meshes they couldn't get a hull for, so it gets saved with the scene
+		/// </summary>
+		bool                            KeepCollisionData;
 
 		/// <summary>
 		/// Generates a new mesh from the mesh builder parameters
@@ -65,5 +86,9 @@ namespace Gameplay {
 
 		virtual nlohmann::json ToJson() const override;
 		static MeshResource::Sptr FromJson(const nlohmann::json& blob);
+
+	protected:
+		// Builds the hull if we didn't load one, and frees the triangles if we don't need to keep them
+		void _FinishCollisionData();
 	};
 }
\ No newline at end of file
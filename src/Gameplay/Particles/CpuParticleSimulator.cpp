@@ -0,0 +1,250 @@
+#include "CpuParticleSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <execution>
+#include <new>
+
+// Pick the widest instruction set we've been compiled for, SSE2 is always available on x64
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define PARTICLE_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define PARTICLE_SIMD_WIDTH 4
+#else
+	#define PARTICLE_SIMD_WIDTH 1
+#endif
+
+namespace {
+	// Arrays are aligned to cache lines, which also satisfies every SIMD width we support
+	constexpr size_t   ARRAY_ALIGNMENT    = 64;
+	constexpr uint32_t ARRAY_PADDING      = ARRAY_ALIGNMENT / sizeof(float);
+	// Systems larger than this are split into chunks of this size that are updated in parallel
+	constexpr uint32_t CHUNK_SIZE         = 16384;
+	// The most particles a single emitter can spawn in one frame, matches particles_emit_cs.glsl
+	constexpr int      MAX_EMIT_PER_FRAME = 32;
+
+	#if PARTICLE_SIMD_WIDTH == 8
+	typedef __m256 vfloat;
+	inline vfloat Load(const float* ptr) { return _mm256_load_ps(ptr); }
+	inline void Store(float* ptr, vfloat value) { _mm256_store_ps(ptr, value); }
+	inline vfloat Set1(float value) { return _mm256_set1_ps(value); }
+	inline vfloat Add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+	inline vfloat Sub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+	inline vfloat Mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+	// Returns a bit for every lane with a positive lifetime
+	inline int AliveMask(vfloat lifetime) { return _mm256_movemask_ps(_mm256_cmp_ps(lifetime, _mm256_setzero_ps(), _CMP_GT_OQ)); }
+	#elif PARTICLE_SIMD_WIDTH == 4
+	typedef __m128 vfloat;
+	inline vfloat Load(const float* ptr) { return _mm_load_ps(ptr); }
+	inline void Store(float* ptr, vfloat value) { _mm_store_ps(ptr, value); }
+	inline vfloat Set1(float value) { return _mm_set1_ps(value); }
+	inline vfloat Add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+	inline vfloat Sub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+	inline vfloat Mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+	inline int AliveMask(vfloat lifetime) { return _mm_movemask_ps(_mm_cmpgt_ps(lifetime, _mm_setzero_ps())); }
+	#else
+	typedef float vfloat;
+	inline vfloat Load(const float* ptr) { return *ptr; }
+	inline void Store(float* ptr, vfloat value) { *ptr = value; }
+	inline vfloat Set1(float value) { return value; }
+	inline vfloat Add(vfloat a, vfloat b) { return a + b; }
+	inline vfloat Sub(vfloat a, vfloat b) { return a - b; }
+	inline vfloat Mul(vfloat a, vfloat b) { return a * b; }
+	inline int AliveMask(vfloat lifetime) { return lifetime > 0.0f ? 1 : 0; }
+	#endif
+
+	constexpr int ALL_ALIVE = (1 << PARTICLE_SIMD_WIDTH) - 1;
+}
+
+CpuParticleSimulator::CpuParticleSimulator(uint32_t maxParticles) :
+	_maxParticles(maxParticles),
+	_capacity(0),
+	_count(0),
+	_block(nullptr),
+	_random(std::random_device()()),
+	_lastUpdateMs(0.0f)
+{
+	_Allocate(maxParticles);
+}
+
+CpuParticleSimulator::~CpuParticleSimulator()
+{
+	::operator delete(_block, std::align_val_t(ARRAY_ALIGNMENT));
+}
+
+void CpuParticleSimulator::Resize(uint32_t maxParticles)
+{
+	// Hang on to the old arrays so we can copy the survivors over
+	float* oldBlock = _block;
+	float* oldArrays[7] = { _positionX, _positionY, _positionZ, _velocityX, _velocityY, _velocityZ, _lifetime };
+	glm::vec4* oldColor = _color;
+
+	_Allocate(maxParticles);
+	_maxParticles = maxParticles;
+	_count = std::min(_count, maxParticles);
+
+	float* newArrays[7] = { _positionX, _positionY, _positionZ, _velocityX, _velocityY, _velocityZ, _lifetime };
+	for (int ix = 0; ix < 7; ix++) {
+		memcpy(newArrays[ix], oldArrays[ix], _count * sizeof(float));
+	}
+	memcpy(_color, oldColor, _count * sizeof(glm::vec4));
+
+	::operator delete(oldBlock, std::align_val_t(ARRAY_ALIGNMENT));
+}
+
+void CpuParticleSimulator::Update(std::vector<ParticleData>& emitters, const glm::vec3& gravity, float deltaTime)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// New particles are simulated along with the rest this frame, same as the GPU path
+	_Emit(emitters, deltaTime);
+
+	if (_count <= CHUNK_SIZE) {
+		_count = _UpdateChunk(0, _count, gravity, deltaTime);
+	} else {
+		// Chunks are multiples of the SIMD width, so vectors never straddle two chunks
+		uint32_t numChunks = (_count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		std::vector<uint32_t> survivors(numChunks);
+		std::vector<uint32_t> chunks(numChunks);
+		for (uint32_t ix = 0; ix < numChunks; ix++) {
+			chunks[ix] = ix;
+		}
+
+		std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](uint32_t chunk) {
+			uint32_t begin = chunk * CHUNK_SIZE;
+			uint32_t end   = std::min(begin + CHUNK_SIZE, _count);
+			survivors[chunk] = _UpdateChunk(begin, end, gravity, deltaTime);
+		});
+
+		// Each chunk compacted in place, so we just need to close the gaps between them
+		uint32_t write = survivors[0];
+		for (uint32_t chunk = 1; chunk < numChunks; chunk++) {
+			uint32_t read = chunk * CHUNK_SIZE;
+			uint32_t count = survivors[chunk];
+			if (write != read && count > 0) {
+				for (float* arr : { _positionX, _positionY, _positionZ, _velocityX, _velocityY, _velocityZ, _lifetime }) {
+					memmove(arr + write, arr + read, count * sizeof(float));
+				}
+				memmove(_color + write, _color + read, count * sizeof(glm::vec4));
+			}
+			write += count;
+		}
+		_count = write;
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	_lastUpdateMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void CpuParticleSimulator::_Emit(std::vector<ParticleData>& emitters, float deltaTime)
+{
+	std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+	for (ParticleData& emitter : emitters) {
+		float timer = emitter.Lifetime - deltaTime;
+
+		int emitted = 0;
+		while ((timer < 0) && (emitted < MAX_EMIT_PER_FRAME)) {
+			// If the pool is full we drop the particle
+			if (_count >= _maxParticles) {
+				break;
+			}
+			uint32_t ix = _count++;
+
+			glm::vec3 position = emitter.Position + emitter.Velocity * (-timer);
+			_positionX[ix] = position.x;
+			_positionY[ix] = position.y;
+			_positionZ[ix] = position.z;
+			_velocityX[ix] = emitter.Velocity.x;
+			_velocityY[ix] = emitter.Velocity.y;
+			_velocityZ[ix] = emitter.Velocity.z;
+			_lifetime[ix]  = emitter.Metadata.z + (emitter.Metadata.w - emitter.Metadata.z) * distribution(_random);
+			_color[ix]     = emitter.Color;
+
+			timer += emitter.Metadata.x;
+			emitted++;
+		}
+
+		emitter.Lifetime = timer;
+	}
+}
+
+uint32_t CpuParticleSimulator::_UpdateChunk(uint32_t begin, uint32_t end, const glm::vec3& gravity, float deltaTime)
+{
+	const vfloat dt = Set1(deltaTime);
+	const vfloat gx = Set1(gravity.x * deltaTime);
+	const vfloat gy = Set1(gravity.y * deltaTime);
+	const vfloat gz = Set1(gravity.z * deltaTime);
+
+	uint32_t write = begin;
+	for (uint32_t ix = begin; ix < end; ix += PARTICLE_SIMD_WIDTH) {
+		vfloat lifetime = Sub(Load(_lifetime + ix), dt);
+		vfloat vx = Load(_velocityX + ix);
+		vfloat vy = Load(_velocityY + ix);
+		vfloat vz = Load(_velocityZ + ix);
+
+		// Update position and apply forces
+		Store(_lifetime + ix, lifetime);
+		Store(_positionX + ix, Add(Load(_positionX + ix), Mul(vx, dt)));
+		Store(_positionY + ix, Add(Load(_positionY + ix), Mul(vy, dt)));
+		Store(_positionZ + ix, Add(Load(_positionZ + ix), Mul(vz, dt)));
+		Store(_velocityX + ix, Add(vx, gx));
+		Store(_velocityY + ix, Add(vy, gy));
+		Store(_velocityZ + ix, Add(vz, gz));
+
+		// Fast path, if nothing has died yet and the whole vector is alive there's nothing to move
+		int alive = AliveMask(lifetime);
+		if (alive == ALL_ALIVE && write == ix && ix + PARTICLE_SIMD_WIDTH <= end) {
+			write += PARTICLE_SIMD_WIDTH;
+			continue;
+		}
+
+		// Otherwise shift the survivors down over the dead particles
+		uint32_t lanes = std::min<uint32_t>(PARTICLE_SIMD_WIDTH, end - ix);
+		for (uint32_t lane = 0; lane < lanes; lane++) {
+			if (alive & (1 << lane)) {
+				if (write != ix + lane) {
+					__Move(write, ix + lane);
+				}
+				write++;
+			}
+		}
+	}
+
+	return write - begin;
+}
+
+void CpuParticleSimulator::_Allocate(uint32_t maxParticles)
+{
+	// Pad the capacity so every array starts on a cache line, and kernels can read past the end
+	_capacity = ((maxParticles + ARRAY_PADDING - 1) / ARRAY_PADDING) * ARRAY_PADDING;
+	_capacity = std::max(_capacity, ARRAY_PADDING);
+
+	// 7 float arrays, plus 4 floats per color
+	size_t numFloats = (size_t)_capacity * 11;
+	_block = static_cast<float*>(::operator new(numFloats * sizeof(float), std::align_val_t(ARRAY_ALIGNMENT)));
+	memset(_block, 0, numFloats * sizeof(float));
+
+	_positionX = _block;
+	_positionY = _positionX + _capacity;
+	_positionZ = _positionY + _capacity;
+	_velocityX = _positionZ + _capacity;
+	_velocityY = _velocityX + _capacity;
+	_velocityZ = _velocityY + _capacity;
+	_lifetime  = _velocityZ + _capacity;
+	_color     = reinterpret_cast<glm::vec4*>(_lifetime + _capacity);
+}
+
+void CpuParticleSimulator::__Move(uint32_t dst, uint32_t src)
+{
+	_positionX[dst] = _positionX[src];
+	_positionY[dst] = _positionY[src];
+	_positionZ[dst] = _positionZ[src];
+	_velocityX[dst] = _velocityX[src];
+	_velocityY[dst] = _velocityY[src];
+	_velocityZ[dst] = _velocityZ[src];
+	_lifetime[dst]  = _lifetime[src];
+	_color[dst]     = _color[src];
+}
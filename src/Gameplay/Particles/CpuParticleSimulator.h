@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <GLM/glm.hpp>
+
+#include "Utils/Macros.h"
+#include "Gameplay/Particles/ParticleData.h"
+
+/// <summary>
+/// Simulates particles on the CPU, for when we don't have a GPU to simulate on (ex: headless servers),
+/// or need to inspect particles from gameplay code. Particles are stored as a structure of arrays so
+/// that integration can be done with SIMD, and large systems are split into chunks that are updated
+/// in parallel. Uses the same emitter model as the GPU simulation
+/// </summary>
+class CpuParticleSimulator {
+public:
+	MAKE_PTRS(CpuParticleSimulator);
+	NO_COPY(CpuParticleSimulator);
+	NO_MOVE(CpuParticleSimulator);
+
+	/// <summary>
+	/// Creates a new simulator with room for the given number of particles
+	/// </summary>
+	/// <param name="maxParticles">The maximum number of living particles</param>
+	CpuParticleSimulator(uint32_t maxParticles);
+	~CpuParticleSimulator();
+
+	/// <summary>
+	/// Spawns particles from the emitters, then integrates all living particles and removes the dead ones
+	/// </summary>
+	/// <param name="emitters">The emitters to spawn from, their spawn timers will be updated</param>
+	/// <param name="gravity">The acceleration to apply to all particles</param>
+	/// <param name="deltaTime">The time step, in seconds</param>
+	void Update(std::vector<ParticleData>& emitters, const glm::vec3& gravity, float deltaTime);
+
+	/// <summary>
+	/// Changes the maximum number of particles, keeping as many living particles as will fit
+	/// </summary>
+	/// <param name="maxParticles">The new maximum number of living particles</param>
+	void Resize(uint32_t maxParticles);
+
+	uint32_t GetParticleCount() const { return _count; }
+	uint32_t GetMaxParticles() const { return _maxParticles; }
+
+	// Component arrays, each holds GetParticleCount() living particles
+	const float* GetPositionsX() const { return _positionX; }
+	const float* GetPositionsY() const { return _positionY; }
+	const float* GetPositionsZ() const { return _positionZ; }
+	const float* GetLifetimes() const { return _lifetime; }
+	const glm::vec4* GetColors() const { return _color; }
+
+	/// <summary>
+	/// Gets the time that the last call to Update took, in milliseconds
+	/// </summary>
+	float GetLastUpdateTime() const { return _lastUpdateMs; }
+
+protected:
+	uint32_t _maxParticles;
+	// The capacity of our arrays, padded so SIMD kernels can always process full vectors
+	uint32_t _capacity;
+	uint32_t _count;
+
+	// All float arrays are allocated from a single aligned block
+	float* _block;
+	float* _positionX;
+	float* _positionY;
+	float* _positionZ;
+	float* _velocityX;
+	float* _velocityY;
+	float* _velocityZ;
+	float* _lifetime;
+	glm::vec4* _color;
+
+	std::minstd_rand _random;
+	float            _lastUpdateMs;
+
+	/// <summary>
+	/// Allocates the aligned block for the given capacity and points our arrays into it
+	/// </summary>
+	void _Allocate(uint32_t maxParticles);
+
+	/// <summary>
+	/// Appends new particles from the emitters to the end of our arrays
+	/// </summary>
+	void _Emit(std::vector<ParticleData>& emitters, float deltaTime);
+	/// <summary>
+	/// Integrates the particles in [begin, end), and compacts the survivors to the start of the range
+	/// </summary>
+	/// <returns>The number of particles that survived</returns>
+	uint32_t _UpdateChunk(uint32_t begin, uint32_t end, const glm::vec3& gravity, float deltaTime);
+
+	/// <summary>
+	/// Copies the particle at index src to index dst
+	/// </summary>
+	inline void __Move(uint32_t dst, uint32_t src);
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <EnumToString.h>
+#include <GLM/glm.hpp>
+
+ENUM(ParticleType, uint32_t,
+	Emitter       = 0,
+	Particle      = 1
+);
+
+/// <summary>
+/// The data for a single particle or emitter, shared between all of our particle backends.
+/// This is only used on the CPU, the GPU pool stores ParticleManager::GpuParticle instead, which
+/// swaps Type for the owning system's index and has no Metadata
+/// </summary>
+struct ParticleData {
+	glm::vec3    Position;
+	ParticleType Type;     // uint32_t, 0 for emitters, 1 for particles
+	glm::vec3    Velocity; // For emitters, this is initial velocity
+	float        Lifetime; // For emitters, this is the time to next particle spawn
+	glm::vec4    Color;
+
+	// For emitters, x is time to next particle, y is max deviation from direction in radians, z-w is lifetime range
+	glm::vec4    Metadata;
+};
@@ -0,0 +1,506 @@
+#include "ParticleManager.h"
+#include <algorithm>
+
+#include "Gameplay/Components/ParticleSystem.h"
+
+namespace {
+	// Must match the defines in particle_buffers.glsl and particles_resize_cs.glsl
+	constexpr uint32_t SYSTEM_FLAG_ENABLED = 1 << 0;
+	constexpr uint32_t INVALID_SYSTEM      = 0xFFFFFFFF;
+	constexpr int      PASS_MOVE_PARTICLES = 0;
+	constexpr int      PASS_BUILD_FREE     = 1;
+
+	// The most particles a single emitter can spawn in one frame, matches the CPU simulator
+	constexpr uint32_t MAX_EMIT_PER_FRAME = 32;
+}
+
+ParticleManager::ParticleManager() :
+	_emitShader(nullptr),
+	_simulateShader(nullptr),
+	_renderShader(nullptr),
+	_resizeShader(nullptr),
+	_sorter(nullptr),
+	_layout(),
+	_poolSize(0),
+	_layoutGeneration(0),
+	_particleBuffer(0),
+	_freeListBuffer(0),
+	_systemBuffer(0),
+	_freeCountBuffer(0),
+	_liveCountBuffer(0),
+	_aliveBuffers(),
+	_currentAliveBuffer(0),
+	_emitterBuffer(0),
+	_emitterCapacity(0),
+	_gpuSystems(),
+	_systemParams(),
+	_spawningEmitters(),
+	_readbackBuffer(0),
+	_readbackData(nullptr),
+	_readbackCapacity(0),
+	_readbackFences(),
+	_readbackGenerations(),
+	_timerQueries(),
+	_readbackRead(0),
+	_readbackWrite(0),
+	_particleCounts(),
+	_simulationMs(0.0f)
+{
+	// Spawns new particles from the emitters
+	_emitShader = ShaderProgram::Create();
+	_emitShader->LoadShaderPartFromFile("shaders/compute_shaders/particles_emit_cs.glsl", ShaderPartType::Compute);
+	_emitShader->Link();
+
+	// Updates living particles and returns dead ones to their system's free list
+	_simulateShader = ShaderProgram::Create();
+	_simulateShader->LoadShaderPartFromFile("shaders/compute_shaders/particles_simulate_cs.glsl", ShaderPartType::Compute);
+	_simulateShader->Link();
+
+	// Moves particles into a new layout when systems are added, removed or resized
+	_resizeShader = ShaderProgram::Create();
+	_resizeShader->LoadShaderPartFromFile("shaders/compute_shaders/particles_resize_cs.glsl", ShaderPartType::Compute);
+	_resizeShader->Link();
+
+	// This shader will render the particles
+	_renderShader = ShaderProgram::Create();
+	_renderShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_render_vs.glsl", ShaderPartType::Vertex);
+	_renderShader->LoadShaderPartFromFile("shaders/fragment_shaders/particles_render_fs.glsl", ShaderPartType::Fragment);
+	_renderShader->AddKeyword("CPU_PARTICLES");
+	_renderShader->AddKeyword("SORTED_PARTICLES");
+	_renderShader->Link();
+
+	glGenQueries(READBACK_FRAMES, _timerQueries);
+}
+
+ParticleManager::~ParticleManager()
+{
+	_DeletePool();
+	if (_emitterBuffer != 0) {
+		glDeleteBuffers(1, &_emitterBuffer);
+	}
+	for (GLsync fence : _readbackFences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+		}
+	}
+	if (_readbackBuffer != 0) {
+		glUnmapNamedBuffer(_readbackBuffer);
+		glDeleteBuffers(1, &_readbackBuffer);
+	}
+	glDeleteQueries(READBACK_FRAMES, _timerQueries);
+}
+
+void ParticleManager::Update(const std::vector<ParticleSystem*>& systems, float deltaTime)
+{
+	// CPU systems update themselves with the scene, they only share the render shader with the GPU systems
+	_CollectGpuSystems(systems);
+	if (!_SyncLayout(_gpuSystems)) {
+		return;
+	}
+	for (ParticleSystem* system : _gpuSystems) {
+		system->_hasInit = true;
+	}
+
+	// Pick up any counts the GPU has finished with, so we know if we have a slot to read this frame into.
+	// If the ring is full we skip this frame's counts rather than wait for a slot
+	_CollectReadbacks(_gpuSystems);
+	bool queueReadback = _readbackFences[_readbackWrite] == nullptr;
+
+	_UploadSystems(_gpuSystems);
+	uint32_t emitterCount = _UploadEmitters(_gpuSystems, deltaTime);
+
+	if (queueReadback) {
+		glBeginQuery(GL_TIME_ELAPSED, _timerQueries[_readbackWrite]);
+	}
+
+	// Reset the count for the list we're about to fill and the per-system counts, the GPU is the only one that
+	// reads or writes the list counts
+	uint32_t nextAliveBuffer = (_currentAliveBuffer + 1) & 0x01;
+	glClearNamedBufferSubData(_aliveBuffers[nextAliveBuffer], GL_R32UI, 0, sizeof(uint32_t), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glClearNamedBufferData(_liveCountBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	_BindBuffers();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _aliveBuffers[nextAliveBuffer]);
+
+	// Spawn new particles for every system at once, each emitter pulls slots from it's own system's free list
+	if (emitterCount > 0) {
+		_emitShader->Bind();
+		_emitShader->SetUniform("u_EmitterCount"_hs, static_cast<int>(emitterCount));
+		glDispatchCompute((emitterCount + 63) / 64, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	// Simulate all living particles, we don't know how many there are on the CPU side, so we dispatch enough
+	// for the entire pool and let invocations past the end of the alive list exit early
+	_simulateShader->Bind();
+	glDispatchCompute((_poolSize + 255) / 256, 1, 1);
+
+	// Make sure our writes are visible to the render shader, the indirect draw arguments, and the count readback
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	// Double-buffering, the survivors are next frame's alive list
+	_currentAliveBuffer = nextAliveBuffer;
+
+	if (queueReadback) {
+		glEndQuery(GL_TIME_ELAPSED);
+		_QueueReadback();
+	}
+}
+
+void ParticleManager::Render(const std::vector<ParticleSystem*>& systems)
+{
+	_CollectGpuSystems(systems);
+	if (_SyncLayout(_gpuSystems)) {
+		// Make sure any settings changed since the last update are used, even while paused
+		_UploadSystems(_gpuSystems);
+
+		bool anyEnabled = false;
+		bool depthSort = false;
+		for (ParticleSystem* system : _gpuSystems) {
+			anyEnabled |= system->IsEnabled;
+			depthSort |= system->IsEnabled && system->_depthSort;
+		}
+
+		if (anyEnabled) {
+			// Make sure no VAOs are bound, all our data comes from the storage buffers
+			glBindVertexArray(0);
+			_BindBuffers();
+
+			// All systems share one draw, so if any of them want sorting we sort everything. We sort at
+			// render time so that we're using this frame's camera
+			ShaderProgram::Sptr shader = _renderShader;
+			if (depthSort) {
+				if (_sorter == nullptr) {
+					_sorter = std::make_unique<ParticleSorter>();
+				}
+				_sorter->Sort(_poolSize);
+				_sorter->Bind();
+				shader = _renderShader->GetVariant(_renderShader->GetKeywordBit("SORTED_PARTICLES"));
+
+				for (ParticleSystem* system : _gpuSystems) {
+					system->_sortMs = _sorter->GetLastSortTime();
+				}
+			}
+
+			shader->Bind();
+
+			// The alive list header holds the number of particles to draw, so the CPU never needs to know the count
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _aliveBuffers[_currentAliveBuffer]);
+			glDrawArraysIndirect(GL_POINTS, nullptr);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		}
+	}
+
+	// CPU systems each have their own vertex data, so they are drawn one at a time
+	ShaderProgram::Sptr cpuShader = _renderShader->GetVariant(_renderShader->GetKeywordBit("CPU_PARTICLES"));
+	for (ParticleSystem* system : systems) {
+		if (system->_backend == ParticleBackend::Cpu && system->IsEnabled && system->_hasInit) {
+			system->_RenderCpu(cpuShader);
+		}
+	}
+}
+
+void ParticleManager::_CollectGpuSystems(const std::vector<ParticleSystem*>& systems)
+{
+	_gpuSystems.clear();
+	for (ParticleSystem* system : systems) {
+		if (system->_backend == ParticleBackend::Gpu) {
+			_gpuSystems.push_back(system);
+		}
+	}
+}
+
+bool ParticleManager::_SyncLayout(const std::vector<ParticleSystem*>& gpuSystems)
+{
+	// Check if any systems have been added, removed or resized since we last laid out the pool
+	bool changed = gpuSystems.size() != _layout.size();
+	for (size_t ix = 0; !changed && ix < gpuSystems.size(); ix++) {
+		changed = _layout[ix].SystemId != gpuSystems[ix]->_id || _layout[ix].PoolSize != gpuSystems[ix]->_maxParticles;
+	}
+	if (!changed) {
+		return !_layout.empty();
+	}
+
+	// Each system gets a range of the pool (and free list) that matches it's max particles
+	std::vector<SystemSlot> layout;
+	layout.reserve(gpuSystems.size());
+	uint32_t poolSize = 0;
+	uint32_t largestSystem = 0;
+	for (ParticleSystem* system : gpuSystems) {
+		layout.push_back({ system->_id, poolSize, system->_maxParticles });
+		poolSize += system->_maxParticles;
+		largestSystem = std::max(largestSystem, system->_maxParticles);
+	}
+	const GLuint systemCount = static_cast<GLuint>(layout.size());
+
+	if (layout.empty()) {
+		_DeletePool();
+		_layout.clear();
+		_poolSize = 0;
+		_layoutGeneration++;
+		return false;
+	}
+
+	GLuint particleBuffer, freeListBuffer, systemBuffer, freeCountBuffer, liveCountBuffer, aliveBuffers[2];
+	glCreateBuffers(1, &particleBuffer);
+	glCreateBuffers(1, &freeListBuffer);
+	glCreateBuffers(1, &systemBuffer);
+	glCreateBuffers(1, &freeCountBuffer);
+	glCreateBuffers(1, &liveCountBuffer);
+	glCreateBuffers(2, aliveBuffers);
+
+	glNamedBufferData(particleBuffer, poolSize * sizeof(GpuParticle), nullptr, GL_DYNAMIC_COPY);
+	glNamedBufferData(freeListBuffer, poolSize * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+	glNamedBufferData(freeCountBuffer, systemCount * sizeof(int32_t), nullptr, GL_DYNAMIC_COPY);
+	glNamedBufferData(liveCountBuffer, systemCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+	glClearNamedBufferData(liveCountBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	// Both alive lists start out empty, we only need to initialize the draw arguments in the header
+	AliveListHeader header = { 0, 1, 0, 0 };
+	for (int ix = 0; ix < 2; ix++) {
+		glNamedBufferData(aliveBuffers[ix], sizeof(AliveListHeader) + poolSize * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+		glNamedBufferSubData(aliveBuffers[ix], 0, sizeof(AliveListHeader), &header);
+	}
+
+	// The resize shader only needs the ranges from the system table, the rest is filled in before we simulate
+	std::vector<SystemParams> params(systemCount, SystemParams());
+	for (size_t ix = 0; ix < layout.size(); ix++) {
+		params[ix].PoolOffset = layout[ix].PoolOffset;
+		params[ix].PoolSize = layout[ix].PoolSize;
+	}
+	glNamedBufferData(systemBuffer, params.size() * sizeof(SystemParams), params.data(), GL_DYNAMIC_DRAW);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, freeListBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, systemBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, freeCountBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, liveCountBuffer);
+	_resizeShader->Bind();
+
+	// We can't just copy the old pool over, since the free counts only exist on the GPU and a system's new range
+	// may not line up with it's old one. Instead we pack each system's living particles into the front of it's
+	// new range on the GPU, using the live counts as per-system counters
+	if (!_layout.empty()) {
+		std::vector<uint32_t> remap(_layout.size(), INVALID_SYSTEM);
+		for (size_t oldIx = 0; oldIx < _layout.size(); oldIx++) {
+			for (size_t newIx = 0; newIx < layout.size(); newIx++) {
+				if (layout[newIx].SystemId == _layout[oldIx].SystemId) {
+					remap[oldIx] = static_cast<uint32_t>(newIx);
+					break;
+				}
+			}
+		}
+		GLuint remapBuffer = 0;
+		glCreateBuffers(1, &remapBuffer);
+		glNamedBufferData(remapBuffer, remap.size() * sizeof(uint32_t), remap.data(), GL_STREAM_DRAW);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _particleBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _aliveBuffers[_currentAliveBuffer]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, particleBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, aliveBuffers[0]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, remapBuffer);
+
+		_resizeShader->SetUniform("u_ResizePass"_hs, PASS_MOVE_PARTICLES);
+		glDispatchCompute((_poolSize + 255) / 256, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		// Deleting buffers that the GPU is still using is safe, OpenGL will hold on to them until it's done
+		glDeleteBuffers(1, &remapBuffer);
+	}
+
+	// Everything after the particles we kept goes on each system's free list
+	_resizeShader->SetUniform("u_ResizePass"_hs, PASS_BUILD_FREE);
+	glDispatchCompute((largestSystem + 255) / 256, systemCount, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	LOG_INFO("Laid out {} GPU particle systems in a shared pool of {} particles", systemCount, poolSize);
+
+	_DeletePool();
+	_particleBuffer = particleBuffer;
+	_freeListBuffer = freeListBuffer;
+	_systemBuffer = systemBuffer;
+	_freeCountBuffer = freeCountBuffer;
+	_liveCountBuffer = liveCountBuffer;
+	_aliveBuffers[0] = aliveBuffers[0];
+	_aliveBuffers[1] = aliveBuffers[1];
+	_currentAliveBuffer = 0;
+
+	_layout = std::move(layout);
+	_poolSize = poolSize;
+	_layoutGeneration++;
+	_particleCounts.assign(_layout.size(), 0);
+	_ReserveReadback(systemCount);
+
+	return true;
+}
+
+void ParticleManager::_UploadSystems(const std::vector<ParticleSystem*>& gpuSystems)
+{
+	_systemParams.resize(_layout.size());
+	for (size_t ix = 0; ix < _layout.size(); ix++) {
+		const ParticleSystem* system = gpuSystems[ix];
+		SystemParams& params = _systemParams[ix];
+		params.Gravity      = system->_gravity;
+		params.PoolOffset   = _layout[ix].PoolOffset;
+		params.PoolSize     = _layout[ix].PoolSize;
+		params.SoftDistance = system->_softDistance;
+		params.Flags        = system->IsEnabled ? SYSTEM_FLAG_ENABLED : 0;
+		params.Padding      = 0;
+	}
+	glNamedBufferSubData(_systemBuffer, 0, _systemParams.size() * sizeof(SystemParams), _systemParams.data());
+}
+
+uint32_t ParticleManager::_UploadEmitters(const std::vector<ParticleSystem*>& gpuSystems, float deltaTime)
+{
+	// The spawn timers are run here rather than on the GPU, so that only the emitters that are spawning
+	// need to be uploaded, and editing an emitter never has to work around the GPU's copy of it's timer
+	_spawningEmitters.clear();
+	for (size_t ix = 0; ix < gpuSystems.size(); ix++) {
+		if (!gpuSystems[ix]->IsEnabled) {
+			continue;
+		}
+
+		for (ParticleData& emitter : gpuSystems[ix]->_emitters) {
+			// Emitters use their lifetime as a spawn timer
+			float timer = emitter.Lifetime - deltaTime;
+			float firstSpawnTime = timer;
+			uint32_t spawnCount = 0;
+			while ((timer < 0) && (spawnCount < MAX_EMIT_PER_FRAME)) {
+				timer += emitter.Metadata.x;
+				spawnCount++;
+			}
+			emitter.Lifetime = timer;
+
+			if (spawnCount > 0) {
+				GpuEmitter spawning;
+				spawning.Position       = emitter.Position;
+				spawning.SystemIndex    = static_cast<uint32_t>(ix);
+				spawning.Velocity       = emitter.Velocity;
+				spawning.FirstSpawnTime = firstSpawnTime;
+				spawning.Color          = emitter.Color;
+				spawning.LifetimeRange  = { emitter.Metadata.z, emitter.Metadata.w };
+				spawning.SpawnInterval  = emitter.Metadata.x;
+				spawning.SpawnCount     = spawnCount;
+				_spawningEmitters.push_back(spawning);
+			}
+		}
+	}
+
+	if (_spawningEmitters.empty()) {
+		return 0;
+	}
+
+	// The emitter list is rebuilt every frame, so when it grows we can just orphan the old buffer
+	if (_spawningEmitters.size() > _emitterCapacity) {
+		_emitterCapacity = std::max(_spawningEmitters.size(), _emitterCapacity * 2);
+		if (_emitterBuffer == 0) {
+			glCreateBuffers(1, &_emitterBuffer);
+		}
+		glNamedBufferData(_emitterBuffer, _emitterCapacity * sizeof(GpuEmitter), nullptr, GL_STREAM_DRAW);
+	}
+	glNamedBufferSubData(_emitterBuffer, 0, _spawningEmitters.size() * sizeof(GpuEmitter), _spawningEmitters.data());
+
+	return static_cast<uint32_t>(_spawningEmitters.size());
+}
+
+void ParticleManager::_BindBuffers() const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _particleBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _freeListBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _aliveBuffers[_currentAliveBuffer]);
+	if (_emitterBuffer != 0) {
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _emitterBuffer);
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, _systemBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, _freeCountBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, _liveCountBuffer);
+}
+
+void ParticleManager::_DeletePool()
+{
+	if (_particleBuffer != 0) {
+		glDeleteBuffers(1, &_particleBuffer);
+		glDeleteBuffers(1, &_freeListBuffer);
+		glDeleteBuffers(1, &_systemBuffer);
+		glDeleteBuffers(1, &_freeCountBuffer);
+		glDeleteBuffers(1, &_liveCountBuffer);
+		glDeleteBuffers(2, _aliveBuffers);
+
+		_particleBuffer = 0;
+		_freeListBuffer = 0;
+		_systemBuffer = 0;
+		_freeCountBuffer = 0;
+		_liveCountBuffer = 0;
+		_aliveBuffers[0] = 0;
+		_aliveBuffers[1] = 0;
+	}
+}
+
+void ParticleManager::_CollectReadbacks(const std::vector<ParticleSystem*>& gpuSystems)
+{
+	// Collect results in the order they were queued, stopping at the first one the GPU hasn't finished
+	while (_readbackFences[_readbackRead] != nullptr) {
+		GLenum status = glClientWaitSync(_readbackFences[_readbackRead], 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+			break;
+		}
+
+		// Counts from before the last layout change are in the wrong order, so we throw them out
+		if (_readbackGenerations[_readbackRead] == _layoutGeneration) {
+			const uint32_t* counts = _readbackData + _readbackRead * _readbackCapacity;
+			std::copy(counts, counts + _layout.size(), _particleCounts.begin());
+
+			// The fence comes after the end of the query, so the result is ready and this won't block
+			GLuint64 elapsedNs = 0;
+			glGetQueryObjectui64v(_timerQueries[_readbackRead], GL_QUERY_RESULT, &elapsedNs);
+			_simulationMs = elapsedNs / 1000000.0f;
+		}
+
+		glDeleteSync(_readbackFences[_readbackRead]);
+		_readbackFences[_readbackRead] = nullptr;
+		_readbackRead = (_readbackRead + 1) % READBACK_FRAMES;
+	}
+
+	// All the systems are simulated in one dispatch, so they all report the same time
+	for (size_t ix = 0; ix < gpuSystems.size(); ix++) {
+		gpuSystems[ix]->_numParticles = _particleCounts[ix];
+		gpuSystems[ix]->_simulationMs = _simulationMs;
+	}
+}
+
+void ParticleManager::_QueueReadback()
+{
+	GLintptr offset = static_cast<GLintptr>(_readbackWrite) * _readbackCapacity * sizeof(uint32_t);
+	glCopyNamedBufferSubData(_liveCountBuffer, _readbackBuffer, 0, offset, _layout.size() * sizeof(uint32_t));
+	_readbackGenerations[_readbackWrite] = _layoutGeneration;
+	_readbackFences[_readbackWrite] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_readbackWrite = (_readbackWrite + 1) % READBACK_FRAMES;
+}
+
+void ParticleManager::_ReserveReadback(uint32_t systemCount)
+{
+	if (systemCount <= _readbackCapacity) {
+		return;
+	}
+
+	// Anything in flight is laid out for the old capacity, so we just drop it
+	for (uint32_t ix = 0; ix < READBACK_FRAMES; ix++) {
+		if (_readbackFences[ix] != nullptr) {
+			glDeleteSync(_readbackFences[ix]);
+			_readbackFences[ix] = nullptr;
+		}
+	}
+	_readbackRead = 0;
+	_readbackWrite = 0;
+
+	if (_readbackBuffer != 0) {
+		glUnmapNamedBuffer(_readbackBuffer);
+		glDeleteBuffers(1, &_readbackBuffer);
+	}
+
+	// The readback ring is mapped once, we use fences to know when it's safe to read a slot
+	_readbackCapacity = std::max(systemCount, _readbackCapacity * 2);
+	GLsizeiptr size = READBACK_FRAMES * _readbackCapacity * sizeof(uint32_t);
+	glCreateBuffers(1, &_readbackBuffer);
+	glNamedBufferStorage(_readbackBuffer, size, nullptr, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+	_readbackData = static_cast<const uint32_t*>(glMapNamedBufferRange(_readbackBuffer, 0, size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+#include "Utils/Macros.h"
+#include "Graphics/ShaderProgram.h"
+#include "Gameplay/Particles/ParticleSorter.h"
+
+class ParticleSystem;
+
+/// <summary>
+/// Simulates the GPU particle systems in a scene and renders all of them. GPU systems share one set of shaders
+/// and one particle pool, with each system given it's own range of the pool, so that every GPU system
+/// is emitted, simulated, sorted and drawn with a single dispatch or draw per stage. Per-system settings
+/// are uploaded in a table that the shaders index with each particle's system index
+/// </summary>
+class ParticleManager {
+public:
+	MAKE_PTRS(ParticleManager);
+	NO_COPY(ParticleManager);
+	NO_MOVE(ParticleManager);
+
+	ParticleManager();
+	~ParticleManager();
+
+	/// <summary>
+	/// Spawns and simulates particles for the GPU systems in the given list. Disabled GPU systems keep their
+	/// particles but are frozen, any GPU systems that are not in the list have their particles removed. CPU
+	/// systems are skipped, since they update themselves with the scene
+	/// </summary>
+	/// <param name="systems">All of the particle systems in the scene, in a stable order</param>
+	/// <param name="deltaTime">The time in seconds since the last update</param>
+	void Update(const std::vector<ParticleSystem*>& systems, float deltaTime);
+	/// <summary>
+	/// Renders the enabled systems in the given list, the caller is responsible for blending and depth state
+	/// </summary>
+	/// <param name="systems">All of the particle systems in the scene, in the same order as passed to Update</param>
+	void Render(const std::vector<ParticleSystem*>& systems);
+
+protected:
+	// Must match Particle in particle_buffers.glsl
+	struct GpuParticle {
+		glm::vec3 Position;
+		uint32_t  SystemIndex;
+		glm::vec3 Velocity;
+		float     Lifetime;
+		glm::vec4 Color;
+	};
+	// Must match SystemParams in particle_buffers.glsl
+	struct SystemParams {
+		glm::vec3 Gravity;
+		uint32_t  PoolOffset;
+		uint32_t  PoolSize;
+		float     SoftDistance;
+		uint32_t  Flags;
+		uint32_t  Padding;
+	};
+	// Must match Emitter in particles_emit_cs.glsl, we only upload emitters that are spawning this frame
+	struct GpuEmitter {
+		glm::vec3 Position;
+		uint32_t  SystemIndex;
+		glm::vec3 Velocity;
+		float     FirstSpawnTime;
+		glm::vec4 Color;
+		glm::vec2 LifetimeRange;
+		float     SpawnInterval;
+		uint32_t  SpawnCount;
+	};
+	// Header for the alive lists, laid out as the arguments to glDrawArraysIndirect so the
+	// simulation can write the number of particles to draw without the CPU ever reading it
+	struct AliveListHeader {
+		uint32_t Count;
+		uint32_t InstanceCount;
+		uint32_t First;
+		uint32_t BaseInstance;
+	};
+	// Where a GPU system's particles live in the shared pool
+	struct SystemSlot {
+		uint32_t SystemId;
+		uint32_t PoolOffset;
+		uint32_t PoolSize;
+	};
+
+	ShaderProgram::Sptr _emitShader;
+	ShaderProgram::Sptr _simulateShader;
+	ShaderProgram::Sptr _renderShader;
+	ShaderProgram::Sptr _resizeShader;
+	ParticleSorter::Uptr _sorter;
+
+	// The range of the shared pool used by each GPU system, in the order that the systems were passed in
+	std::vector<SystemSlot> _layout;
+	uint32_t                _poolSize;
+	// Bumped every time the layout changes, so we can ignore readbacks from an old layout
+	uint32_t                _layoutGeneration;
+
+	GLuint _particleBuffer;
+	GLuint _freeListBuffer;
+	GLuint _systemBuffer;
+	GLuint _freeCountBuffer;
+	GLuint _liveCountBuffer;
+	// Double buffered lists of living particles, the simulation reads one and writes the other
+	GLuint   _aliveBuffers[2];
+	uint32_t _currentAliveBuffer;
+
+	GLuint _emitterBuffer;
+	size_t _emitterCapacity;
+	// Scratch space for building the system list, system table and emitter list each frame
+	std::vector<ParticleSystem*> _gpuSystems;
+	std::vector<SystemParams>    _systemParams;
+	std::vector<GpuEmitter>      _spawningEmitters;
+
+	// The number of particle counts that can be in flight at once, the counts we
+	// report will be up to this many frames stale, but reading them never stalls
+	static constexpr uint32_t READBACK_FRAMES = 4;
+	// A persistently mapped ring of per-system particle counts copied from the live counts
+	GLuint          _readbackBuffer;
+	const uint32_t* _readbackData;
+	// The number of systems that each slot in the ring has room for
+	uint32_t        _readbackCapacity;
+	GLsync          _readbackFences[READBACK_FRAMES];
+	uint32_t        _readbackGenerations[READBACK_FRAMES];
+	// Measures how long the GPU spent emitting and simulating, read along with the particle counts
+	GLuint          _timerQueries[READBACK_FRAMES];
+	uint32_t        _readbackRead;
+	uint32_t        _readbackWrite;
+	// The most recent results that the GPU has finished writing
+	std::vector<uint32_t> _particleCounts;
+	float                 _simulationMs;
+
+	/// <summary>
+	/// Fills _gpuSystems with the systems that are simulated on the GPU
+	/// </summary>
+	void _CollectGpuSystems(const std::vector<ParticleSystem*>& systems);
+	/// <summary>
+	/// Makes sure that the shared pool has a range for every GPU system at the system's current size, moving
+	/// living particles into the new layout if anything has changed
+	/// </summary>
+	/// <returns>True if the layout is usable this frame (ie: there are GPU systems)</returns>
+	bool _SyncLayout(const std::vector<ParticleSystem*>& gpuSystems);
+	/// <summary>
+	/// Uploads the per-system parameter table, gpuSystems must match the current layout
+	/// </summary>
+	void _UploadSystems(const std::vector<ParticleSystem*>& gpuSystems);
+	/// <summary>
+	/// Runs the spawn timers for all emitters in the enabled GPU systems, and uploads the ones that
+	/// are spawning this frame
+	/// </summary>
+	/// <returns>The number of emitters that are spawning</returns>
+	uint32_t _UploadEmitters(const std::vector<ParticleSystem*>& gpuSystems, float deltaTime);
+	/// <summary>
+	/// Binds the shared buffers to the slots declared in particle_buffers.glsl
+	/// </summary>
+	void _BindBuffers() const;
+	/// <summary>
+	/// Deletes all the buffers that make up the shared pool
+	/// </summary>
+	void _DeletePool();
+	/// <summary>
+	/// Collects any particle counts and timings that the GPU has finished writing to the readback ring,
+	/// and hands them out to the systems. Never waits on the GPU
+	/// </summary>
+	void _CollectReadbacks(const std::vector<ParticleSystem*>& gpuSystems);
+	/// <summary>
+	/// Queues a copy of the current live counts into the next slot of the readback ring, the caller
+	/// must make sure that the slot is free
+	/// </summary>
+	void _QueueReadback();
+	/// <summary>
+	/// Drops any readbacks that are in flight and grows the ring to fit the given number of systems
+	/// </summary>
+	void _ReserveReadback(uint32_t systemCount);
+};
@@ -0,0 +1,101 @@
+#include "ParticleSorter.h"
+
+namespace {
+	// Must match the PASS_ defines in particles_sort_cs.glsl
+	constexpr int PASS_LOCAL_SORT  = 0;
+	constexpr int PASS_GLOBAL_STEP = 1;
+	constexpr int PASS_LOCAL_MERGE = 2;
+}
+
+ParticleSorter::ParticleSorter() :
+	_shader(nullptr),
+	_sortBuffer(0),
+	_capacity(0),
+	_timerQueries(),
+	_timerPending(),
+	_timerIndex(0),
+	_lastSortMs(0.0f)
+{
+	_shader = ShaderProgram::Create();
+	_shader->LoadShaderPartFromFile("shaders/compute_shaders/particles_sort_cs.glsl", ShaderPartType::Compute);
+	_shader->Link();
+
+	glCreateBuffers(1, &_sortBuffer);
+	glGenQueries(TIMER_FRAMES, _timerQueries);
+}
+
+ParticleSorter::~ParticleSorter()
+{
+	glDeleteBuffers(1, &_sortBuffer);
+	glDeleteQueries(TIMER_FRAMES, _timerQueries);
+}
+
+void ParticleSorter::Sort(uint32_t maxParticles)
+{
+	// Bitonic sort needs a power of 2 entries, and we need at least one full block
+	uint32_t capacity = BLOCK_SIZE;
+	while (capacity < maxParticles) {
+		capacity <<= 1;
+	}
+	if (capacity != _capacity) {
+		glNamedBufferData(_sortBuffer, capacity * sizeof(glm::vec2), nullptr, GL_DYNAMIC_COPY);
+		_capacity = capacity;
+	}
+
+	// If the query in this slot has a result we can grab it, otherwise we skip timing this sort
+	GLuint query = _timerQueries[_timerIndex];
+	bool timed = true;
+	if (_timerPending[_timerIndex]) {
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint64 elapsedNs = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+			_lastSortMs = elapsedNs / 1000000.0f;
+			_timerPending[_timerIndex] = false;
+		} else {
+			timed = false;
+		}
+	}
+	if (timed) {
+		glBeginQuery(GL_TIME_ELAPSED, query);
+	}
+
+	Bind();
+	_shader->Bind();
+
+	// Start by sorting each block in shared memory
+	uint32_t numBlocks = _capacity / BLOCK_SIZE;
+	_shader->SetUniform("u_SortPass"_hs, PASS_LOCAL_SORT);
+	glDispatchCompute(numBlocks, 1, 1);
+
+	// Then merge blocks together, only steps that compare entries in different blocks need to go through global memory
+	for (uint32_t k = BLOCK_SIZE * 2; k <= _capacity; k <<= 1) {
+		_shader->SetUniform("u_K"_hs, static_cast<int>(k));
+
+		_shader->SetUniform("u_SortPass"_hs, PASS_GLOBAL_STEP);
+		for (uint32_t j = k >> 1; j >= BLOCK_SIZE; j >>= 1) {
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+			_shader->SetUniform("u_J"_hs, static_cast<int>(j));
+			glDispatchCompute(numBlocks, 1, 1);
+		}
+
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		_shader->SetUniform("u_SortPass"_hs, PASS_LOCAL_MERGE);
+		glDispatchCompute(numBlocks, 1, 1);
+	}
+
+	// Make sure the results are visible to the render shader
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	if (timed) {
+		glEndQuery(GL_TIME_ELAPSED);
+		_timerPending[_timerIndex] = true;
+		_timerIndex = (_timerIndex + 1) % TIMER_FRAMES;
+	}
+}
+
+void ParticleSorter::Bind() const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SORTED_BINDING, _sortBuffer);
+}
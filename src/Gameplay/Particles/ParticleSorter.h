@@ -0,0 +1,55 @@
+#pragma once
+#include <glad/glad.h>
+
+#include "Utils/Macros.h"
+#include "Graphics/ShaderProgram.h"
+
+/// <summary>
+/// Sorts GPU particles back to front by their depth from the camera, using a bitonic sort in
+/// compute shaders so alpha blended particles can be drawn in order without a CPU round trip
+/// </summary>
+class ParticleSorter {
+public:
+	MAKE_PTRS(ParticleSorter);
+	NO_COPY(ParticleSorter);
+	NO_MOVE(ParticleSorter);
+
+	// The binding slot for the sorted particle buffer, matches particles_sort_cs.glsl
+	static constexpr int SORTED_BINDING = 5;
+
+	ParticleSorter();
+	~ParticleSorter();
+
+	/// <summary>
+	/// Sorts the particles in the alive list and pool that are currently bound (see particle_buffers.glsl)
+	/// into our sorted buffer. Entries past the alive count are pushed to the end, so the sorted buffer
+	/// can be drawn with the same count as the alive list
+	/// </summary>
+	/// <param name="maxParticles">The size of the particle pool, the sort cost depends on this rather than the live count</param>
+	void Sort(uint32_t maxParticles);
+
+	/// <summary>
+	/// Binds the sorted particle buffer to SORTED_BINDING
+	/// </summary>
+	void Bind() const;
+
+	/// <summary>
+	/// Gets the time the GPU spent on a recent sort in milliseconds, this will be a few frames stale
+	/// </summary>
+	float GetLastSortTime() const { return _lastSortMs; }
+
+protected:
+	static constexpr uint32_t BLOCK_SIZE = 1024;
+	static constexpr uint32_t TIMER_FRAMES = 4;
+
+	ShaderProgram::Sptr _shader;
+	GLuint              _sortBuffer;
+	// The number of entries in the sort buffer, always a power of 2
+	uint32_t            _capacity;
+
+	// Ring of timer queries, polled without waiting so we never stall on the results
+	GLuint   _timerQueries[TIMER_FRAMES];
+	bool     _timerPending[TIMER_FRAMES];
+	uint32_t _timerIndex;
+	float    _lastSortMs;
+};
@@ -1,5 +1,4 @@
 #include "ConvexMeshCollider.h"
-#include <BulletCollision/CollisionShapes/btShapeHull.h>
 
 #include "Gameplay/GameObject.h"
 #include "Gameplay/MeshResource.h"
@@ -16,25 +15,27 @@ namespace Gameplay::Physics {
 
 	ConvexMeshCollider::ConvexMeshCollider() :
 		ICollider(ColliderType::ConvexMesh),
-		_triMesh(nullptr)
+		_triMesh(nullptr),
+		_hull(nullptr)
 	{ }
 
 	btCollisionShape* ConvexMeshCollider::CreateShape() const {
+		// Hulls only have a few dozen vertices, so they are much cheaper for bullet than the full triangle mesh
+		if (_hull != nullptr) {
+			btConvexHullShape* result = new btConvexHullShape();
+			for (const glm::vec3& vertex : _hull->HullVertices) {
+				result->addPoint(btVector3(vertex.x, vertex.y, vertex.z), false);
+			}
+			result->recalcLocalAabb();
+			return result;
+		}
+
 		// https://pybullet.org/Bullet/phpBB3/viewtopic.php?t=4513
 		if (_triMesh == nullptr) {
 			return nullptr;
 		}
 		btConvexShape* result = new btConvexTriangleMeshShape(_triMesh);
 
-		// The hull shape will calculate the convex hull that contains our shape
-		//btShapeHull* hull = new btShapeHull(result);
-		//float margin = result->getMargin();
-		//bool build = hull->buildHull(margin);
-		//if (!build) {
-		//	LOG_WARN("Failed to build hull for convex mesh");
-		//}
-		//delete hull;
-
 		return result;
 	}
 
@@ -55,11 +56,46 @@ namespace Gameplay::Physics {
 			mesh = mesh->ColliderMeshData;
 		}
 
+		// Meshes keep a CPU side copy of their convex hull, which is all we need. Hulls are cooked into binary
+		// mesh files, meshes that were loaded some other way build it when they are loaded
+		if (mesh->CollisionData != nullptr) {
+			if (mesh->CollisionData->HullVertices.empty() && mesh->BulletTriMesh == nullptr) {
+				mesh->CollisionData->BuildHull();
+			}
+			if (!mesh->CollisionData->HullVertices.empty()) {
+				_hull = mesh->CollisionData;
+				return;
+			}
+		}
+
+		// Without a hull we need the full triangles, so we flag the mesh to keep them the next time it loads
+		mesh->KeepCollisionData = true;
+
 		// We've already calculated the mesh, use existing
 		if (mesh->BulletTriMesh != nullptr) {
 			_triMesh = mesh->BulletTriMesh.get();
 		}
-		// We need to calculate the triangle mesh from the mesh data
+		// If we couldn't make a hull, we can still build the triangle mesh from the CPU side copy
+		else if (mesh->CollisionData != nullptr && !mesh->CollisionData->Positions.empty()) {
+			const MeshCollisionData& data = *mesh->CollisionData;
+			_triMesh = new btTriangleMesh();
+			_triMesh->preallocateVertices(static_cast<int>(data.Positions.size()));
+
+			// Non indexed meshes just have their triangles one after the other
+			size_t cornerCount = data.Indices.empty() ? data.Positions.size() : data.Indices.size();
+			for (size_t ix = 0; ix + 2 < cornerCount; ix += 3) {
+				glm::vec3 points[3];
+				for (size_t corner = 0; corner < 3; corner++) {
+					size_t index = data.Indices.empty() ? ix + corner : data.Indices[ix + corner];
+					points[corner] = index < data.Positions.size() ? data.Positions[index] : glm::vec3(0.0f);
+				}
+				_triMesh->addTriangle(btVector3(points[0].x, points[0].y, points[0].z), btVector3(points[1].x, points[1].y, points[1].z), btVector3(points[2].x, points[2].y, points[2].z));
+			}
+
+			// Store the bullet tri mesh in the MeshResource in case we want it later
+			mesh->BulletTriMesh = std::shared_ptr<btTriangleMesh>(_triMesh);
+		}
+		// Otherwise we need to read the triangle mesh back from the GPU
 		else {
 			// Get the VAO from the mesh and make sure it exists
 			VertexArrayObject::Sptr vao = mesh->Mesh;
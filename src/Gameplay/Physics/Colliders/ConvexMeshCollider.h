@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Gameplay/Physics/ICollider.h"
+#include "Utils/MeshCollisionData.h"
 
 namespace Gameplay::Physics {
 	/// <summary>
@@ -20,6 +21,8 @@ namespace Gameplay::Physics {
 
 	protected:
 		btTriangleMesh* _triMesh;
+		// The mesh's collision data, only set if it has a convex hull
+		MeshCollisionData::Sptr _hull;
 		ConvexMeshCollider();
 
 		virtual btCollisionShape* CreateShape() const override;
@@ -59,6 +59,18 @@ void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elemen
 	}
 }
 
+void IBuffer::UpdateSubData(const void* data, uint32_t elementSize, uint32_t firstElement, uint32_t elementCount)
+{
+	LOG_ASSERT((firstElement + elementCount) * elementSize <= _size, "Attempting to write beyond the end of the buffer!");
+	glNamedBufferSubData(_rendererId, (GLintptr)firstElement * elementSize, (GLsizeiptr)elementCount * elementSize, data);
+}
+
+void IBuffer::SetElementCount(uint32_t elementCount)
+{
+	LOG_ASSERT(elementCount * _elementSize <= _size, "Element count exceeds the size of the buffer!");
+	_elementCount = elementCount;
+}
+
 void* IBuffer::Map(BufferMapMode mode) {
 	return glMapNamedBufferRange(_rendererId, 0, _size, *mode);
 }
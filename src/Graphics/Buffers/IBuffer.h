@@ -52,6 +52,21 @@ public:
 	/// <param name="allowResize">True if resizing the buffer is allowed, otherwise an assertion is thrown for oversized writes</param>
 	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true);
 
+	/// <summary>
+	/// Updates a range of elements within the buffer without re-allocating it, the range must fit within
+	/// the buffer's current storage. Does not change the element count, see SetElementCount
+	/// </summary>
+	/// <param name="data">The data to write into the range</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="firstElement">The index of the first element to write to</param>
+	/// <param name="elementCount">The number of elements to write</param>
+	void UpdateSubData(const void* data, uint32_t elementSize, uint32_t firstElement, uint32_t elementCount);
+	/// <summary>
+	/// Sets the number of elements in the buffer that are in use, without touching the buffer's storage
+	/// </summary>
+	/// <param name="elementCount">The number of elements, must fit within the buffer's storage</param>
+	void SetElementCount(uint32_t elementCount);
+
 	/// <summary>
 	/// Loads an array of data into this buffer, using the bindless method glNamedBufferData
 	/// </summary>
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <stdexcept>
 #include <memory>
+#include <vector>
+#include <limits>
 #include <EnumToString.h>
 
 #include "Graphics/GlEnums.h"
@@ -52,6 +54,24 @@ public:
 	template <typename T>
 	void LoadData(const T* data, uint32_t count) { throw std::runtime_error("Must be one of uint8_t, uint16_t or uint32_t"); } // Note, see template specializations below
 
+	/// <summary>
+	/// Loads 32 bit indices into this buffer, storing them as 16 bit indices if that's enough to address all
+	/// the vertices, which halves the memory and bandwidth the indices use
+	/// </summary>
+	/// <param name="data">A pointer to the start of the indices</param>
+	/// <param name="count">The number of indices to upload</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	void LoadIndices(const uint32_t* data, uint32_t count, size_t vertexCount);
+
+	/// <summary>
+	/// Gets the smallest index type that can address the given number of vertices. Byte indices are never
+	/// used, since a lot of hardware doesn't support them natively
+	/// </summary>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	static IndexType GetIndexTypeForVertexCount(size_t vertexCount) {
+		return vertexCount <= (size_t)std::numeric_limits<uint16_t>::max() + 1 ? IndexType::UShort : IndexType::UInt;
+	}
+
 	/// <summary>
 	/// Gets the underlying index type for this buffer (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT)
 	/// </summary>
@@ -85,3 +105,12 @@ inline void IndexBuffer::LoadData<uint32_t>(const uint32_t* data, uint32_t count
 	IBuffer::LoadData<uint32_t>(data, count);
 	_elementType = IndexType::UInt;
 }
+
+inline void IndexBuffer::LoadIndices(const uint32_t* data, uint32_t count, size_t vertexCount) {
+	if (GetIndexTypeForVertexCount(vertexCount) == IndexType::UShort) {
+		std::vector<uint16_t> narrowed(data, data + count);
+		LoadData(narrowed.data(), count);
+	} else {
+		LoadData(data, count);
+	}
+}
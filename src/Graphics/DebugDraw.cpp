@@ -69,7 +69,7 @@ void DebugDrawer::FlushLines()
 {
 	if (_lineOffset > 0) {
 		__Shader->Bind();
-		__Shader->SetUniformMatrix("u_MVP", _viewProjection * _transformStack.top());
+		__Shader->SetUniformMatrix("u_MVP"_hs, _viewProjection * _transformStack.top());
 		int restorePoint = 0;
 		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &restorePoint);
 		VertexArrayObject::Unbind();
@@ -112,7 +112,7 @@ void DebugDrawer::FlushTris()
 {
 	if (_triangleOffset > 0) {
 		__Shader->Bind();
-		__Shader->SetUniformMatrix("u_MVP", _viewProjection * _transformStack.top());
+		__Shader->SetUniformMatrix("u_MVP"_hs, _viewProjection * _transformStack.top());
 		int restorePoint = 0;
 		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &restorePoint);
 		VertexArrayObject::Unbind();
@@ -1,16 +1,19 @@
 #include "Graphics/Font.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
-#include <set>
-#include <codecvt>
-#include <locale>
+#include "Utils/StringUtils.h"
 #include <cstdint>
-#include <stb_rect_pack.h>
-#include "Utils/JsonGlmHelpers.h"
+#include <algorithm>
 
-#define OVERSAMPLE_X 1
-#define OVERSAMPLE_Y 1
+// Space between glyphs in the atlas, so filtering doesn't bleed between them
 #define PADDING 1
+// Size of the atlas when the first glyph is loaded, and the largest it can grow to
+#define INITIAL_ATLAS_SIZE 256
+#define MAX_ATLAS_SIZE 4096
+// SDF glyphs are always rasterized at this pixel height, and scaled to the font size when rendered
+#define SDF_BAKE_SIZE 48.0f
+// How many pixels around an SDF glyph the distance field extends, the edge of the glyph is at 128
+#define SDF_SPREAD 6
 
 Font::Font() : Font("", 0.0f) { }
 
@@ -18,18 +21,30 @@ Font::Font(const std::string& fontPath, float size) :
 	IResource(),
 	_fontPath(fontPath),
 	_fontSize(size),
-	_glyphs(nullptr),
+	_renderMode(FontRenderMode::Bitmap),
+	_glyphs(),
+	_glyphLookup(),
+	_defaultGlyph(NO_GLYPH),
+	_kerningTable(),
+	_kerningCache(),
+	_layouts(),
+	_layoutLookup(),
+	_decodeScratch(),
 	_atlas(nullptr),
+	_atlasGeneration(0),
 	_ascent(0),
 	_descent(0),
-	_lineGap(0.0f),
+	_lineGap(0),
 	_emToPixel(0.0f),
 	_pixelHeightScale(0.0f),
 	_fontInfo(stbtt_fontinfo()),
-	_defaultGlyph(GlyphInfo()),
-	_atlasWidth(256),
-	_atlasHeight(256)
+	_atlasWidth(0),
+	_atlasHeight(0),
+	_packCursor(glm::uvec2(PADDING)),
+	_shelfHeight(0)
 {
+	std::fill(std::begin(_flatGlyphs), std::end(_flatGlyphs), NO_GLYPH);
+
 	// For the box character
 	_glyphRanges.push_back({ 0xE000u, 0xE000u });
 	// Default ASCII characters
@@ -41,7 +56,6 @@ Font::Font(const std::string& fontPath, float size) :
 }
 
 Font::~Font() {
-	delete[] _glyphs;
 	_atlas = nullptr;
 }
 
@@ -54,12 +68,12 @@ void Font::Load(const std::string& fontPath, float size /*= 16.0f*/)
 	if (!data.empty()) {
 		_fontPath = fontPath;
 		_fontData = data;
+		_fontSize = size;
 
-		if (_glyphs != nullptr) {
-			delete[] _glyphs;
-			_glyphs = nullptr;
-		}
-		_atlas = nullptr;
+		// Any glyphs, kerning and layouts we have are from the old font
+		_ClearGlyphs();
+		_kerningTable.clear();
+		_kerningCache.clear();
 
 		uint8_t* rawData = reinterpret_cast<uint8_t*>(_fontData.data());
 
@@ -79,227 +93,412 @@ void Font::Load(const std::string& fontPath, float size /*= 16.0f*/)
 }
 
 void Font::AddGlyphRange(uint32_t min, uint32_t max) {
-	LOG_ASSERT(_atlas == nullptr, "Cannot add glyphs after the font has been baked!");
 	_glyphRanges.push_back({ min, max });
+
+	// If we've already been baked, load the new range right away
+	if (_atlas != nullptr) {
+		for (uint32_t ix = min; ix <= max; ix++) {
+			if (stbtt_FindGlyphIndex(&_fontInfo, ix)) {
+				_GetGlyphIndex(ix);
+			}
+		}
+	}
 }
 
 void Font::Bake() {
-	LOG_ASSERT(_atlas == nullptr, "Bake has already been called!");
 	LOG_ASSERT(_fontInfo.data != nullptr, "Have not loaded a font asset!");
 
-	uint8_t* rawFontData = reinterpret_cast<uint8_t*>(_fontData.data());
+	// Make sure there's an atlas even if the ranges are empty, so GetAtlas never hands out null for a loaded font
+	if (_atlas == nullptr) {
+		_atlasWidth = _atlasHeight = INITIAL_ATLAS_SIZE;
+		_atlas = __CreateAtlasTexture(_atlasWidth, _atlasHeight);
+	}
+
+	if (_kerningTable.empty()) {
+		_BuildKerningTable();
+	}
 
-	// Collect all codepoint ranges into a set, so we have a list of unique codepoints
-	std::set<int> codePoints;
-	uint32_t numCodepoints = 0;
+	// Warm up the cache, we skip glyphs the font doesn't have since they'd all just map to the default glyph
 	for (const auto& range : _glyphRanges) {
 		for (uint32_t ix = range.x; ix <= range.y; ix++) {
-			// skip if the font doesn't have that glyph
-			if (!stbtt_FindGlyphIndex(&_fontInfo, ix)) {
-				continue;
+			if (stbtt_FindGlyphIndex(&_fontInfo, ix)) {
+				_GetGlyphIndex(ix);
 			}
-			numCodepoints += codePoints.emplace(ix).second ? 1 : 0;
 		}
 	}
+}
 
-	// Allocate our glyph data for the number of unicode character's we're supporting
-	_glyphs = new stbtt_packedchar[numCodepoints];
-	memset(_glyphs, 0, sizeof(stbtt_packedchar) * numCodepoints);
-
-	// Collect unicode ranges, may differ from input ranges!
-	std::vector<stbtt_pack_range> ranges;
-
-	// Create the initial data structure, we'll store copies of this as we go
-	stbtt_pack_range current;
-	current.font_size = _fontSize;
-	current.first_unicode_codepoint_in_range = *codePoints.begin();
-	current.num_chars = 0;
-	current.chardata_for_range = _glyphs;
-	current.h_oversample = OVERSAMPLE_X;
-	current.v_oversample = OVERSAMPLE_Y;
-	current.array_of_unicode_codepoints = (int*)(&*codePoints.begin());
-
-	// Calculate surface area of glyphs as we go
-	int totalSurface = 0;
-	// We track number of encoded characters, as well as the previous processed codepoint
-	// to check for jumps in the range
-	uint32_t prevCodePoint = *codePoints.begin() - 1;
-	uint32_t encodedChars = 0;
-
-	// Iterate over the unique codepoint set (which is sorted!)
-	for (uint32_t codepoint : codePoints) {
-
-		// We have a break in the codepoints, start a new range!
-		if (codepoint - 1 != prevCodePoint) {
-			// Track the end of the current range and store it
-			current.num_chars = prevCodePoint - current.first_unicode_codepoint_in_range + 1;
-			ranges.push_back(current);
-
-			// Start the next range
-			current.first_unicode_codepoint_in_range = codepoint;
-			current.chardata_for_range = _glyphs + encodedChars;
-			current.array_of_unicode_codepoints = (int*)(&*codePoints.begin()) + encodedChars;
-		}
+const Texture2D::Sptr& Font::GetAtlas() {
+	return _atlas;
+}
 
-		// We have another character
-		encodedChars++;
+void Font::SetRenderMode(FontRenderMode mode) {
+	if (mode != _renderMode) {
+		_renderMode = mode;
+		_ClearGlyphs();
+	}
+}
 
-		// Track the previous unicode character
-		prevCodePoint = codepoint;
+GlyphInfo Font::GetGlyph(uint32_t codePoint, float offsetX, float offsetY) {
+	if (_fontInfo.data == nullptr) {
+		return GlyphInfo();
 	}
 
-	// We've processed all codepoints, finish the current range and store it
-	current.num_chars = prevCodePoint - current.first_unicode_codepoint_in_range + 1;
-	ranges.push_back(current);
+	GlyphInfo result = _glyphs[_GetGlyphIndex(codePoint)].Info;
 
-	_CrtCheckMemory();
+	result.OffsetX += offsetX;
+	result.OffsetY += offsetY;
 
-	// Create a texture to store the atlas
-	Texture2DDescription desc;
-	desc.Width = _atlasWidth;
-	desc.Height = _atlasHeight;
-	desc.Format = InternalFormat::R8;
-	_atlas = std::make_shared<Texture2D>(desc);
+	return result;
+}
 
-	// Allocate memory for the image, and point rect pack at it
-	uint8_t* atlasData = new uint8_t[desc.Width * (size_t)desc.Height];
-	memset(atlasData, 0, desc.Width * desc.Height);
+float Font::GetKerning(int char1, int char2) {
+	uint32_t left = static_cast<uint32_t>(char1);
+	uint32_t right = static_cast<uint32_t>(char2);
+	if (left < KERNING_TABLE_SIZE && right < KERNING_TABLE_SIZE && !_kerningTable.empty()) {
+		return _kerningTable[left * KERNING_TABLE_SIZE + right];
+	}
 
-	stbtt_pack_context context;
-	if (!stbtt_PackBegin(&context, atlasData, _atlasWidth, _atlasHeight, 0, 1, nullptr)) {
-		LOG_ERROR("Failed to pack font texture");
-		delete[] atlasData;
-		return;
+	uint64_t key = (static_cast<uint64_t>(left) << 32) | right;
+	auto it = _kerningCache.find(key);
+	if (it != _kerningCache.end()) {
+		return it->second;
 	}
-	_CrtCheckMemory();
 
-	stbtt_PackSetOversampling(&context, OVERSAMPLE_X, OVERSAMPLE_Y);
-	for (auto& range : ranges) {
-		if (!stbtt_PackFontRange(&context, rawFontData, 0, range.font_size, range.first_unicode_codepoint_in_range, range.num_chars, range.chardata_for_range)) {
-			LOG_ERROR("Failed to pack font range");
-			delete[] atlasData;
-			return;
+	float result = stbtt_GetCodepointKernAdvance(&_fontInfo, char1, char2) * _pixelHeightScale;
+	_kerningCache[key] = result;
+	return result;
+}
+
+float Font::GetLineHeight() const {
+	return (_ascent - _descent + _lineGap) * _pixelHeightScale;
+}
+
+glm::vec2 Font::MeausureString(const std::string& text, const float scale /*= 1.0f*/) {
+	return GetLayout(text).Size * scale;
+}
+
+glm::vec2 Font::MeausureString(const std::wstring& text, const float scale /*= 1.0f*/) {
+	return GetLayout(text).Size * scale;
+}
+
+const TextLayout& Font::GetLayout(const std::string& text) {
+	StringTools::DecodeUtf8(text, _decodeScratch);
+	return GetLayout(_decodeScratch);
+}
+
+const TextLayout& Font::GetLayout(const std::wstring& text) {
+	StringTools::DecodeWide(text, _decodeScratch);
+	return GetLayout(_decodeScratch);
+}
+
+const TextLayout& Font::GetLayout(const std::u32string& text) {
+	auto it = _layoutLookup.find(text);
+	if (it != _layoutLookup.end()) {
+		// Move to the front of the LRU list, and re-do the layout if the atlas has changed since
+		_layouts.splice(_layouts.begin(), _layouts, it->second);
+		TextLayout& layout = it->second->second;
+		if (layout.AtlasGeneration != _atlasGeneration) {
+			_LayoutText(text, layout);
 		}
-		_CrtCheckMemory();
+		return layout;
 	}
-	stbtt_PackEnd(&context);
 
-	_CrtCheckMemory();
+	// Re-use the least recently used entry if the cache is full
+	if (_layouts.size() >= LAYOUT_CACHE_SIZE) {
+		_layoutLookup.erase(_layouts.back().first);
+		_layouts.splice(_layouts.begin(), _layouts, std::prev(_layouts.end()));
+		_layouts.front().first = text;
+	} else {
+		_layouts.emplace_front(text, TextLayout());
+	}
+	_layoutLookup[text] = _layouts.begin();
 
-	// Upload data into the image
-	_atlas->LoadData(desc.Width, desc.Height, PixelFormat::Red, PixelType::UByte, atlasData);
-	delete[] atlasData;
+	TextLayout& layout = _layouts.front().second;
+	_LayoutText(text, layout);
+	return layout;
+}
 
-	uint32_t index = 0;
-	for (uint32_t codepoint : codePoints) {
-		_glyphMap[codepoint] = __CreateGlyph(index);
-		index++;
+void Font::_BuildKerningTable()
+{
+	_kerningTable.assign(KERNING_TABLE_SIZE * KERNING_TABLE_SIZE, 0.0f);
+
+	// Only pairs of glyphs that the font actually has can have kerning
+	std::vector<std::pair<uint32_t, int>> glyphs;
+	for (uint32_t ix = 0; ix < KERNING_TABLE_SIZE; ix++) {
+		int glyphIndex = stbtt_FindGlyphIndex(&_fontInfo, ix);
+		if (glyphIndex) {
+			glyphs.push_back({ ix, glyphIndex });
+		}
+	}
 
-		if (codepoint == 0xE000u)
-			_defaultGlyph = _glyphMap[codepoint];
+	for (const auto& left : glyphs) {
+		for (const auto& right : glyphs) {
+			_kerningTable[left.first * KERNING_TABLE_SIZE + right.first] = stbtt_GetGlyphKernAdvance(&_fontInfo, left.second, right.second) * _pixelHeightScale;
+		}
 	}
 }
 
-const Texture2D::Sptr& Font::GetAtlas() {
-	return _atlas;
+void Font::_LayoutText(const std::u32string& text, TextLayout& layout)
+{
+	// Loading glyphs may grow the atlas part way through, which changes the UVs of
+	// glyphs we've already placed. Every glyph is loaded after the first pass, so a
+	// second pass will always have matching UVs
+	do {
+		layout.AtlasGeneration = _atlasGeneration;
+		layout.Glyphs.clear();
+
+		// We'll track the position and max size of the text
+		float xOff{ 0 }, yOff{ 0 };
+		float lineHeight = 0.0f;
+		float maxWidth = 0.0f;
+		float totalHeight = 0.0f;
+
+		for (size_t i = 0; i < text.size(); i++) {
+			uint32_t codePoint = text[i];
+
+			// A newline will advance to the next line and return to the start of the line
+			if (codePoint == '\n') {
+				yOff += GetLineHeight();
+				totalHeight += lineHeight;
+				lineHeight = 0.0f;
+				xOff = 0;
+			}
+			// A return character simply returns to the start of the line
+			else if (codePoint == '\r') {
+				xOff = 0;
+			}
+			// A tab character is 4 spaces
+			else if (codePoint == '\t') {
+				xOff += GetGlyph(' ', 0.0f, 0.0f).OffsetX * 4;
+			}
+			else {
+				GlyphInfo glyph = GetGlyph(codePoint, 0.0f, 0.0f);
+				lineHeight = glm::max(lineHeight, -glyph.Positions[1].y);
+
+				// Whitespace has nothing to draw, it only moves the pen
+				if (glyph.IsPacked) {
+					for (int ix = 0; ix < 4; ix++) {
+						glyph.Positions[ix] += glm::vec2(xOff, yOff);
+					}
+					layout.Glyphs.push_back(glyph);
+				}
+
+				// Advance the offset based on the size of the glyph
+				xOff += glyph.OffsetX;
+				maxWidth = glm::max(maxWidth, xOff);
+
+				// If we have more characters, see if there's any kerning between the
+				// current and next character and add it to the x offset
+				if (i < text.size() - 1) {
+					xOff += GetKerning(codePoint, text[i + 1]);
+				}
+			}
+		}
+
+		totalHeight += lineHeight;
+		layout.Size = glm::vec2(maxWidth, totalHeight);
+	} while (layout.AtlasGeneration != _atlasGeneration);
 }
 
-GlyphInfo Font::GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const {
-	// Try and get glyph info from the codepoint, otherwise grab the default glyph
-	auto it = _glyphMap.find(codePoint);		
-	GlyphInfo result = it == _glyphMap.end() ? _defaultGlyph : it->second;
+void Font::_ClearGlyphs()
+{
+	_layouts.clear();
+	_layoutLookup.clear();
+	_glyphs.clear();
+	_glyphLookup.clear();
+	std::fill(std::begin(_flatGlyphs), std::end(_flatGlyphs), NO_GLYPH);
+	_defaultGlyph = NO_GLYPH;
+
+	// The next glyph will start a fresh atlas
+	if (_atlas != nullptr) {
+		_atlas = nullptr;
+		_atlasGeneration++;
+	}
+	_atlasWidth = _atlasHeight = 0;
+	_packCursor = glm::uvec2(PADDING);
+	_shelfHeight = 0;
+}
 
-	result.OffsetX += offsetX;
-	result.OffsetY += offsetY;
+uint32_t Font::_GetGlyphIndex(uint32_t codePoint)
+{
+	// Most text is in the latin range, so we can skip hashing for it
+	if (codePoint < FLAT_GLYPH_COUNT) {
+		uint32_t& slot = _flatGlyphs[codePoint];
+		if (slot == NO_GLYPH) {
+			int glyphIndex = stbtt_FindGlyphIndex(&_fontInfo, codePoint);
+			slot = glyphIndex ? _RasterizeGlyph(glyphIndex) : _GetDefaultGlyph();
+		}
+		return slot;
+	}
 
+	auto it = _glyphLookup.find(codePoint);
+	if (it != _glyphLookup.end()) {
+		return it->second;
+	}
+
+	int glyphIndex = stbtt_FindGlyphIndex(&_fontInfo, codePoint);
+	uint32_t result = glyphIndex ? _RasterizeGlyph(glyphIndex) : _GetDefaultGlyph();
+	_glyphLookup[codePoint] = result;
 	return result;
 }
 
-float Font::GetKerning(int char1, int char2) const {
-	return stbtt_GetCodepointKernAdvance(&_fontInfo, char1, char2) * _pixelHeightScale;
+uint32_t Font::_GetDefaultGlyph()
+{
+	// Use the box character if the font has one, otherwise the font's missing glyph (glyph 0)
+	if (_defaultGlyph == NO_GLYPH) {
+		_defaultGlyph = _RasterizeGlyph(stbtt_FindGlyphIndex(&_fontInfo, 0xE000u));
+	}
+	return _defaultGlyph;
 }
 
-float Font::GetLineHeight() const {
-	return (_ascent - _descent + _lineGap) * _pixelHeightScale;
-}
+uint32_t Font::_RasterizeGlyph(int glyphIndex)
+{
+	// SDF glyphs are rasterized at a fixed size and scaled to match the font size
+	bool isSdf = _renderMode == FontRenderMode::Sdf;
+	float rasterScale = isSdf ? stbtt_ScaleForPixelHeight(&_fontInfo, SDF_BAKE_SIZE) : _pixelHeightScale;
+	float toFontPixels = isSdf ? _fontSize / SDF_BAKE_SIZE : 1.0f;
+
+	int width = 0, height = 0, xOff = 0, yOff = 0;
+	uint8_t* bitmap = nullptr;
+	if (isSdf) {
+		bitmap = stbtt_GetGlyphSDF(&_fontInfo, rasterScale, glyphIndex, SDF_SPREAD, 128, 128.0f / SDF_SPREAD, &width, &height, &xOff, &yOff);
+	} else {
+		bitmap = stbtt_GetGlyphBitmap(&_fontInfo, rasterScale, rasterScale, glyphIndex, &width, &height, &xOff, &yOff);
+	}
 
-glm::vec2 Font::MeausureString(const std::string& text, const float scale /*= 1.0f*/) {
-	// We can convert an ASCII string to unicode!
-	std::wstring unicode = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(text);
-	return MeausureString(unicode, scale);
+	CachedGlyph glyph = CachedGlyph();
+	glyph.AtlasSize = glm::uvec2(width, height);
+
+	int advance = 0, leftBearing = 0;
+	stbtt_GetGlyphHMetrics(&_fontInfo, glyphIndex, &advance, &leftBearing);
+	glyph.Info.OffsetX = advance * _pixelHeightScale;
+	glyph.Info.OffsetY = 0.0f;
+
+	// Whitespace has no bitmap, so it doesn't need any space in the atlas
+	if (bitmap != nullptr && width > 0 && height > 0) {
+		if (_atlas == nullptr) {
+			_atlasWidth = _atlasHeight = INITIAL_ATLAS_SIZE;
+			_atlas = __CreateAtlasTexture(_atlasWidth, _atlasHeight);
+		}
+
+		if (_AllocateRect(width, height, glyph.AtlasPos)) {
+			_atlas->LoadData(width, height, PixelFormat::Red, PixelType::UByte, bitmap, glyph.AtlasPos.x, glyph.AtlasPos.y);
+			glyph.Info.IsPacked = true;
+
+			// Positions are in font pixels with Y down, relative to the pen position on the baseline
+			float xmin = xOff * toFontPixels;
+			float xmax = (xOff + width) * toFontPixels;
+			float ymin = (yOff + height) * toFontPixels;
+			float ymax = yOff * toFontPixels;
+			glyph.Info.Positions[0] = { xmax, ymin };
+			glyph.Info.Positions[1] = { xmax, ymax };
+			glyph.Info.Positions[2] = { xmin, ymax };
+			glyph.Info.Positions[3] = { xmin, ymin };
+		} else {
+			LOG_WARN("Font atlas for {} is full, glyph {} will not be rendered", _fontPath, glyphIndex);
+		}
+	}
+
+	if (bitmap != nullptr) {
+		if (isSdf) {
+			stbtt_FreeSDF(bitmap, nullptr);
+		} else {
+			stbtt_FreeBitmap(bitmap, nullptr);
+		}
+	}
+
+	// Work out the UVs against the current atlas size
+	if (glyph.Info.IsPacked) {
+		glm::vec2 uvMin = glm::vec2(glyph.AtlasPos) / glm::vec2(_atlasWidth, _atlasHeight);
+		glm::vec2 uvMax = glm::vec2(glyph.AtlasPos + glyph.AtlasSize) / glm::vec2(_atlasWidth, _atlasHeight);
+		glyph.Info.UVs[0] = { uvMax.x, uvMax.y };
+		glyph.Info.UVs[1] = { uvMax.x, uvMin.y };
+		glyph.Info.UVs[2] = { uvMin.x, uvMin.y };
+		glyph.Info.UVs[3] = { uvMin.x, uvMax.y };
+	}
+
+	_glyphs.push_back(glyph);
+	return static_cast<uint32_t>(_glyphs.size() - 1);
 }
 
-glm::vec2 Font::MeausureString(const std::wstring& text, const float scale /*= 1.0f*/) {
-	// Will cache the current glyph
-	GlyphInfo glyph;
-
-	// We'll track the position and max size of the text
-	float xOff{ 0 }, yOff{ 0 };
-	float lineHeight = 0.0f;
-	float maxWidth = 0.0f;
-	float totalHeight = 0.0f;
-
-	// Iterate over all characters, ascii and unicode overlap in the 0-255 range!
-	for (size_t i = 0; i < text.size(); i++) {
-		glyph = GetGlyph(text[i], xOff, yOff);
-		xOff = glyph.OffsetX;
-		yOff = glyph.OffsetY;
-
-		lineHeight = glm::max(lineHeight, -glyph.Positions[1].y);
-		maxWidth = glm::max(maxWidth, xOff);
-
-		if (text[i] == '\n')
-		{
-			yOff += GetLineHeight();
-			totalHeight += lineHeight;
-			lineHeight = 0.0f;
-			xOff = 0;
-		} else if (text[i] == '\r') {
-			xOff = 0;
-		} else if (text[i] == '\t') {
-			float xOffTemp{ 0 }, yOffTemp{ 0 };
-			glyph = GetGlyph(' ', xOffTemp, yOffTemp);
-			xOff += glyph.OffsetX * 4;
+bool Font::_AllocateRect(uint32_t width, uint32_t height, glm::uvec2& outPos)
+{
+	while (true) {
+		// Start a new row if the glyph doesn't fit at the end of the current one
+		if (_packCursor.x + width + PADDING > _atlasWidth) {
+			_packCursor.x = PADDING;
+			_packCursor.y += _shelfHeight + PADDING;
+			_shelfHeight = 0;
+		}
+
+		if (_packCursor.x + width + PADDING <= _atlasWidth && _packCursor.y + height + PADDING <= _atlasHeight) {
+			outPos = _packCursor;
+			_packCursor.x += width + PADDING;
+			_shelfHeight = std::max(_shelfHeight, height);
+			return true;
+		}
+
+		if (!_GrowAtlas()) {
+			return false;
 		}
 	}
-	totalHeight += lineHeight;
-	return glm::vec2(maxWidth, totalHeight) * scale;
 }
 
+bool Font::_GrowAtlas()
+{
+	if (_atlasWidth >= MAX_ATLAS_SIZE) {
+		return false;
+	}
 
-GlyphInfo Font::__CreateGlyph(uint32_t index)
+	// Copy the existing glyphs into the corner of a bigger texture, anyone still holding
+	// the old atlas can keep drawing with it and their old UVs
+	uint32_t newWidth = _atlasWidth * 2;
+	uint32_t newHeight = _atlasHeight * 2;
+	Texture2D::Sptr atlas = __CreateAtlasTexture(newWidth, newHeight);
+	glCopyImageSubData(_atlas->GetHandle(), GL_TEXTURE_2D, 0, 0, 0, 0, atlas->GetHandle(), GL_TEXTURE_2D, 0, 0, 0, 0, _atlasWidth, _atlasHeight, 1);
+
+	_atlas = atlas;
+	_atlasWidth = newWidth;
+	_atlasHeight = newHeight;
+	_atlasGeneration++;
+
+	// Glyphs haven't moved in pixels, but their UVs have shrunk
+	for (CachedGlyph& glyph : _glyphs) {
+		for (int ix = 0; ix < 4; ix++) {
+			glyph.Info.UVs[ix] *= 0.5f;
+		}
+	}
+
+	LOG_INFO("Grew font atlas for {} to {}x{}", _fontPath, newWidth, newHeight);
+	return true;
+}
+
+Texture2D::Sptr Font::__CreateAtlasTexture(uint32_t width, uint32_t height)
 {
-	stbtt_aligned_quad quad;
-
-	float offsetX{0}, offsetY{0};
-	stbtt_GetPackedQuad(_glyphs, _atlasWidth, _atlasHeight, index, &offsetX, &offsetY, &quad, 1);
-	float xmin = quad.x0;
-	float xmax = quad.x1;
-	float ymin = quad.y1;
-	float ymax = quad.y0;
-
-	GlyphInfo info = GlyphInfo();
-
-	info.OffsetX      = offsetX;
-	info.OffsetY      = offsetY;
-	info.Positions[0] = { xmax, ymin };
-	info.Positions[1] = { xmax, ymax };
-	info.Positions[2] = { xmin, ymax };
-	info.Positions[3] = { xmin, ymin };
-	info.UVs[0]       = { quad.s1, quad.t1 };
-	info.UVs[1]       = { quad.s1, quad.t0 };
-	info.UVs[2]       = { quad.s0, quad.t0 };
-	info.UVs[3]       = { quad.s0, quad.t1 };
-	info.IsPacked = true;
-
-	return info;
+	Texture2DDescription desc;
+	desc.Width = width;
+	desc.Height = height;
+	desc.Format = InternalFormat::R8;
+	desc.HorizontalWrap = WrapMode::ClampToEdge;
+	desc.VerticalWrap = WrapMode::ClampToEdge;
+	desc.MinificationFilter = MinFilter::Linear;
+	desc.MagnificationFilter = MagFilter::Linear;
+	// Mips would have to be re-generated for every glyph we add
+	desc.GenerateMipMaps = false;
+	Texture2D::Sptr result = std::make_shared<Texture2D>(desc);
+
+	// Gaps between glyphs need to be empty
+	glClearTexImage(result->GetHandle(), 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+	return result;
 }
 
 nlohmann::json Font::ToJson() const
 {
 	nlohmann::json blob = {
 		{ "filename", _fontPath },
-		{ "font_size", _fontSize }
+		{ "font_size", _fontSize },
+		{ "mode",      ~_renderMode }
 	};
 
 	nlohmann::json ranges = std::vector<nlohmann::json>();
@@ -316,6 +515,7 @@ Font::Sptr Font::FromJson(const nlohmann::json& data) {
 	// Load the path and font size so we can grab the font file
 	std::string path = JsonGet<std::string>(data, "filename", "");
 	float size = JsonGet(data, "font_size", 16.0f);
+	result->_renderMode = JsonParseEnum(FontRenderMode, data, "mode", FontRenderMode::Bitmap);
 	result->Load(path, size);
 		
 	// Iterate over the ranges and add them to the font
@@ -326,7 +526,7 @@ Font::Sptr Font::FromJson(const nlohmann::json& data) {
 		}
 	}
 
-	// Bake font texture and return
+	// Pre-load the glyphs in the ranges and return
 	result->Bake();
 	return result;
 }
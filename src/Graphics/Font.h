@@ -4,6 +4,19 @@
 #include "Graphics/Textures/Texture2D.h"
 
 #include <stb_truetype.h>
+#include <unordered_map>
+#include <list>
+#include <EnumToString.h>
+
+	/// <summary>
+	/// How a font's glyphs are stored in it's atlas
+	/// </summary>
+	ENUM(FontRenderMode, uint32_t,
+		// Glyphs are rasterized at the font size, best for text that is drawn at it's native size
+		Bitmap = 0,
+		// Glyphs are stored as signed distance fields, so they stay sharp at any scale
+		Sdf    = 1
+	);
 
 	struct GlyphInfo {
 		glm::vec2 Positions[4];
@@ -12,9 +25,26 @@
 		bool IsPacked;
 	};
 
+	/// <summary>
+	/// A line (or lines) of text that has been laid out with a font, at a scale of 1
+	/// </summary>
+	struct TextLayout {
+		// The visible glyphs, with positions relative to the text's origin
+		std::vector<GlyphInfo> Glyphs;
+		// The size of the text, as returned by Font::MeausureString
+		glm::vec2              Size;
+		// The font atlas that the glyph UVs refer to
+		uint32_t               AtlasGeneration;
+	};
+
 	/// <summary>
 	/// The font resource wraps around stb_truetype to allow us to render text to the screen
 	/// A Font class contains the texture atlas and data needed to render glyphs using said atlas
+	///
+	/// Glyphs are rasterized the first time they are used, and packed into an atlas that grows
+	/// as more glyphs are needed. Since the atlas texture may be replaced when it grows, the atlas
+	/// should be fetched after looking up glyphs, and anything that holds on to glyph UVs should
+	/// check GetAtlasGeneration
 	/// </summary>
 	class Font : public IResource {
 	public:
@@ -31,48 +61,81 @@
 		/// if present
 		/// </summary>
 		/// <param name="fontPath">The path to the truetype font</param>
-		/// <param name="size">The size to render to font in the font atlas</param>
+		/// <param name="size">The size of the font in pixels</param>
 		void Load(const std::string& fontPath, float size = 16.0f);
 
 		/// <summary>
-		/// Adds a range of unicode characters to enable in this font.
-		/// Since we are rendering to a texture, we need to know all of the characters
-		/// that we will want to render ahead of time
+		/// Adds a range of unicode characters to load when the font is baked. Glyphs
+		/// outside of these ranges are still loaded the first time they are used
 		/// </summary>
 		/// <param name="min">The minimum unicode character (inclusive)</param>
 		/// <param name="max">The maximum unicode character (inclusive)</param>
 		void AddGlyphRange(uint32_t min, uint32_t max);
 
 		/// <summary>
-		/// Generates the texture to use when rendering with this font, must be called
-		/// before the font is used
+		/// Rasterizes all the glyphs in the font's glyph ranges into the atlas ahead of
+		/// time, so that the atlas doesn't need to grow while rendering common text
 		/// </summary>
 		void Bake();
 		/// <summary>
-		/// Gets the texture atlas for this font
+		/// Gets the texture atlas for this font, note that this may change whenever a
+		/// new glyph is loaded
 		/// </summary>
 		const Texture2D::Sptr& GetAtlas();
+		/// <summary>
+		/// Gets a counter that is incremented every time the atlas is replaced, any UVs from
+		/// an older generation refer to the old atlas
+		/// </summary>
+		uint32_t GetAtlasGeneration() const { return _atlasGeneration; }
+
+		/// <summary>
+		/// Sets how glyphs are stored in the atlas, this will clear the glyph cache. Fonts use bitmaps
+		/// unless they opt in to SDF
+		/// </summary>
+		void SetRenderMode(FontRenderMode mode);
+		/// <summary>
+		/// Gets how glyphs are stored in the atlas
+		/// </summary>
+		FontRenderMode GetRenderMode() const { return _renderMode; }
 
 		/// <summary>
 		/// Extracts information about a glyph with the given codepoint, positioning
-		/// it at the offset provided
+		/// it at the offset provided. Loads the glyph into the atlas if needed
 		/// </summary>
 		/// <param name="codePoint">The unicode codepoint to attempt to lookup</param>
 		/// <param name="offsetX">The x position of the glyph</param>
 		/// <param name="offsetY">The y position of the glyph</param>
-		GlyphInfo GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const;
+		GlyphInfo GetGlyph(uint32_t codePoint, float offsetX, float offsetY);
 		/// <summary>
-		/// Gets the kerning (horizontal space) between 2 unicode characters
+		/// Gets the kerning (horizontal space) between 2 unicode characters. Pairs
+		/// in the ASCII range are precomputed when the font is baked, others are
+		/// cached the first time they are looked up
 		/// </summary>
 		/// <param name="char1">The left character</param>
 		/// <param name="char2">The right character</param>
 		/// <returns>The space between characters</returns>
-		float  GetKerning(int char1, int char2) const;
+		float  GetKerning(int char1, int char2);
 		/// <summary>
 		/// Returns the vertical height of a line of text for this font
 		/// </summary>
 		float  GetLineHeight() const;
 
+		/// <summary>
+		/// Lays out a string of codepoints with this font. Recently used layouts are cached, so
+		/// text that doesn't change is only laid out once. The result is valid until the next
+		/// call to GetLayout or MeausureString
+		/// </summary>
+		/// <param name="text">The codepoints to lay out</param>
+		const TextLayout& GetLayout(const std::u32string& text);
+		/// <summary>
+		/// Lays out a UTF-8 string with this font, see the u32string overload
+		/// </summary>
+		const TextLayout& GetLayout(const std::string& text);
+		/// <summary>
+		/// Lays out a unicode string with this font, see the u32string overload
+		/// </summary>
+		const TextLayout& GetLayout(const std::wstring& text);
+
 		/// <summary>
 		/// Measures the size of a string using this font
 		/// </summary>
@@ -93,13 +156,46 @@
 		static Font::Sptr FromJson(const nlohmann::json& data);
 
 	protected:
+		// Codepoints below this (ASCII and the latin blocks) are looked up in a flat table, everything else goes through a map
+		static constexpr uint32_t FLAT_GLYPH_COUNT = 0x250;
+		// Marks a flat table entry or default glyph that has not been loaded yet
+		static constexpr uint32_t NO_GLYPH = UINT32_MAX;
+		// Kerning between pairs of codepoints below this is precomputed into a flat table
+		static constexpr uint32_t KERNING_TABLE_SIZE = 128;
+		// The number of laid out strings to keep around
+		static constexpr size_t   LAYOUT_CACHE_SIZE = 256;
+
+		// A glyph that has been rasterized into the atlas
+		struct CachedGlyph {
+			GlyphInfo  Info;
+			// The glyph's rectangle in the atlas in pixels, so we can re-calculate UVs when the atlas grows
+			glm::uvec2 AtlasPos;
+			glm::uvec2 AtlasSize;
+		};
+
 		std::vector<glm::uvec2> _glyphRanges;
-		std::map<uint32_t, GlyphInfo> _glyphMap;
-		GlyphInfo                     _defaultGlyph;
+		std::vector<CachedGlyph> _glyphs;
+		uint32_t                 _flatGlyphs[FLAT_GLYPH_COUNT];
+		std::unordered_map<uint32_t, uint32_t> _glyphLookup;
+		uint32_t                 _defaultGlyph;
+
+		// KERNING_TABLE_SIZE^2 kerning values in font pixels, empty until the font is baked
+		std::vector<float>       _kerningTable;
+		// Kerning for pairs outside of the table, keyed by (char1 << 32 | char2)
+		std::unordered_map<uint64_t, float> _kerningCache;
+
+		// Most recently used layouts are at the front
+		std::list<std::pair<std::u32string, TextLayout>> _layouts;
+		std::unordered_map<std::u32string, std::list<std::pair<std::u32string, TextLayout>>::iterator> _layoutLookup;
+		// Re-used when decoding strings for layout, so that lookups don't allocate
+		std::u32string           _decodeScratch;
+
 		Texture2D::Sptr   _atlas;
+		uint32_t          _atlasGeneration;
 		std::string       _fontPath;
 		std::string       _fontData;
 		float             _fontSize;
+		FontRenderMode    _renderMode;
 
 		float             _pixelHeightScale;
 		float             _emToPixel;
@@ -109,9 +205,50 @@
 
 		uint32_t          _atlasWidth,
 			              _atlasHeight;
+		// Glyphs are packed in rows, left to right
+		glm::uvec2        _packCursor;
+		uint32_t          _shelfHeight;
 
-		stbtt_packedchar* _glyphs;
 		stbtt_fontinfo    _fontInfo;
 
-		GlyphInfo __CreateGlyph(uint32_t index);
-	};
\ No newline at end of file
+		/// <summary>
+		/// Removes all glyphs and the atlas, glyphs will be re-loaded as they are used
+		/// </summary>
+		void _ClearGlyphs();
+		/// <summary>
+		/// Fills the kerning table for pairs of codepoints in the ASCII range
+		/// </summary>
+		void _BuildKerningTable();
+		/// <summary>
+		/// Positions the glyphs for a string of codepoints
+		/// </summary>
+		void _LayoutText(const std::u32string& text, TextLayout& layout);
+		/// <summary>
+		/// Gets the index in _glyphs for the given codepoint, loading it if needed
+		/// </summary>
+		uint32_t _GetGlyphIndex(uint32_t codePoint);
+		/// <summary>
+		/// Gets the glyph used for characters that are missing from the font
+		/// </summary>
+		uint32_t _GetDefaultGlyph();
+		/// <summary>
+		/// Rasterizes a glyph from the font file into the atlas
+		/// </summary>
+		/// <param name="glyphIndex">The font's index for the glyph (not the codepoint)</param>
+		/// <returns>The index of the new glyph in _glyphs</returns>
+		uint32_t _RasterizeGlyph(int glyphIndex);
+		/// <summary>
+		/// Finds space in the atlas for a glyph, growing the atlas if there is no room
+		/// </summary>
+		/// <returns>False if the atlas is full and cannot grow any larger</returns>
+		bool _AllocateRect(uint32_t width, uint32_t height, glm::uvec2& outPos);
+		/// <summary>
+		/// Doubles the size of the atlas, copying over the existing glyphs
+		/// </summary>
+		/// <returns>False if the atlas is already at the maximum size</returns>
+		bool _GrowAtlas();
+		/// <summary>
+		/// Creates an empty atlas texture of the given size
+		/// </summary>
+		static Texture2D::Sptr __CreateAtlasTexture(uint32_t width, uint32_t height);
+	};
@@ -2,56 +2,81 @@
 #include <GLM/gtc/matrix_transform.hpp>
 #include <GLM/gtc/matrix_inverse.hpp>
 #include "Utils/ResourceManager/ResourceManager.h"
-#include <locale>
-#include <codecvt>
+#include "Utils/HashedString.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	// Index patterns for a single quad, rects and glyphs are wound differently
+	constexpr uint32_t RECT_INDICES[6]  = { 0, 2, 1, 0, 3, 2 };
+	constexpr uint32_t GLYPH_INDICES[6] = { 0, 1, 2, 0, 2, 3 };
+
+	/// <summary>
+	/// Uploads only the range of data that differs from what was uploaded last time. If the data has
+	/// outgrown the buffer, it is uploaded in full
+	/// </summary>
+	template <typename T>
+	void UploadChanges(IBuffer& buffer, const T* data, uint32_t count, const T* previous, uint32_t previousCount) {
+		if (count * sizeof(T) > buffer.GetTotalSize()) {
+			buffer.UpdateData(data, sizeof(T), count, true);
+			return;
+		}
 
+		// Find the first and last elements that differ, anything past the end of the old data has changed
+		uint32_t compareCount = std::min(count, previousCount);
+		uint32_t first = 0;
+		while (first < compareCount && memcmp(&data[first], &previous[first], sizeof(T)) == 0) {
+			first++;
+		}
+		uint32_t last = count;
+		if (count <= previousCount) {
+			while (last > first && memcmp(&data[last - 1], &previous[last - 1], sizeof(T)) == 0) {
+				last--;
+			}
+		}
 
-std::unordered_map<Texture2D*, GuiBatcher::MeshData> GuiBatcher::_meshBuilders;
+		if (last > first) {
+			buffer.UpdateSubData(data + first, sizeof(T), first, last - first);
+		}
+		buffer.SetElementCount(count);
+	}
+}
 
+MeshBuilder<VertexPosColTex> GuiBatcher::__builders[2];
+uint32_t GuiBatcher::__currentBuilder = 0;
+std::vector<GuiBatcher::DrawCommand> GuiBatcher::__drawCommands;
 VertexArrayObject::Sptr GuiBatcher::__vao = nullptr;
+VertexBuffer::Sptr GuiBatcher::__vbo = nullptr;
 IndexBuffer::Sptr GuiBatcher::__ibo = nullptr;
+TextureAtlas::Uptr GuiBatcher::__atlas = nullptr;
+GuiGeometryCache* GuiBatcher::__recordingCache = nullptr;
 
 Texture2D::Sptr GuiBatcher::__defaultUITexture = nullptr;
 int GuiBatcher::__defaultEdgeRadius = 0;
 
-VertexBuffer::Sptr GuiBatcher::__vbo = nullptr;
 ShaderProgram::Sptr GuiBatcher::__shader = nullptr;
 ShaderProgram::Sptr GuiBatcher::__fontShader = nullptr;
+ShaderProgram::Sptr GuiBatcher::__sdfFontShader = nullptr;
 glm::ivec2 GuiBatcher::__windowSize = {0, 0};
 glm::mat4 GuiBatcher::__projection = glm::mat4(1.0f);
 glm::mat3 GuiBatcher::__model = glm::mat3(1.0f);
 std::vector<glm::mat3> GuiBatcher::__modelTransformStack = std::vector<glm::mat3>();
-std::vector<GuiBatcher::IRect> GuiBatcher::__scissorRects = std::vector<GuiBatcher::IRect>();
+glm::ivec4 GuiBatcher::__viewport = {0, 0, 0, 0};
+std::vector<GuiBatcher::ClipRect> GuiBatcher::__scissorRects = std::vector<GuiBatcher::ClipRect>();
 
 void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, const glm::vec2 uvMin, const glm::vec2 uvMax) {
-	// Create vertices and transform positions
-	VertexPosColTex verts[4];
-	verts[0].Position = __model * glm::vec3(min.x, min.y, 1.0f);
-	verts[1].Position = __model * glm::vec3(min.x, max.y, 1.0f);
-	verts[2].Position = __model * glm::vec3(max.x, max.y, 1.0f);
-	verts[3].Position = __model * glm::vec3(max.x, min.y, 1.0f);
-		
-	// Grab mesh info for the texture batch
-	MeshData& mesh = _meshBuilders[tex.get()];
-	// We can use the vertex count for depth, so that things drawn later have a bit of spacing
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
-
-	// Copy in all color and set depth 
-	for (int ix = 0; ix < 4; ix++) {
-		verts[ix].Color = color;
-		verts[ix].Position.z = depth;
+	// UVs outside of [0,1] rely on the texture wrapping, which would sample the neighbours in an atlas page
+	bool inRange = glm::all(glm::greaterThanEqual(glm::min(uvMin, uvMax), glm::vec2(0.0f))) &&
+		glm::all(glm::lessThanEqual(glm::max(uvMin, uvMax), glm::vec2(1.0f)));
+	if (!inRange) {
+		__PushQuad(min, max, color, tex, uvMin, uvMax);
+		return;
 	}
 
-	// Copy over UV coords
-	verts[0].UV = glm::vec2(uvMin.x, uvMax.y);
-	verts[1].UV = glm::vec2(uvMin.x, uvMin.y);
-	verts[2].UV = glm::vec2(uvMax.x, uvMin.y);
-	verts[3].UV = glm::vec2(uvMax.x, uvMax.y);
-
-	// Add vertices and indices to range
-	uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 1);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 3, ix + 2);
+	Texture2D::Sptr drawTex;
+	glm::vec2 atlasMin, atlasMax;
+	__ResolveAtlas(tex, drawTex, atlasMin, atlasMax);
+	__PushQuad(min, max, color, drawTex, glm::mix(atlasMin, atlasMax, uvMin), glm::mix(atlasMin, atlasMax, uvMax));
 }
 
 void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, int edgeRadius)
@@ -60,6 +85,14 @@ void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm:
 		PushRect(min, max, color, tex, { 0,0 }, { 1,1 });
 	} 
 	else {
+		// Look up the texture in the atlas once for all 9 slices
+		Texture2D::Sptr drawTex;
+		glm::vec2 atlasMin, atlasMax;
+		__ResolveAtlas(tex, drawTex, atlasMin, atlasMax);
+		auto pushSlice = [&](const glm::vec2& sMin, const glm::vec2& sMax, const glm::vec2& uvMin, const glm::vec2& uvMax) {
+			__PushQuad(sMin, sMax, color, drawTex, glm::mix(atlasMin, atlasMax, uvMin), glm::mix(atlasMin, atlasMax, uvMax));
+		};
+
 		glm::vec2 edgeOffset;
 		edgeOffset.x = edgeRadius / ((float)tex->GetWidth() - 2);
 		edgeOffset.y = edgeRadius / ((float)tex->GetHeight() - 2);
@@ -77,19 +110,62 @@ void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm:
 		float uMaxYS = 1.0f - edgeOffset.y;
 
 		// Left column
-		PushRect(glm::vec2(min.x, min.y),  glm::vec2(eMinXS, eMinYS), color, tex, glm::vec2(0.0f, uMaxYS),   glm::vec2(uMinXS, 1.0f));
-		PushRect(glm::vec2(min.x, eMinYS), glm::vec2(eMinXS, eMaxYS), color, tex, glm::vec2(0.0f, uMinYS), glm::vec2(uMinXS, uMaxYS));
-		PushRect(glm::vec2(min.x, eMaxYS), glm::vec2(eMinXS, max.y),  color, tex, glm::vec2(0.0f, 0.0f), glm::vec2(uMinXS, uMinYS));
+		pushSlice(glm::vec2(min.x, min.y),  glm::vec2(eMinXS, eMinYS), glm::vec2(0.0f, uMaxYS),   glm::vec2(uMinXS, 1.0f));
+		pushSlice(glm::vec2(min.x, eMinYS), glm::vec2(eMinXS, eMaxYS), glm::vec2(0.0f, uMinYS), glm::vec2(uMinXS, uMaxYS));
+		pushSlice(glm::vec2(min.x, eMaxYS), glm::vec2(eMinXS, max.y),  glm::vec2(0.0f, 0.0f), glm::vec2(uMinXS, uMinYS));
 
 		// Center column
-		PushRect(glm::vec2(eMinXS, min.y),  glm::vec2(eMaxXS, eMinYS), color, tex, glm::vec2(uMinXS, uMaxYS),   glm::vec2(uMaxXS, 1.0f));
-		PushRect(glm::vec2(eMinXS, eMinYS), glm::vec2(eMaxXS, eMaxYS), color, tex, glm::vec2(uMinXS, uMinYS), glm::vec2(uMaxXS, uMaxYS));
-		PushRect(glm::vec2(eMinXS, eMaxYS), glm::vec2(eMaxXS, max.y), color, tex,  glm::vec2(uMinXS, 0.0f), glm::vec2(uMaxXS, uMinYS));
+		pushSlice(glm::vec2(eMinXS, min.y),  glm::vec2(eMaxXS, eMinYS), glm::vec2(uMinXS, uMaxYS),   glm::vec2(uMaxXS, 1.0f));
+		pushSlice(glm::vec2(eMinXS, eMinYS), glm::vec2(eMaxXS, eMaxYS), glm::vec2(uMinXS, uMinYS), glm::vec2(uMaxXS, uMaxYS));
+		pushSlice(glm::vec2(eMinXS, eMaxYS), glm::vec2(eMaxXS, max.y),  glm::vec2(uMinXS, 0.0f), glm::vec2(uMaxXS, uMinYS));
 
 		// Right column
-		PushRect(glm::vec2(eMaxXS, min.y),  glm::vec2(max.x, eMinYS), color, tex, glm::vec2(uMaxXS, uMaxYS),   glm::vec2(1.0f, 1.0f));
-		PushRect(glm::vec2(eMaxXS, eMinYS), glm::vec2(max.x, eMaxYS), color, tex, glm::vec2(uMaxXS, uMinYS), glm::vec2(1.0f, uMaxYS));
-		PushRect(glm::vec2(eMaxXS, eMaxYS), glm::vec2(max.x, max.y),  color, tex, glm::vec2(uMaxXS, 0.0f), glm::vec2(1.0f, uMinYS));
+		pushSlice(glm::vec2(eMaxXS, min.y),  glm::vec2(max.x, eMinYS), glm::vec2(uMaxXS, uMaxYS),   glm::vec2(1.0f, 1.0f));
+		pushSlice(glm::vec2(eMaxXS, eMinYS), glm::vec2(max.x, eMaxYS), glm::vec2(uMaxXS, uMinYS), glm::vec2(1.0f, uMaxYS));
+		pushSlice(glm::vec2(eMaxXS, eMaxYS), glm::vec2(max.x, max.y),  glm::vec2(uMaxXS, 0.0f), glm::vec2(1.0f, uMinYS));
+	}
+}
+
+void GuiBatcher::__PushQuad(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, const glm::vec2& uvMin, const glm::vec2& uvMax)
+{
+	// Create vertices and transform positions, we don't need depth since draws are submitted in order
+	VertexPosColTex verts[4];
+	verts[0].Position = glm::vec3(glm::vec2(__model * glm::vec3(min.x, min.y, 1.0f)), 0.0f);
+	verts[1].Position = glm::vec3(glm::vec2(__model * glm::vec3(min.x, max.y, 1.0f)), 0.0f);
+	verts[2].Position = glm::vec3(glm::vec2(__model * glm::vec3(max.x, max.y, 1.0f)), 0.0f);
+	verts[3].Position = glm::vec3(glm::vec2(__model * glm::vec3(max.x, min.y, 1.0f)), 0.0f);
+
+	// Copy in all color
+	for (int ix = 0; ix < 4; ix++) {
+		verts[ix].Color = color;
+	}
+
+	// Copy over UV coords
+	verts[0].UV = glm::vec2(uvMin.x, uvMax.y);
+	verts[1].UV = glm::vec2(uvMin.x, uvMin.y);
+	verts[2].UV = glm::vec2(uvMax.x, uvMin.y);
+	verts[3].UV = glm::vec2(uvMax.x, uvMax.y);
+
+	// Add vertices and indices to range
+	__AddGeometry(tex, GuiShader::Default, verts, 4, RECT_INDICES, 6);
+}
+
+void GuiBatcher::__ResolveAtlas(const Texture2D::Sptr& tex, Texture2D::Sptr& drawTex, glm::vec2& uvMin, glm::vec2& uvMax)
+{
+	if (__atlas == nullptr) {
+		__atlas = std::make_unique<TextureAtlas>();
+	}
+
+	// Textures that can't be packed are drawn on their own
+	TextureAtlas::Region region;
+	if (__atlas->GetRegion(tex, region)) {
+		drawTex = region.Page;
+		uvMin = region.UvMin;
+		uvMax = region.UvMax;
+	} else {
+		drawTex = tex;
+		uvMin = glm::vec2(0.0f);
+		uvMax = glm::vec2(1.0f);
 	}
 }
 
@@ -98,21 +174,21 @@ void GuiBatcher::SetProjection(const glm::mat4& projection) {
 }
 
 void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/) {
-	// How many characters we have
-	size_t length = text.size();
-
-	// Tracks the offset of the character
-	glm::vec2 offset = glm::vec2(0.0f);
+	__RenderLayout(font->GetLayout(text), font, position, color, scale);
+}
 
-	// Transform the origin based off the model transform
-	glm::vec2 origin = position;
+void GuiBatcher::RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/)
+{
+	__RenderLayout(font->GetLayout(text), font, position, color, scale);
+}
 
-	// Gets the texture used to render the font
-	Texture2D::Sptr atlas = font->GetAtlas();
+void GuiBatcher::__RenderLayout(const TextLayout& layout, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale)
+{
+	// SDF fonts need a different shader to turn distances into coverage
+	GuiShader shader = font->GetRenderMode() == FontRenderMode::Sdf ? GuiShader::SdfFont : GuiShader::Font;
 
-	// Grab the mesh builder and make sure it's a texture batch
-	MeshData& mesh = _meshBuilders[atlas.get()];
-	mesh.IsFont = true;
+	// The layout has already loaded all of it's glyphs, so the atlas won't change while we're adding them
+	const Texture2D::Sptr& atlas = font->GetAtlas();
 
 	// Allocate some space for the vertices
 	VertexPosColTex verts[4];
@@ -121,94 +197,179 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 	verts[2].Color = color;
 	verts[3].Color = color;
 
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
+	// The glyphs are already positioned, we just need to scale and transform them
+	for (const GlyphInfo& glyph : layout.Glyphs) {
+		for (int ix = 0; ix < 4; ix++) {
+			verts[ix].Position = glm::vec3(glm::vec2(__model * glm::vec3(position + glyph.Positions[ix] * scale, 1.0f)), 0.0f);
+			verts[ix].UV = glyph.UVs[ix];
+		}
+
+		__AddGeometry(atlas, shader, verts, 4, GLYPH_INDICES, 6);
+	}
+}
 
-	// Iterate over all characters in string
-	for (int i = 0; i < length; i++) {
-		// Grab the glyph data for the character
-		GlyphInfo glyph = font->GetGlyph(text[i], offset.x, offset.y);
+bool GuiBatcher::BeginCachedGeometry(GuiGeometryCache& cache, uint32_t contentHash)
+{
+	LOG_ASSERT(__recordingCache == nullptr, "Cannot record geometry into two caches at once!");
 
-		// A newline will advance to the next line and return to the start of the line
-		if (text[i] == '\n') {
-			offset.y  += font->GetLineHeight() * scale;
-			offset.x = 0;
-		}
-		// A return character simply returns to the start of the line
-		else if (text[i] == '\r') {
-			offset.x = 0;
+	// Geometry is generated in the current model space, so moving an element invalidates it's cache. Quads
+	// outside the clip region are never recorded, so changing the clip region does as well
+	uint32_t hash = Fnv1a32(&__model, sizeof(glm::mat3), contentHash);
+	if (!__scissorRects.empty()) {
+		hash = Fnv1a32(&__scissorRects.back(), sizeof(ClipRect), hash);
+	}
+
+	if (cache.IsValid && cache.Hash == hash) {
+		// Replay the cached geometry in order, the indices need to be offset to where the vertices land
+		MeshBuilder<VertexPosColTex>& builder = __builders[__currentBuilder];
+		for (const GuiGeometryCache::Batch& batch : cache.Batches) {
+			DrawCommand& command = __GetDrawCommand(batch.Texture, batch.Shader);
+
+			uint32_t offset = builder.AddVertexRange(batch.Vertices.data(), static_cast<uint32_t>(batch.Vertices.size()));
+			builder.ReserveIndexSpace(batch.Indices.size());
+			for (uint32_t index : batch.Indices) {
+				builder.AddIndex(offset + index);
+			}
+			command.IndexCount += static_cast<uint32_t>(batch.Indices.size());
 		}
-		// A tab character is 4 spaces
-		else if (text[i] == '\t') {
-			float xOffTemp{ 0 }, yOffTemp{ 0 };
-			glyph = font->GetGlyph(' ', xOffTemp, yOffTemp);
-			offset.x += glyph.OffsetX * 4;
+		return false;
+	}
+
+	cache.Hash = hash;
+	cache.IsValid = false;
+	cache.Batches.clear();
+	__recordingCache = &cache;
+	return true;
+}
+
+void GuiBatcher::EndCachedGeometry()
+{
+	LOG_ASSERT(__recordingCache != nullptr, "Cached geometry begin/end mismatch");
+	__recordingCache->IsValid = true;
+	__recordingCache = nullptr;
+}
+
+void GuiBatcher::__AddGeometry(const Texture2D::Sptr& tex, GuiShader shader, const VertexPosColTex* verts, uint32_t vertCount, const uint32_t* indices, uint32_t indexCount)
+{
+	// Drop geometry that would be entirely clipped, so long scrolling lists don't fill the batch with invisible quads
+	if (!__scissorRects.empty()) {
+		glm::vec2 min = glm::vec2(verts[0].Position);
+		glm::vec2 max = min;
+		for (uint32_t ix = 1; ix < vertCount; ix++) {
+			min = glm::min(min, glm::vec2(verts[ix].Position));
+			max = glm::max(max, glm::vec2(verts[ix].Position));
 		}
-		// All other characters get rendered
-		else {
-			verts[0].Position = __model * glm::vec3(origin + (offset + glyph.Positions[0]) * scale, 1.0f);
-			verts[1].Position = __model * glm::vec3(origin + (offset + glyph.Positions[1]) * scale, 1.0f);
-			verts[2].Position = __model * glm::vec3(origin + (offset + glyph.Positions[2]) * scale, 1.0f);
-			verts[3].Position = __model * glm::vec3(origin + (offset + glyph.Positions[3]) * scale, 1.0f);
-			verts[0].UV = glyph.UVs[0];
-			verts[1].UV = glyph.UVs[1];
-			verts[2].UV = glyph.UVs[2];
-			verts[3].UV = glyph.UVs[3];
-
-			verts[0].Position.z = verts[1].Position.z = verts[2].Position.z = verts[3].Position.z = depth;
-
-			uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 1, ix + 2);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 3);
-
-			// Advance the offset based on the size of the glyph
-			offset.x = glyph.OffsetX;
-			offset.y = glyph.OffsetY;
-
-			// If we have more characters, see if there's any kerning between the
-			// current and next character and add it to the x offset
-			if (i < length - 1) {
-				float kerning = font->GetKerning(text[i], text[i + 1]);
-				offset.x += kerning;
-			}
+		if (!__IsInsideClip(min, max)) {
+			return;
 		}
+	}
+
+	DrawCommand& command = __GetDrawCommand(tex, shader);
+	MeshBuilder<VertexPosColTex>& builder = __builders[__currentBuilder];
 
+	uint32_t offset = builder.AddVertexRange(verts, vertCount);
+	builder.ReserveIndexSpace(indexCount);
+	for (uint32_t ix = 0; ix < indexCount; ix++) {
+		builder.AddIndex(offset + indices[ix]);
 	}
+	command.IndexCount += indexCount;
+
+	if (__recordingCache != nullptr) {
+		// Batches are kept in submission order, so we can only append to the last one
+		std::vector<GuiGeometryCache::Batch>& batches = __recordingCache->Batches;
+		if (batches.empty() || batches.back().Texture != tex || batches.back().Shader != shader) {
+			GuiGeometryCache::Batch& batch = batches.emplace_back();
+			batch.Texture = tex;
+			batch.Shader = shader;
+		}
+		GuiGeometryCache::Batch& batch = batches.back();
 
+		uint32_t batchOffset = static_cast<uint32_t>(batch.Vertices.size());
+		batch.Vertices.insert(batch.Vertices.end(), verts, verts + vertCount);
+		for (uint32_t ix = 0; ix < indexCount; ix++) {
+			batch.Indices.push_back(batchOffset + indices[ix]);
+		}
+	}
 }
 
-void GuiBatcher::RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/)
+GuiBatcher::DrawCommand& GuiBatcher::__GetDrawCommand(const Texture2D::Sptr& tex, GuiShader shader)
 {
-	static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-	RenderText(converter.from_bytes(text), font, position, color, scale);
+	bool isClipped = !__scissorRects.empty();
+	ClipRect clip = isClipped ? __scissorRects.back() : ClipRect{ glm::vec2(0.0f), glm::vec2(0.0f) };
+
+	// Geometry is drawn in the order it was pushed, so we only start a new draw when the texture, shader or scissor changes
+	bool needsCommand = __drawCommands.empty();
+	if (!needsCommand) {
+		const DrawCommand& last = __drawCommands.back();
+		needsCommand = last.Texture != tex || last.Shader != shader || last.IsClipped != isClipped ||
+			(isClipped && (last.Clip.Min != clip.Min || last.Clip.Max != clip.Max));
+	}
+	if (needsCommand) {
+		uint32_t firstIndex = static_cast<uint32_t>(__builders[__currentBuilder].GetIndexCount());
+		__drawCommands.push_back({ tex, shader, isClipped, clip, firstIndex, 0 });
+	}
+	return __drawCommands.back();
 }
 
 void GuiBatcher::Flush()
 {
 	__StaticInit();
 
-	// Iterate over each texture and it's mesh
-	for (auto&[key, value] : _meshBuilders) {
-		Texture2D* tex = key;
-		// If the texture exists and the mesh has data
-		if (tex != nullptr && value.Builder.GetIndexCount() > 0) {
-			// Update the VAO and it's buffers
-			__vao->Bind();
-			__vbo->UpdateData(value.Builder.GetVertexDataPtr(), sizeof(VertexPosColTex), value.Builder.GetVertexCount(), true);
-			__ibo->UpdateData(value.Builder.GetIndexDataPtr(), sizeof(uint32_t), value.Builder.GetIndexCount(), true);
-
-			// Bind texture, send uniforms to shader
-			tex->Bind(0);
-			ShaderProgram::Sptr shader = value.IsFont ? __fontShader : __shader;
-			shader->Bind();
-			shader->SetUniformMatrix(0, &__projection, 1, false);
-
-			// Draw geometry
-			__vao->Draw();
-
-			// Clear mesh
-			value.Builder.Reset();
+	MeshBuilder<VertexPosColTex>& current  = __builders[__currentBuilder];
+	MeshBuilder<VertexPosColTex>& previous = __builders[__currentBuilder ^ 1];
+
+	if (current.GetIndexCount() > 0) {
+		// Most UI doesn't change between frames, so we only upload what's different from the last flush
+		UploadChanges(*__vbo, current.GetVertexDataPtr(), static_cast<uint32_t>(current.GetVertexCount()), previous.GetVertexDataPtr(), static_cast<uint32_t>(previous.GetVertexCount()));
+		UploadChanges(*__ibo, current.GetIndexDataPtr(), static_cast<uint32_t>(current.GetIndexCount()), previous.GetIndexDataPtr(), static_cast<uint32_t>(previous.GetIndexCount()));
+
+		// Draw each run of geometry in the order it was submitted
+		bool scissorEnabled = false;
+		for (const DrawCommand& command : __drawCommands) {
+			if (command.Texture != nullptr && command.IndexCount > 0) {
+				// Switch scissor state only when it changes between commands
+				if (command.IsClipped) {
+					// Project the clip rect into NDC ([-1,1]), then into the viewport
+					glm::vec2 minNDC = __projection * glm::vec4(command.Clip.Min, 0.0f, 1.0f);
+					glm::vec2 maxNDC = __projection * glm::vec4(command.Clip.Max, 0.0f, 1.0f);
+					glm::vec2 viewportPos = glm::vec2(__viewport.x, __viewport.y);
+					glm::vec2 viewportSize = glm::vec2(__viewport.z, __viewport.w);
+					glm::vec2 a = viewportPos + ((minNDC + 1.0f) / 2.0f) * viewportSize;
+					glm::vec2 b = viewportPos + ((maxNDC + 1.0f) / 2.0f) * viewportSize;
+
+					// The projection may flip axes, so sort the corners
+					glm::ivec2 minWin = glm::floor(glm::min(a, b));
+					glm::ivec2 maxWin = glm::ceil(glm::max(a, b));
+					glScissor(minWin.x, minWin.y, maxWin.x - minWin.x, maxWin.y - minWin.y);
+					if (!scissorEnabled) {
+						glEnable(GL_SCISSOR_TEST);
+						scissorEnabled = true;
+					}
+				} else if (scissorEnabled) {
+					glDisable(GL_SCISSOR_TEST);
+					scissorEnabled = false;
+				}
+
+				// Bind texture, send uniforms to shader
+				command.Texture->Bind(0);
+				ShaderProgram::Sptr shader = command.Shader == GuiShader::SdfFont ? __sdfFontShader :
+					command.Shader == GuiShader::Font ? __fontShader : __shader;
+				shader->Bind();
+				shader->SetUniformMatrix(0, &__projection, 1, false);
+
+				__vao->DrawRange(command.FirstIndex, command.IndexCount);
+			}
+		}
+		if (scissorEnabled) {
+			glDisable(GL_SCISSOR_TEST);
 		}
+
+		// This flush's geometry is now what's on the GPU, the old builder gets cleared for the next batch
+		previous.Reset();
+		__currentBuilder ^= 1;
 	}
+
+	__drawCommands.clear();
 }
 
 void GuiBatcher::PushModelTransform(const glm::mat3& transform) {
@@ -225,6 +386,11 @@ void GuiBatcher::PopModelTransform()
 
 void GuiBatcher::SetWindowSize(const glm::ivec2& size) {
 	__windowSize = size;
+	__viewport = glm::ivec4(0, 0, size.x, size.y);
+}
+
+void GuiBatcher::SetViewport(const glm::ivec4& viewport) {
+	__viewport = viewport;
 }
 
 void GuiBatcher::__StaticInit()
@@ -298,6 +464,43 @@ void GuiBatcher::__StaticInit()
 
 		__fontShader->Link();
 
+		__sdfFontShader = ShaderProgram::Create();
+		__sdfFontShader->LoadShaderPart(R"LIT(#version 460
+					layout(location = 0) in vec3 inPos;
+					layout(location = 1) in vec4 inColor;
+					layout(location = 3) in vec2 inUV;
+
+					layout(location = 0) out vec4 outColor;
+					layout(location = 1) out vec2 outUV;
+
+					layout(location = 0) uniform mat4 u_Projection;
+
+					void main() {
+						outColor = inColor;
+						outUV = inUV;
+						gl_Position = u_Projection * vec4(inPos, 1);
+					}
+				)LIT", ShaderPartType::Vertex);
+
+		__sdfFontShader->LoadShaderPart(R"LIT(#version 460
+					layout(location = 0) in vec4 inColor;
+					layout(location = 1) in vec2 inUV;
+
+					layout(location = 0) out vec4 outColor;
+
+					uniform layout(binding=0) sampler2D s_Texture;
+
+					void main() {
+						// The glyph edge is at 0.5, we blend over about a pixel on screen so text stays sharp at any scale
+						float dist = texture(s_Texture, inUV).r;
+						float width = max(fwidth(dist), 0.0001);
+						float fontPow = smoothstep(0.5 - width, 0.5 + width, dist);
+						outColor = vec4(inColor.rgb, fontPow);
+					}
+				)LIT" , ShaderPartType::Fragment);
+
+		__sdfFontShader->Link();
+
 		__vbo = VertexBuffer::Create(BufferUsage::DynamicDraw);
 		__ibo = IndexBuffer::Create(BufferUsage::DynamicDraw, IndexType::UInt);
 
@@ -334,44 +537,54 @@ void GuiBatcher::__StaticInit()
 }
 
 void GuiBatcher::PushScissorRect(const glm::vec2& min, const glm::vec2& max) {
-	// Convert input to the current space
-	glm::vec2 modelMin = __model * glm::vec3(min, 1.0f);
-	glm::vec2 modelMax = __model * glm::vec3(max, 1.0f);
-
-	// Project the values, will be in Normalized Device Coordinates ([-1,1])
-	glm::vec2 minNDC = __projection * glm::vec4(modelMin, 0.0f, 1.0f);
-	glm::vec2 maxNDC = __projection * glm::vec4(modelMax, 0.0f, 1.0f);
-
-	// Convert NDC to screenspace
-	glm::ivec2 minWin = glm::floor(((minNDC + 1.0f) / 2.0f) * (glm::vec2)__windowSize);
-	glm::ivec2 maxWin = glm::ceil(((maxNDC + 1.0f) / 2.0f)  * (glm::vec2)__windowSize);
-
-	// Store the bounds
-	__scissorRects.push_back({ minWin, maxWin });
+	// Convert input to batch space, rotated rects are clipped to their bounds
+	ClipRect rect = __TransformRect(min, max);
 
-	// Calculate the actual size
-	int width  = glm::max(maxWin.x, minWin.x) - glm::min(maxWin.x, minWin.x);
-	int height = glm::max(maxWin.y, minWin.y) - glm::min(maxWin.y, minWin.y);
+	// Nested regions can only shrink the visible area
+	if (!__scissorRects.empty()) {
+		rect.Min = glm::max(rect.Min, __scissorRects.back().Min);
+		rect.Max = glm::max(glm::min(rect.Max, __scissorRects.back().Max), rect.Min);
+	}
 
-	// Draw current geo with the current scissor, then update it
-	Flush();
-	glScissor(minWin.x, maxWin.y, width, height);
+	// Geometry records the region when it's pushed, so there's no need to flush
+	__scissorRects.push_back(rect);
 }
 
 void GuiBatcher::PopScissorRect() {
 	LOG_ASSERT(__scissorRects.size() > 0, "Scissor rect push/pop mismatch!");
 	__scissorRects.pop_back();
+}
 
-	// Grab the last scissor rect, or just use window bounds if none left
-	IRect bounds = __scissorRects.size() > 0 ? __scissorRects.back() : IRect{ { 0, 0 }, { __windowSize.x, __windowSize.y } };
+bool GuiBatcher::IsRectVisible(const glm::vec2& min, const glm::vec2& max) {
+	if (__scissorRects.empty()) {
+		return true;
+	}
+	ClipRect rect = __TransformRect(min, max);
+	return __IsInsideClip(rect.Min, rect.Max);
+}
 
-	// Calculate the actual size
-	int width  = glm::max(bounds.Min.x, bounds.Max.x) - glm::min(bounds.Min.x, bounds.Max.x);
-	int height = glm::max(bounds.Min.y, bounds.Max.y) - glm::min(bounds.Min.y, bounds.Max.y);
+bool GuiBatcher::__IsInsideClip(const glm::vec2& min, const glm::vec2& max) {
+	if (__scissorRects.empty()) {
+		return true;
+	}
+	const ClipRect& clip = __scissorRects.back();
+	return min.x < clip.Max.x && max.x > clip.Min.x && min.y < clip.Max.y && max.y > clip.Min.y;
+}
 
-	// Draw current geo with the current scissor, then update it
-	Flush();
-	glScissor(glm::min(bounds.Min.x, bounds.Max.x), glm::min(bounds.Min.y, bounds.Max.y), width, height);
+GuiBatcher::ClipRect GuiBatcher::__TransformRect(const glm::vec2& min, const glm::vec2& max) {
+	glm::vec2 corners[4] = {
+		__model * glm::vec3(min.x, min.y, 1.0f),
+		__model * glm::vec3(min.x, max.y, 1.0f),
+		__model * glm::vec3(max.x, max.y, 1.0f),
+		__model * glm::vec3(max.x, min.y, 1.0f)
+	};
+
+	ClipRect result = { corners[0], corners[0] };
+	for (int ix = 1; ix < 4; ix++) {
+		result.Min = glm::min(result.Min, corners[ix]);
+		result.Max = glm::max(result.Max, corners[ix]);
+	}
+	return result;
 }
 
 void GuiBatcher::SetDefaultTexture(const Texture2D::Sptr& value) {
@@ -3,6 +3,7 @@
 #include <GLM/glm.hpp>
 
 #include "Graphics/Textures/Texture2D.h"
+#include "Graphics/Textures/TextureAtlas.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
@@ -10,6 +11,43 @@
 #include "Utils/MeshBuilder.h"
 #include <unordered_map>
 
+	/// <summary>
+	/// The shaders that the GUI batcher can draw geometry with
+	/// </summary>
+	enum class GuiShader : uint8_t {
+		Default,
+		// Single channel bitmap font atlas
+		Font,
+		// Signed distance field font atlas
+		SdfFont
+	};
+
+	/// <summary>
+	/// Geometry generated by the GUI batcher on behalf of a GUI element. Elements hold on to one of
+	/// these so that static UI can skip re-generating it's quads every frame, see
+	/// GuiBatcher::BeginCachedGeometry
+	/// </summary>
+	struct GuiGeometryCache {
+		// A run of geometry that uses the same texture, in the order it was pushed
+		struct Batch {
+			Texture2D::Sptr              Texture;
+			GuiShader                    Shader;
+			std::vector<VertexPosColTex> Vertices;
+			// Indices are relative to the first vertex in the batch
+			std::vector<uint32_t>        Indices;
+		};
+
+		// The hash of the content and transform that the geometry was generated for
+		uint32_t           Hash = 0;
+		bool               IsValid = false;
+		std::vector<Batch> Batches;
+
+		/// <summary>
+		/// Forces the geometry to be re-generated the next time it is drawn
+		/// </summary>
+		void Invalidate() { IsValid = false; }
+	};
+
 	/// <summary>
 	/// The GUI Batcher class provides utilities for drawing rectangles and
 	/// fonts to the screen in a 2D fashion
@@ -49,23 +87,42 @@
 		/// <summary>
 		/// Renders a left-aligned line of text at the given position using a font
 		/// </summary>
-		/// <param name="text">The ASCII text to render</param>
+		/// <param name="text">The UTF-8 text to render</param>
 		/// <param name="font">The font to render with</param>
 		/// <param name="position">The position of the text in model space</param>
 		/// <param name="color">The color of the text</param>
 		/// <param name="scale">The scaling to apply to the text</param>
 		static void RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale = 1.0f);
 
+		/// <summary>
+		/// Starts drawing an element with cached geometry. If the cache was generated for the same content
+		/// and model transform, the cached geometry is added to the batch and this returns false. Otherwise
+		/// this returns true, and any geometry pushed until EndCachedGeometry is recorded into the cache
+		/// </summary>
+		/// <param name="cache">The cache for the element being drawn</param>
+		/// <param name="contentHash">A hash of everything that affects the element's geometry, other than the model transform</param>
+		/// <returns>True if the caller needs to push it's geometry and call EndCachedGeometry</returns>
+		static bool BeginCachedGeometry(GuiGeometryCache& cache, uint32_t contentHash);
+		/// <summary>
+		/// Stops recording geometry into the cache passed to BeginCachedGeometry
+		/// </summary>
+		static void EndCachedGeometry();
+
 		/// <summary>
 		/// Sets the projection matrix to use for rendering, should ideally be an orthographic
 		/// projection that matches the screen size
 		/// </summary>
 		static void SetProjection(const glm::mat4& projection);
 		/// <summary>
-		/// Sets the size of the window in pixels
+		/// Sets the size of the window in pixels, this also resets the viewport to cover the window
 		/// </summary>
 		static void SetWindowSize(const glm::ivec2& size);
 		/// <summary>
+		/// Sets the viewport that the GUI is rendered into, in window pixels (x, y, width, height). This is
+		/// needed to convert clip rects into scissor rects
+		/// </summary>
+		static void SetViewport(const glm::ivec4& viewport);
+		/// <summary>
 		/// Draws all geometry to the screen and prepares for the next batch
 		/// </summary>
 		static void Flush();
@@ -82,16 +139,24 @@
 		static void PopModelTransform();
 
 		/// <summary>
-		/// Sets a new scissor region in model space. Note that this will invoke a 
-		/// flush
+		/// Sets a new scissor region in model space, intersected with the current one. Geometry
+		/// pushed after this is clipped to the region, and quads that are entirely outside of it
+		/// are dropped before they are added to the batch
 		/// </summary>
 		/// <param name="min">The minimum bounds of the scissor rectangle</param>
 		/// <param name="min">The maximum bounds of the scissor rectangle</param>
 		static void PushScissorRect(const glm::vec2& min, const glm::vec2& max);
 		/// <summary>
-		/// Pops the last scissor region, not that this will invoke a flush
+		/// Pops the last scissor region
 		/// </summary>
 		static void PopScissorRect();
+		/// <summary>
+		/// Checks whether any part of a rectangle in model space is inside the current scissor
+		/// region, so that elements can skip generating geometry that would be clipped anyways
+		/// </summary>
+		/// <param name="min">The minimum bounds of the rectangle</param>
+		/// <param name="min">The maximum bounds of the rectangle</param>
+		static bool IsRectVisible(const glm::vec2& min, const glm::vec2& max);
 
 		/// <summary>
 		/// Sets the default texture to use for the background of GUI objects
@@ -113,30 +178,77 @@
 		static int GetDefaultBorderRadius();
 
 	private:
-		struct IRect {
-			glm::ivec2 Min;
-			glm::ivec2 Max;
+		// An axis aligned rectangle in the space that geometry is batched in (after the model transform)
+		struct ClipRect {
+			glm::vec2 Min;
+			glm::vec2 Max;
 		};
 
-		struct MeshData {
-			MeshBuilder<VertexPosColTex> Builder;
-			bool IsFont;
+		// A range of indices that are drawn with the same texture and shader
+		// Holds a reference to the texture, since font atlases may be replaced mid-batch when they grow
+		struct DrawCommand {
+			Texture2D::Sptr Texture;
+			GuiShader       Shader;
+			bool            IsClipped;
+			ClipRect        Clip;
+			uint32_t        FirstIndex;
+			uint32_t        IndexCount;
 		};
 
 		static glm::ivec2 __windowSize;
+		static glm::ivec4 __viewport;
 		static glm::mat4 __projection;
 		static glm::mat3 __model;
 		static std::vector<glm::mat3> __modelTransformStack;
-		static std::vector<IRect> __scissorRects;
+		// The stack of clip regions, each already intersected with the one below it
+		static std::vector<ClipRect> __scissorRects;
 		static ShaderProgram::Sptr __shader;
 		static ShaderProgram::Sptr __fontShader;
-		static std::unordered_map<Texture2D*, MeshData> _meshBuilders;
+		static ShaderProgram::Sptr __sdfFontShader;
+		// All geometry goes into one stream, double buffered so we can compare it against what is already
+		// on the GPU and only upload the parts that have changed
+		static MeshBuilder<VertexPosColTex> __builders[2];
+		static uint32_t __currentBuilder;
+		static std::vector<DrawCommand> __drawCommands;
 		static VertexArrayObject::Sptr __vao;
 		static VertexBuffer::Sptr __vbo;
 		static IndexBuffer::Sptr __ibo;
+		// Packs the textures used by rects into shared pages, so that panels can be drawn together
+		static TextureAtlas::Uptr __atlas;
+		// The cache that geometry is being recorded into, if any
+		static GuiGeometryCache* __recordingCache;
 
 		static Texture2D::Sptr __defaultUITexture;
 		static int __defaultEdgeRadius;
 
 		static void __StaticInit();
+		/// <summary>
+		/// Adds a single quad to the batch, without looking the texture up in the atlas
+		/// </summary>
+		static void __PushQuad(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, const glm::vec2& uvMin, const glm::vec2& uvMax);
+		/// <summary>
+		/// Finds the texture and UV range to draw a texture with, packing it into the atlas if possible
+		/// </summary>
+		static void __ResolveAtlas(const Texture2D::Sptr& tex, Texture2D::Sptr& drawTex, glm::vec2& uvMin, glm::vec2& uvMax);
+		/// <summary>
+		/// Gets the draw command that new geometry with the given texture should be added to
+		/// </summary>
+		static DrawCommand& __GetDrawCommand(const Texture2D::Sptr& tex, GuiShader shader);
+		/// <summary>
+		/// Checks if an axis aligned rect in batch space overlaps the current clip region
+		/// </summary>
+		static bool __IsInsideClip(const glm::vec2& min, const glm::vec2& max);
+		/// <summary>
+		/// Gets the bounds of a rect in model space after it has been transformed into batch space
+		/// </summary>
+		static ClipRect __TransformRect(const glm::vec2& min, const glm::vec2& max);
+		/// <summary>
+		/// Adds the glyphs from a laid out string to the batch
+		/// </summary>
+		static void __RenderLayout(const TextLayout& layout, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale);
+		/// <summary>
+		/// Adds geometry to the batch for the given texture, and to the cache being recorded if there is one
+		/// </summary>
+		/// <param name="indices">Indices relative to the first vertex</param>
+		static void __AddGeometry(const Texture2D::Sptr& tex, GuiShader shader, const VertexPosColTex* verts, uint32_t vertCount, const uint32_t* indices, uint32_t indexCount);
 	};
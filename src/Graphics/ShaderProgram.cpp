@@ -3,10 +3,38 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
 
+// From GL_KHR_parallel_shader_compile, defined here in case our loader was generated without the extension
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+	// Whether the driver can compile and link on it's own threads, and tell us when it's done
+	bool SupportsParallelCompile() {
+		static int supported = -1;
+		if (supported == -1) {
+			supported = 0;
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (GLint ix = 0; ix < count; ix++) {
+				const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, ix));
+				if (name != nullptr && (strcmp(name, "GL_KHR_parallel_shader_compile") == 0 || strcmp(name, "GL_ARB_parallel_shader_compile") == 0)) {
+					supported = 1;
+					break;
+				}
+			}
+			LOG_INFO("Parallel shader compilation is {}", supported ? "supported" : "not supported");
+		}
+		return supported == 1;
+	}
+}
+
 ShaderProgram::ShaderProgram() : 
 	IGraphicsResource(),
 	IResource()
@@ -26,6 +54,12 @@ ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::strin
 }
 
 ShaderProgram::~ShaderProgram() {
+	// Parts are normally deleted when we link, but a failed reload can leave some behind
+	for (auto& [type, id] : _handles) {
+		if (id != 0) {
+			glDeleteShader(id);
+		}
+	}
 	if (_rendererId != 0) {
 		glDeleteProgram(_rendererId);
 		_rendererId = 0;
@@ -41,6 +75,40 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 	glCompileShader(handle);
 
 	// Get the compilation status for the shader part
+	if (!__CheckShaderPart(handle)) {
+		// Delete the broken shader result
+		glDeleteShader(handle);
+		return false;
+	}
+
+	// If we're overwriting, warn and clean up the old program before we store
+	if (_handles[type] != 0) {
+		LOG_WARN("Another shader has been attached to this slot, overwriting");
+		glDeleteShader(_handles[type]);
+	}
+	_handles[type] = handle;
+
+	// Store info about where we got this data from
+	_fileSourceMap[type].IsFilePath = false;
+	_fileSourceMap[type].Source = source;
+	_fileSourceMap[type].Dependencies.clear();
+
+	return true;
+}
+
+void ShaderProgram::__SubmitShaderPart(const char* source, ShaderPartType type) {
+	// We don't ask for the compile status here, so the driver is free to keep compiling while we do other work
+	GLuint handle = glCreateShader((GLenum)type);
+	glShaderSource(handle, 1, &source, nullptr);
+	glCompileShader(handle);
+
+	if (_handles[type] != 0) {
+		glDeleteShader(_handles[type]);
+	}
+	_handles[type] = handle;
+}
+
+bool ShaderProgram::__CheckShaderPart(GLuint handle) {
 	GLint status = 0;
 	glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
 
@@ -60,25 +128,8 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 
 		// Clean up our log memory
 		delete[] log;
-
-		// Delete the broken shader result
-		glDeleteShader(handle);
-		handle = 0;
-
-		return false;
 	}
 
-	// If we're overwriting, warn and clean up the old program before we store
-	if (_handles[type] != 0) {
-		LOG_WARN("Another shader has been attached to this slot, overwriting");
-		glDeleteShader(_handles[type]);
-	}
-	_handles[type] = handle;
-
-	// Store info about where we got this data from
-	_fileSourceMap[type].IsFilePath = false;
-	_fileSourceMap[type].Source = source;
-
 	return status != GL_FALSE;
 }
 
@@ -87,13 +138,19 @@ bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type
 	if (std::filesystem::exists(path)) {
 		// Load the source from the file, using our helper that will
 		// resolve #include directives
-		std::string source = FileHelpers::ReadResolveIncludes(path);
+		std::vector<std::string> sourceFiles;
+		std::string source = FileHelpers::ReadResolveIncludes(path, &sourceFiles);
 		// Pass off to LoadShaderPart
 		bool result =  LoadShaderPart(source.c_str(), type);
 		_fileSourceMap[type].IsFilePath = true;
 		_fileSourceMap[type].Source = path;
+		_fileSourceMap[type].Dependencies = sourceFiles;
 		if (result == false) {
+			// Errors are reported as source(line), where source is the index into the included files
 			LOG_ERROR("Source File: {}", path);
+			for (size_t ix = 0; ix < sourceFiles.size(); ix++) {
+				LOG_ERROR("\t{}: {}", ix, sourceFiles[ix]);
+			}
 		}
 		return result; 
 	} else {
@@ -103,6 +160,11 @@ bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type
 }
 
 bool ShaderProgram::Link() {
+	_StartLink();
+	return _FinishLink();
+}
+
+void ShaderProgram::_StartLink() {
 
 	LOG_TRACE("Starting shader link:");
 	
@@ -116,6 +178,29 @@ bool ShaderProgram::Link() {
 
 	// Perform linking
 	glLinkProgram(_rendererId);
+}
+
+bool ShaderProgram::_IsLinkComplete() const {
+	// Without the extension, we have no way to ask, so the status queries in _FinishLink will wait for the driver
+	if (!SupportsParallelCompile()) {
+		return true;
+	}
+	GLint complete = GL_FALSE;
+	glGetProgramiv(_rendererId, GL_COMPLETION_STATUS_KHR, &complete);
+	return complete != GL_FALSE;
+}
+
+bool ShaderProgram::_FinishLink() {
+	// Parts that were submitted without being checked report their errors here
+	for (auto& [type, id] : _handles) {
+		if (id != 0 && !__CheckShaderPart(id)) {
+			const ShaderSource& source = _fileSourceMap[type];
+			LOG_ERROR("Source File: {}", source.IsFilePath ? source.Source : "<from source>");
+			for (size_t ix = 0; ix < source.Dependencies.size(); ix++) {
+				LOG_ERROR("\t{}: {}", ix, source.Dependencies[ix]);
+			}
+		}
+	}
 
 	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
 	for (auto& [type, id] : _handles) { 
@@ -166,6 +251,215 @@ void ShaderProgram::Unbind() {
 	glUseProgram(0);
 }
 
+void ShaderProgram::AddKeyword(const std::string& keyword) {
+	LOG_ASSERT(_keywords.size() < 32, "Shaders can have at most 32 keywords!");
+	if (std::find(_keywords.begin(), _keywords.end(), keyword) == _keywords.end()) {
+		_keywords.push_back(keyword);
+	}
+}
+
+uint32_t ShaderProgram::GetKeywordBit(const std::string& keyword) const {
+	auto it = std::find(_keywords.begin(), _keywords.end(), keyword);
+	return it != _keywords.end() ? (1u << (it - _keywords.begin())) : 0;
+}
+
+ShaderProgram::Sptr ShaderProgram::GetVariant(uint32_t keywordMask) {
+	// A mask of 0 is the program itself
+	if (keywordMask == 0) {
+		return nullptr;
+	}
+
+	// If we've already compiled the variant, we can use the cached result
+	auto it = _variants.find(keywordMask);
+	if (it != _variants.end()) {
+		return it->second;
+	}
+
+	ShaderProgram::Sptr result = std::make_shared<ShaderProgram>();
+
+	// Build a human readable name from the enabled keywords
+	std::string name = _debugName + " [";
+	for (size_t ix = 0; ix < _keywords.size(); ix++) {
+		if (keywordMask & (1u << ix)) {
+			name += " " + _keywords[ix];
+		}
+	}
+	result->SetDebugName(name + " ]");
+	LOG_INFO("Compiling shader variant \"{}\"", result->GetDebugName());
+
+	_CompileVariant(keywordMask, *result);
+	__MergeVariantUniforms(*result);
+
+	_variants[keywordMask] = result;
+	return result;
+}
+
+std::vector<std::string> ShaderProgram::GetSourceFiles() const {
+	std::vector<std::string> result;
+	for (auto& [type, source] : _fileSourceMap) {
+		for (auto& file : source.Dependencies) {
+			if (std::find(result.begin(), result.end(), file) == result.end()) {
+				result.push_back(file);
+			}
+		}
+	}
+	return result;
+}
+
+bool ShaderProgram::Reload() {
+	LOG_INFO("Reloading shader \"{}\"", _debugName);
+
+	// Anything still compiling from a previous reload was built from out of date sources, so we throw it away
+	_pendingReloads.clear();
+
+	// We compile into new programs, so that if the new source is broken we can keep using the old ones. Everything is
+	// submitted before we wait on any of it, so the driver can compile the program and it's variants at the same time
+	PendingReload reload;
+	reload.Target = this;
+	reload.Staging = std::make_unique<ShaderProgram>();
+	if (!_StartVariant(0, *reload.Staging)) {
+		LOG_WARN("Failed to reload shader \"{}\", keeping previous version", _debugName);
+		return false;
+	}
+	_pendingReloads.push_back(std::move(reload));
+
+	// Variants share our sources, so they'll need to be recompiled as well
+	bool result = true;
+	for (auto& [mask, variant] : _variants) {
+		PendingReload variantReload;
+		variantReload.Target = variant.get();
+		variantReload.Staging = std::make_unique<ShaderProgram>();
+		if (_StartVariant(mask, *variantReload.Staging)) {
+			_pendingReloads.push_back(std::move(variantReload));
+		} else {
+			LOG_WARN("Failed to reload shader variant \"{}\", keeping previous version", variant->GetDebugName());
+			result = false;
+		}
+	}
+	return result;
+}
+
+void ShaderProgram::PollReload() {
+	for (auto it = _pendingReloads.begin(); it != _pendingReloads.end(); ) {
+		// Keep rendering with the current program until the driver has finished with the new one
+		if (!it->Staging->_IsLinkComplete()) {
+			it++;
+			continue;
+		}
+
+		ShaderProgram& target = *it->Target;
+		if (it->Staging->_FinishLink()) {
+			target._AdoptProgram(*it->Staging);
+			__MergeVariantUniforms(target);
+
+			// If we lose track of our includes, editing one of them won't trigger the next reload
+			for (auto& [type, source] : target._fileSourceMap) {
+				LOG_ASSERT(!source.IsFilePath || !source.Dependencies.empty(), "Shader \"{}\" lost it's source files while reloading", target._debugName);
+			}
+		} else {
+			LOG_WARN("Failed to reload shader \"{}\", keeping previous version", target._debugName);
+		}
+		it = _pendingReloads.erase(it);
+	}
+}
+
+bool ShaderProgram::_CompileVariant(uint32_t keywordMask, ShaderProgram& target) const {
+	return _StartVariant(keywordMask, target) && target._FinishLink();
+}
+
+bool ShaderProgram::_StartVariant(uint32_t keywordMask, ShaderProgram& target) const {
+	// Re-compile all our shader parts with the defines injected
+	for (auto& [type, source] : _fileSourceMap) {
+		std::string variantSource;
+		std::vector<std::string> dependencies;
+		if (source.IsFilePath) {
+			if (!std::filesystem::exists(source.Source)) {
+				LOG_WARN("Could not open file at \"{}\"", source.Source);
+				return false;
+			}
+			variantSource = FileHelpers::ReadResolveIncludes(source.Source, &dependencies);
+		} else {
+			variantSource = source.Source;
+		}
+		if (keywordMask != 0) {
+			__InjectKeywordDefines(variantSource, keywordMask);
+		}
+
+		// Compile errors are reported when the link is finished
+		target.__SubmitShaderPart(variantSource.c_str(), type);
+
+		ShaderSource& targetSource = target._fileSourceMap[type];
+		targetSource.Source = source.Source;
+		targetSource.IsFilePath = source.IsFilePath;
+		targetSource.Dependencies = std::move(dependencies);
+	}
+
+	// Transform feedback varyings need to be registered before linking
+	if (!_varyings.empty()) {
+		std::vector<const char*> names;
+		for (auto& name : _varyings) {
+			names.push_back(name.c_str());
+		}
+		target.RegisterVaryings(names.data(), static_cast<int>(names.size()), _interleavedVaryings);
+	}
+
+	target._StartLink();
+	return true;
+}
+
+void ShaderProgram::_AdoptProgram(ShaderProgram& other) {
+	// Swap programs so the other shader will clean up our old one
+	std::swap(_rendererId, other._rendererId);
+	_fileSourceMap = other._fileSourceMap;
+	_uniforms = other._uniforms;
+	_uniformTable = other._uniformTable;
+
+	// Restore any uniform block bindings that were changed at runtime
+	std::unordered_map<std::string, UniformBlockInfo> oldBlocks = std::move(_uniformBlocks);
+	_uniformBlocks = other._uniformBlocks;
+	for (auto& [name, block] : oldBlocks) {
+		if (block.CurrentBinding != block.DefaultBinding) {
+			BindUniformBlockToSlot(name, block.CurrentBinding);
+		}
+	}
+
+	_revision++;
+}
+
+void ShaderProgram::__MergeVariantUniforms(const ShaderProgram& variant) {
+	// Merge the variant's uniforms so that materials can find uniforms that only exist in variants
+	for (auto& [key, uniform] : variant._uniforms) {
+		auto it = _variantUniforms.find(key);
+		if (it == _variantUniforms.end() || it->second.Type != uniform.Type) {
+			_variantUniforms[key] = uniform;
+		}
+	}
+}
+
+void ShaderProgram::__InjectKeywordDefines(std::string& source, uint32_t keywordMask) const {
+	std::string defines;
+	for (size_t ix = 0; ix < _keywords.size(); ix++) {
+		if (keywordMask & (1u << ix)) {
+			defines += "#define " + _keywords[ix] + "\n";
+		}
+	}
+
+	// The #version directive must come first, so we insert on the line after it
+	size_t seek = source.find("#version");
+	if (seek != std::string::npos) {
+		seek = source.find('\n', seek);
+		seek = seek == std::string::npos ? source.size() : seek + 1;
+	} else {
+		seek = 0;
+	}
+
+	// Reset the line number so that errors still match the original file
+	int line = static_cast<int>(std::count(source.begin(), source.begin() + seek, '\n')) + 1;
+	defines += "#line " + std::to_string(line) + " 0\n";
+
+	source.insert(seek, defines);
+}
+
 void ShaderProgram::SetUniformMatrix(int location, const glm::mat3* value, int count, bool transposed) {
 	glProgramUniformMatrix3fv(_rendererId, location, count, transposed, glm::value_ptr(*value));
 }
@@ -306,16 +600,50 @@ void ShaderProgram::SetUniform(int location, ShaderDataType type, void* data, in
 	}
 }
 
-int ShaderProgram::__GetUniformLocation(const std::string& name) {
-	// Since the default constructor for UniformInfo sets location to -1,
-	// we can simply index the map and if it doesn't exist, the default
-	// will be used
-	return _uniforms[name].Location;
+int ShaderProgram::__GetUniformLocation(const HashedString& name) const {
+	if (_uniformTable.empty()) {
+		return -1;
+	}
+
+	// Linear probe from the hash's home slot, the table is never full so we'll always hit an empty slot
+	const size_t mask = _uniformTable.size() - 1;
+	for (size_t ix = name.Hash & mask; ; ix = (ix + 1) & mask) {
+		const UniformSlot& slot = _uniformTable[ix];
+		if (slot.Name.empty()) {
+			return -1;
+		}
+		if (slot.Hash == name.Hash && slot.Name == name.Name) {
+			return slot.Location;
+		}
+	}
+}
+
+void ShaderProgram::_BuildUniformTable() {
+	size_t size = 8;
+	while (size < _uniforms.size() * 2) {
+		size *= 2;
+	}
+	_uniformTable.assign(size, UniformSlot());
+
+	const size_t mask = size - 1;
+	for (auto& [name, uniform] : _uniforms) {
+		HashedString hashed = HashedString(name);
+		size_t ix = hashed.Hash & mask;
+		while (!_uniformTable[ix].Name.empty()) {
+			ix = (ix + 1) & mask;
+		}
+		_uniformTable[ix].Hash = hashed.Hash;
+		_uniformTable[ix].Location = uniform.Location;
+		_uniformTable[ix].Name = name;
+	}
 }
 
 nlohmann::json ShaderProgram::ToJson() const {
 	nlohmann::json result;
 	result["name"] = _debugName;
+	if (!_keywords.empty()) {
+		result["keywords"] = _keywords;
+	}
 	for (auto& [key, value] : _fileSourceMap) {
 		result[~key][value.IsFilePath ? "path" : "source"] = value.Source;
 	}
@@ -326,6 +654,11 @@ nlohmann::json ShaderProgram::ToJson() const {
 ShaderProgram::Sptr ShaderProgram::FromJson(const nlohmann::json& data) {
 	ShaderProgram::Sptr result = std::make_shared<ShaderProgram>();
 	result->SetDebugName(JsonGet(data, "name", result->_debugName));
+	if (data.contains("keywords") && data["keywords"].is_array()) {
+		for (auto& keyword : data["keywords"]) {
+			result->AddKeyword(keyword.get<std::string>());
+		}
+	}
 	for (auto& [key, blob] : data.items()) {
 		// Get the shader part type from the key
 		ShaderPartType type = ParseShaderPartType(key, ShaderPartType::Unknown);
@@ -349,6 +682,7 @@ ShaderProgram::Sptr ShaderProgram::FromJson(const nlohmann::json& data) {
 void ShaderProgram::_Introspect() {
 	_IntrospectUniforms();
 	_IntrospectUnifromBlocks();
+	_BuildUniformTable();
 }
 
 void ShaderProgram::_IntrospectUniforms() {
@@ -402,6 +736,7 @@ void ShaderProgram::_IntrospectUniforms() {
 
 		// Store the uniform info
 		_uniforms[e.Name] = e;
+		_variantUniforms[e.Name] = e;
 	}
 }
 
@@ -502,13 +837,23 @@ void ShaderProgram::BindUniformBlockToSlot(const std::string& name, int uboSlot)
 }
 
 bool ShaderProgram::FindUniform(const std::string& name, UniformInfo* out) {
-	for (auto& [key, uniform] : _uniforms) {
-		if (uniform.Name == name) {
-			if (out != nullptr) {
-				*out = uniform;
-			}
-			return true;
+	auto it = _uniforms.find(name);
+	if (it != _uniforms.end()) {
+		if (out != nullptr) {
+			*out = it->second;
+		}
+		return true;
+	}
+	return false;
+}
+
+bool ShaderProgram::FindVariantUniform(const std::string& name, UniformInfo* out) {
+	auto it = _variantUniforms.find(name);
+	if (it != _variantUniforms.end()) {
+		if (out != nullptr) {
+			*out = it->second;
 		}
+		return true;
 	}
 	return false;
 }
@@ -519,5 +864,8 @@ GlResourceType ShaderProgram::GetResourceClass() const {
 
 void ShaderProgram::RegisterVaryings(const char* const* names, int numVaryings, bool interleaved /*= true*/)
 {
+	// Store the varyings so we can re-register them if the program is reloaded
+	_varyings.assign(names, names + numVaryings);
+	_interleavedVaryings = interleaved;
 	glTransformFeedbackVaryings(_rendererId, numVaryings, names, interleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
 }
@@ -3,12 +3,14 @@
 #include <memory>
 #include <string>               // for std::string
 #include <unordered_map>        // for std::unordered_map
+#include <vector>               // for std::vector
 #include <GLM/glm.hpp>          // for our GLM types
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include <Logging.h>            // for the logging functions
 #include <EnumToString.h>
 
 #include "Utils/ResourceManager/IResource.h"
+#include "Utils/HashedString.h"
 #include "Graphics/GlEnums.h"
 #include "Graphics/IGraphicsResource.h"
 
@@ -107,7 +109,66 @@ public:
 	/// </summary>
 	static void Unbind();
 
+	/// <summary>
+	/// Registers a keyword that can be used to compile variants of this shader. Each variant is
+	/// compiled from the same source with a #define for every enabled keyword, allowing shaders
+	/// to use #ifdef blocks instead of branching on uniforms at runtime
+	/// </summary>
+	/// <param name="keyword">The name of the keyword, as it will appear in the #define</param>
+	void AddKeyword(const std::string& keyword);
+	/// <summary>
+	/// Gets the keywords that have been registered with this shader, in bit order
+	/// </summary>
+	const std::vector<std::string>& GetKeywords() const { return _keywords; }
+	/// <summary>
+	/// Gets the bit in a keyword mask that corresponds to the given keyword
+	/// </summary>
+	/// <param name="keyword">The name of the keyword to look up</param>
+	/// <returns>The mask bit for the keyword, or 0 if the keyword is not registered</returns>
+	uint32_t GetKeywordBit(const std::string& keyword) const;
+	/// <summary>
+	/// Gets the variant of this shader compiled with the keywords in the given mask enabled. Variants
+	/// are compiled the first time they are requested, and cached for future lookups. Note that a mask
+	/// of 0 refers to this program, and will return nullptr
+	/// </summary>
+	/// <param name="keywordMask">The mask of keywords to enable, see GetKeywordBit</param>
+	/// <returns>The shader program for the variant</returns>
+	ShaderProgram::Sptr GetVariant(uint32_t keywordMask);
+
+	/// <summary>
+	/// Gets the paths of all files that this shader was loaded from, including any files
+	/// that were pulled in via #include directives
+	/// </summary>
+	std::vector<std::string> GetSourceFiles() const;
+	/// <summary>
+	/// Starts recompiling this shader and all of it's variants from their source files. Programs are
+	/// compiled in the background where the driver supports it, call PollReload to swap them in as they
+	/// finish. The new program replaces the current one only if it compiles and links successfully, so
+	/// a broken edit will leave the current program in use
+	/// </summary>
+	/// <returns>True if the shader and all variants started compiling, false if otherwise</returns>
+	bool Reload();
+	/// <summary>
+	/// Replaces this shader and it's variants with any programs from Reload that have finished linking,
+	/// the current programs stay in use until then
+	/// </summary>
+	void PollReload();
+	/// <summary>
+	/// Gets whether there are programs from Reload that are still compiling
+	/// </summary>
+	bool IsReloading() const { return !_pendingReloads.empty(); }
+	/// <summary>
+	/// Gets the revision of this program, which is incremented whenever the program is reloaded and
+	/// uniform locations may have changed
+	/// </summary>
+	uint32_t GetRevision() const { return _revision; }
+
 	const std::unordered_map<std::string, UniformInfo>& GetUniforms() const { return _uniforms; }
+	/// <summary>
+	/// Gets all the uniforms that have been found in this shader and any of it's compiled variants,
+	/// note that the locations in this map are only valid for the program they were found in!
+	/// </summary>
+	const std::unordered_map<std::string, UniformInfo>& GetVariantUniforms() const { return _variantUniforms; }
 
 	// Inherited from IGraphicsResource
 
@@ -120,6 +181,14 @@ public:
 
 public:
 	bool FindUniform(const std::string& name, UniformInfo* out);
+	/// <summary>
+	/// Searches for a uniform in this shader and all of it's compiled variants, useful for finding
+	/// the type of uniforms that only exist when certain keywords are enabled
+	/// </summary>
+	/// <param name="name">The name of the uniform to search for</param>
+	/// <param name="out">The uniform info to populate</param>
+	/// <returns>True if the uniform was found, false if otherwise</returns>
+	bool FindVariantUniform(const std::string& name, UniformInfo* out);
 
 	void SetUniformMatrix(int location, const glm::mat3* value, int count = 1, bool transposed = false);
 	void SetUniformMatrix(int location, const glm::mat4* value, int count = 1, bool transposed = false);
@@ -147,30 +216,30 @@ public:
 	void SetUniform(int location, ShaderDataType type, void* data, int count = 1, bool transposed = false);
 
 	template <typename T>
-	void SetUniform(const std::string& name, const T& value) {
+	void SetUniform(const HashedString& name, const T& value) {
 		int location = __GetUniformLocation(name);
 		if (location != -1) {
 			SetUniform(location, &value, 1);
 		} else {
-			LOG_WARN("Ignoring uniform \"{}\"", name);
+			LOG_WARN("Ignoring uniform \"{}\"", name.Name);
 		}
 	}
 	template <typename T>
-	void SetUniform(const std::string& name, const T* values, int count = 1) {
+	void SetUniform(const HashedString& name, const T* values, int count = 1) {
 		int location = __GetUniformLocation(name);
 		if (location != -1) {
-			SetUniform(location, &values, count);
+			SetUniform(location, values, count);
 		} else {
-			LOG_WARN("Ignoring uniform \"{}\"", name);
+			LOG_WARN("Ignoring uniform \"{}\"", name.Name);
 		}
 	}
 	template <typename T>
-	void SetUniformMatrix(const std::string& name, const T& value, bool transposed = false) {
+	void SetUniformMatrix(const HashedString& name, const T& value, bool transposed = false) {
 		int location = __GetUniformLocation(name);
 		if (location != -1) {
 			SetUniformMatrix(location, &value, 1, transposed);
 		} else {
-			LOG_WARN("Ignoring uniform \"{}\"", name);
+			LOG_WARN("Ignoring uniform \"{}\"", name.Name);
 		}
 	}
 	
@@ -183,6 +252,16 @@ protected:
 	
 	// Map access to look up uniform locations and blocks
 	std::unordered_map<std::string, UniformInfo> _uniforms;
+
+	// An entry in our open addressed table of uniform locations, empty slots have no name
+	struct UniformSlot {
+		uint32_t    Hash = 0;
+		int         Location = -1;
+		std::string Name;
+	};
+	// Uniform locations indexed by name hash, so we can look up locations without allocating
+	// The size is always a power of 2, and at least double the number of uniforms
+	std::vector<UniformSlot> _uniformTable;
 	std::unordered_map<std::string, UniformBlockInfo> _uniformBlocks;
 
 	// Stores information about the source of our shader parts
@@ -191,9 +270,69 @@ protected:
 	struct ShaderSource {
 		std::string Source;
 		bool        IsFilePath;
+		// All files that were read to produce the source, including includes
+		std::vector<std::string> Dependencies;
 	};
 	std::unordered_map<ShaderPartType, ShaderSource> _fileSourceMap;
 
+	// The keywords that can be enabled for variants, the index is the bit in the keyword mask
+	std::vector<std::string> _keywords;
+	// Compiled variants of this shader, keyed by their keyword mask
+	std::unordered_map<uint32_t, ShaderProgram::Sptr> _variants;
+	// All uniforms from this program and it's variants, only type info is shared between programs
+	std::unordered_map<std::string, UniformInfo> _variantUniforms;
+
+	// Transform feedback varyings, stored so they can be re-registered when reloading
+	std::vector<std::string> _varyings;
+	bool                     _interleavedVaryings = true;
+
+	// Incremented every time the program is replaced by a reload
+	uint32_t _revision = 0;
+
+	// A program that is being compiled by Reload, which will replace Target's program when it's done
+	struct PendingReload {
+		ShaderProgram*      Target;
+		ShaderProgram::Uptr Staging;
+	};
+	std::vector<PendingReload> _pendingReloads;
+
+	/// <summary>
+	/// Compiles and links our sources into the target program, with the given keywords defined
+	/// </summary>
+	/// <param name="keywordMask">The mask of keywords to enable</param>
+	/// <param name="target">The empty program to compile into</param>
+	/// <returns>True if all parts compiled and the program linked</returns>
+	bool _CompileVariant(uint32_t keywordMask, ShaderProgram& target) const;
+	/// <summary>
+	/// Submits our sources to the driver to be compiled and linked into the target program, with the
+	/// given keywords defined, without waiting for them. Use _FinishLink to get the result
+	/// </summary>
+	/// <param name="keywordMask">The mask of keywords to enable</param>
+	/// <param name="target">The empty program to compile into</param>
+	/// <returns>True if all the sources could be read and submitted</returns>
+	bool _StartVariant(uint32_t keywordMask, ShaderProgram& target) const;
+	/// <summary>
+	/// Takes ownership of the other program's OpenGL program and introspection data, the
+	/// other program will receive our old program and delete it on destruction
+	/// </summary>
+	/// <param name="other">The program to take the OpenGL program from</param>
+	void _AdoptProgram(ShaderProgram& other);
+
+	/// <summary>
+	/// Attaches our shader parts and starts linking them, without waiting for the result
+	/// </summary>
+	void _StartLink();
+	/// <summary>
+	/// Checks if the driver has finished compiling and linking the program, always true if the driver
+	/// can't compile in the background
+	/// </summary>
+	bool _IsLinkComplete() const;
+	/// <summary>
+	/// Waits for the link started by _StartLink, reports any errors and introspects the program
+	/// </summary>
+	/// <returns>True if all parts compiled and the program linked</returns>
+	bool _FinishLink();
+
 	/// <summary>
 	/// Performs program introspection, where we examine the uniforms that
 	/// the program contains
@@ -208,6 +347,31 @@ protected:
 	/// fed data from a uniform buffer
 	/// </summary>
 	void _IntrospectUnifromBlocks();
+	/// <summary>
+	/// Rebuilds the table of uniform locations from our uniforms
+	/// </summary>
+	void _BuildUniformTable();
+
+	int __GetUniformLocation(const HashedString& name) const;
+
+	/// <summary>
+	/// Starts compiling a shader part without checking the result, replacing any existing part of that type
+	/// </summary>
+	void __SubmitShaderPart(const char* source, ShaderPartType type);
+	/// <summary>
+	/// Checks the compile status of a shader part, and logs the errors if it failed
+	/// </summary>
+	/// <returns>True if the part compiled</returns>
+	static bool __CheckShaderPart(GLuint handle);
 
-	int __GetUniformLocation(const std::string& name);
+	/// <summary>
+	/// Injects a #define for every keyword in the mask directly after the #version directive
+	/// </summary>
+	/// <param name="source">The shader source to modify</param>
+	/// <param name="keywordMask">The mask of keywords to define</param>
+	void __InjectKeywordDefines(std::string& source, uint32_t keywordMask) const;
+	/// <summary>
+	/// Merges the uniforms from a variant into our set of variant uniforms
+	/// </summary>
+	void __MergeVariantUniforms(const ShaderProgram& variant);
 };
\ No newline at end of file
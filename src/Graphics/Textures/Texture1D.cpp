@@ -1,7 +1,10 @@
 #include "Texture1D.h"
 #include "Utils/Base64.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Utils/StringUtils.h"
+#include "Utils/CookedTexture.h"
 #include <stb_image.h>
+#include <filesystem>
 
 inline int CalcRequiredMipLevels(int size) {
 	return (1 + floor(log2(size)));
@@ -123,7 +126,13 @@ void Texture1D::_LoadDataFromFile()
 {
 	LOG_ASSERT(_description.Size == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
-	if (!_description.Filename.empty()) {
+	// Cooked textures are already decoded, so we can upload them straight out of the file
+	std::string extension = std::filesystem::path(_description.Filename).extension().string();
+	StringTools::ToLower(extension);
+	if (extension == CookedTexture::EXTENSION) {
+		_LoadCookedFile();
+	}
+	else if (!_description.Filename.empty()) {
 		// Variables that will store properties about our image
 		int width, height, numChannels;
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
@@ -172,6 +181,23 @@ void Texture1D::_LoadDataFromFile()
 	SetDebugName(_description.Filename);
 }
 
+void Texture1D::_LoadCookedFile()
+{
+	CookedTexture cooked(_description.Filename);
+	if (!cooked.IsValid() || cooked.GetDepth() != 1) {
+		LOG_WARN("Failed to load cooked texture from \"{}\"", _description.Filename);
+		return;
+	}
+
+	// 1D textures are loaded from images, so we treat all the rows as one long line like _LoadDataFromFile
+	uint32_t size = cooked.GetWidth() * cooked.GetHeight();
+	_description.Format = GetInternalFormatForChannels8(cooked.GetChannels());
+	_description.Size = size;
+
+	_SetTextureParams();
+	LoadData(size, GetPixelFormatForChannels(cooked.GetChannels()), PixelType::UByte, const_cast<uint8_t*>(cooked.GetData()));
+}
+
 void Texture1D::_SetTextureParams()
 {
 	// Calculate how many layers of storage to allocate based on whether mipmaps are enabled or not
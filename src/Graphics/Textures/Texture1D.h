@@ -123,6 +123,10 @@ protected:
 	/// </summary>
 	void _LoadDataFromFile();
 	/// <summary>
+	/// Loads a texture that was written by the asset cooker
+	/// </summary>
+	void _LoadCookedFile();
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
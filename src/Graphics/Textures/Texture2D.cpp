@@ -4,6 +4,9 @@
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/Base64.h"
+#include "Utils/StringUtils.h"
+#include "Utils/CookedTexture.h"
+#include <filesystem>
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -135,7 +138,7 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 	// Align the data store to the size of a single component to ensure we don't get weirdness with images that aren't RGBA
 	// See https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glPixelStore.xhtml
 	int componentSize = (GLint)GetTexelComponentSize(type);
-	glPixelStorei(GL_PACK_ALIGNMENT, componentSize);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, componentSize);
 
 	// Upload our data to our image
 	glTextureSubImage2D(_rendererId, 0, offsetX, offsetY, width, height, (GLenum)format, (GLenum)type, data);
@@ -149,7 +152,13 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 void Texture2D::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
-	if (!_description.Filename.empty()) {
+	// Cooked textures are already decoded, so we can upload them straight out of the file
+	std::string extension = std::filesystem::path(_description.Filename).extension().string();
+	StringTools::ToLower(extension);
+	if (extension == CookedTexture::EXTENSION) {
+		_LoadCookedFile();
+	}
+	else if (!_description.Filename.empty()) {
 		// Variables that will store properties about our image
 		int width, height, numChannels;
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
@@ -199,6 +208,23 @@ void Texture2D::_LoadDataFromFile() {
 	SetDebugName(_description.Filename);
 }
 
+void Texture2D::_LoadCookedFile() {
+	CookedTexture cooked(_description.Filename);
+	if (!cooked.IsValid() || cooked.GetDepth() != 1) {
+		LOG_WARN("Failed to load cooked texture from \"{}\"", _description.Filename);
+		return;
+	}
+
+	// Update our description to match what we loaded
+	_description.Format = GetInternalFormatForChannels8(cooked.GetChannels());
+	_description.Width  = cooked.GetWidth();
+	_description.Height = cooked.GetHeight();
+
+	// Allocate our memory and upload the texels
+	_SetTextureParams();
+	LoadData(cooked.GetWidth(), cooked.GetHeight(), GetPixelFormatForChannels(cooked.GetChannels()), PixelType::UByte, const_cast<uint8_t*>(cooked.GetData()));
+}
+
 void Texture2D::_SetTextureParams() {
 	// If we have a multisampled texture, and the current type is 2D, change it to 2D multisampled
 	if (_description.MultisampleCount > 1 && _type == TextureType::_2D) {
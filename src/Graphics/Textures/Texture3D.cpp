@@ -2,6 +2,7 @@
 #include "Utils/Base64.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/CookedTexture.h"
 #include <Logging.h>
 #include <stb_image.h>
 #include <iostream>
@@ -144,19 +145,67 @@ void Texture3D::_LoadDataFromFile()
 		if (extension.compare(".cube") == 0) {
 			_LoadCubeFile();
 		}
+		// Cooked textures are already decoded, so we can upload them straight out of the file
+		else if (extension.compare(CookedTexture::EXTENSION) == 0) {
+			_LoadCookedFile();
+		}
 	}
 }
 
 void Texture3D::_LoadCubeFile()
 {
-	std::ifstream inFile(_description.Filename);
+	std::vector<glm::u8vec3> textureData;
+	uint32_t lutSize = 0;
+	std::string title;
+	if (!ParseCubeFile(_description.Filename, textureData, lutSize, title)) {
+		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
+		return;
+	}
+	if (!title.empty()) {
+		SetDebugName(title);
+	}
 
-	if (!inFile.is_open()) {
-		LOG_WARN("Failed to open file .cube file: {}", _description.Filename);
+	// Update the description's size and set the pixel format
+	_description.Width = _description.Height = _description.Depth = lutSize;
+	_description.Format = InternalFormat::RGB8;
+	// We need to clamp to edge for LUTS
+	_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
+
+	// Allocate data and configure params
+	_SetTextureParams();
+	// Load data
+	LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, PixelType::UByte, textureData.data());
+}
+
+void Texture3D::_LoadCookedFile()
+{
+	CookedTexture cooked(_description.Filename);
+	if (!cooked.IsValid()) {
+		LOG_WARN("Failed to load cooked texture: \"{}\"", _description.Filename);
 		return;
 	}
 
-	glm::u8vec3* textureData = nullptr;
+	// Cooked 3D textures come from LUTs, so they get the same settings as .cube files
+	_description.Width  = cooked.GetWidth();
+	_description.Height = cooked.GetHeight();
+	_description.Depth  = cooked.GetDepth();
+	_description.Format = GetInternalFormatForChannels8(cooked.GetChannels());
+	_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
+
+	_SetTextureParams();
+	LoadData(cooked.GetWidth(), cooked.GetHeight(), cooked.GetDepth(), GetPixelFormatForChannels(cooked.GetChannels()), PixelType::UByte, const_cast<uint8_t*>(cooked.GetData()));
+}
+
+bool Texture3D::ParseCubeFile(const std::string& filename, std::vector<glm::u8vec3>& data, uint32_t& size, std::string& title)
+{
+	std::ifstream inFile(filename);
+
+	if (!inFile.is_open()) {
+		LOG_WARN("Failed to open file .cube file: {}", filename);
+		return false;
+	}
+
+	data.clear();
 	uint32_t lutSize{ 0 };
 	uint32_t ix{ 0 };
 	glm::vec3 rgb { 0, 0, 0 };
@@ -185,18 +234,10 @@ void Texture3D::_LoadCubeFile()
 			std::stringstream lReader(line.substr(12));
 			lReader >> lutSize;
 
-			// Update the description's size
-			_description.Width = _description.Height = _description.Depth = lutSize;
-
 			// If the size we read is non-zero, allocate our data!
 			if (lutSize > 0) {
-				// If we had data already, delete it
-				if (textureData != nullptr) {
-					delete[] textureData;
-				} 
-
-				// Allocate data to store texels in
-				textureData = new glm::u8vec3[(size_t)lutSize * lutSize * lutSize];
+				// Allocate data to store texels in, replacing any data we had already
+				data.assign((size_t)lutSize * lutSize * lutSize, glm::u8vec3(0));
 				ix = 0;
 			}
 		}
@@ -211,7 +252,7 @@ void Texture3D::_LoadCubeFile()
 			StringTools::Trim(name);
 
 			// We'll store this in the debug name
-			SetDebugName(name);
+			title = name;
 		}
 
 		else if (line.find("DOMAIN_MIN") != std::string::npos)
@@ -224,11 +265,12 @@ void Texture3D::_LoadCubeFile()
 		{ /* ignore for now */ }
 
 		// Reading data lines
-		else if (!line.empty() && textureData != nullptr) {
+		else if (!line.empty() && !data.empty()) {
 
 			// Make sure we don't case a write access violation
-			if (ix >= (lutSize * lutSize * lutSize) && lutSize > 0) {
+			if (ix >= data.size()) {
 				LOG_ASSERT(false, "Attempting to write outside the bounds of the LUT");
+				break;
 			}
 
 			// Read RGB from the line
@@ -238,32 +280,17 @@ void Texture3D::_LoadCubeFile()
 			rgb = glm::clamp(rgb, glm::vec3(0), glm::vec3(1));
 
 			// Store in the array, converting to the correct scale for bytes
-			textureData[ix].r = static_cast<uint8_t>(rgb.r * 255);
-			textureData[ix].g = static_cast<uint8_t>(rgb.g * 255);
-			textureData[ix].b = static_cast<uint8_t>(rgb.b * 255);
+			data[ix].r = static_cast<uint8_t>(rgb.r * 255);
+			data[ix].g = static_cast<uint8_t>(rgb.g * 255);
+			data[ix].b = static_cast<uint8_t>(rgb.b * 255);
 
 			// Move to the next texel
 			ix++;
 		}
-	} 
-
-	if (textureData != nullptr) {
-		// Set the pixel format
-		_description.Format = InternalFormat::RGB8;
-		// We need to clamp to edge for LUTS
-		_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
-
-		// Allocate data and configure params
-		_SetTextureParams();
-		// Load data
-		LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, PixelType::UByte, textureData);
-
-		// Clean up after ourselves
-		delete[] textureData;
-	}
-	else {
-		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
 	}
+
+	size = lutSize;
+	return !data.empty();
 }
 
 void Texture3D::_SetTextureParams()
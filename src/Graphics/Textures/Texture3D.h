@@ -160,10 +160,25 @@ protected:
 	/// </summary>
 	void _LoadCubeFile();
 	/// <summary>
+	/// Loads a texture that was written by the asset cooker
+	/// </summary>
+	void _LoadCookedFile();
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
 
 public:
+	/// <summary>
+	/// Parses the texels out of a .cube LUT file without creating a texture, so it can be used
+	/// without an OpenGL context (ex: by the asset cooker)
+	/// </summary>
+	/// <param name="filename">The path to the .cube file</param>
+	/// <param name="data">Receives the RGB texels</param>
+	/// <param name="size">Receives the size of the LUT along each axis</param>
+	/// <param name="title">Receives the LUT's title, if it has one</param>
+	/// <returns>False if the file could not be read or has no texels</returns>
+	static bool ParseCubeFile(const std::string& filename, std::vector<glm::u8vec3>& data, uint32_t& size, std::string& title);
+
 	static Texture3D::Sptr LoadFromFile(const std::string& path, const Texture3DDescription& description = Texture3DDescription(), bool forceRgba = true);
 };
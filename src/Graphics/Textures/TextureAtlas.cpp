@@ -0,0 +1,198 @@
+#include "TextureAtlas.h"
+#include "Logging.h"
+#include <algorithm>
+
+TextureAtlas::TextureAtlas(uint32_t pageSize, uint32_t maxTextureSize) :
+	_pageSize(pageSize),
+	_maxTextureSize(maxTextureSize),
+	_pages(),
+	_entries(),
+	_rejected()
+{
+	LOG_ASSERT(maxTextureSize + PADDING * 2 <= pageSize, "Atlas pages must be able to fit the largest texture!");
+}
+
+TextureAtlas::~TextureAtlas() = default;
+
+bool TextureAtlas::GetRegion(const Texture2D::Sptr& texture, Region& region)
+{
+	if (texture == nullptr) {
+		return false;
+	}
+
+	// Most lookups will hit textures we've already packed
+	auto it = _entries.find(texture.get());
+	if (it != _entries.end()) {
+		if (it->second.Source.lock() == texture) {
+			region = it->second.Location;
+			return true;
+		}
+		// The texture we packed has been freed and something else has it's address, the old space is just lost
+		_entries.erase(it);
+	}
+	auto rejected = _rejected.find(texture.get());
+	if (rejected != _rejected.end()) {
+		if (rejected->second.lock() == texture) {
+			return false;
+		}
+		_rejected.erase(rejected);
+	}
+
+	// We copy on the GPU, which requires matching formats, and we don't bother with textures that would eat up a page
+	uint32_t width = texture->GetWidth();
+	uint32_t height = texture->GetHeight();
+	if (texture->GetFormat() != InternalFormat::RGBA8 || texture->GetDescription().MultisampleCount != 1 ||
+		width == 0 || height == 0 || width > _maxTextureSize || height > _maxTextureSize) {
+		_rejected[texture.get()] = texture;
+		return false;
+	}
+
+	// Textures are only packed with others that use the same filtering, so pixel art UI stays crisp. Pages
+	// don't have mip maps, so we drop the mip part of the minification filter
+	MagFilter magFilter = texture->GetMagFilter();
+	MinFilter minFilter = magFilter == MagFilter::Nearest ? MinFilter::Nearest : MinFilter::Linear;
+
+	uint32_t paddedWidth = width + PADDING * 2;
+	uint32_t paddedHeight = height + PADDING * 2;
+
+	// Place the texture in the first page where it fits, or start a new page
+	Page* target = nullptr;
+	int nodeIndex = -1;
+	uint32_t y = 0;
+	for (Page& page : _pages) {
+		if (page.Texture->GetMagFilter() == magFilter) {
+			nodeIndex = _FindPosition(page, paddedWidth, paddedHeight, y);
+			if (nodeIndex >= 0) {
+				target = &page;
+				break;
+			}
+		}
+	}
+	if (target == nullptr) {
+		target = &_CreatePage(minFilter, magFilter);
+		nodeIndex = _FindPosition(*target, paddedWidth, paddedHeight, y);
+	}
+
+	uint32_t x = target->Skyline[nodeIndex].X;
+	_AddToSkyline(*target, nodeIndex, x, y, paddedWidth, paddedHeight);
+	_CopyIntoPage(texture, *target, x + PADDING, y + PADDING);
+
+	Entry& entry = _entries[texture.get()];
+	entry.Source = texture;
+	entry.Location.Page = target->Texture;
+	entry.Location.UvMin = glm::vec2(x + PADDING, y + PADDING) / (float)_pageSize;
+	entry.Location.UvMax = glm::vec2(x + PADDING + width, y + PADDING + height) / (float)_pageSize;
+
+	region = entry.Location;
+	return true;
+}
+
+int TextureAtlas::_FindPosition(const Page& page, uint32_t width, uint32_t height, uint32_t& outY) const
+{
+	// Bottom-left heuristic, we want the position that leaves the lowest top edge, and the narrowest node on ties
+	int bestIndex = -1;
+	uint32_t bestTop = UINT32_MAX;
+	uint32_t bestWidth = UINT32_MAX;
+
+	for (size_t ix = 0; ix < page.Skyline.size(); ix++) {
+		uint32_t x = page.Skyline[ix].X;
+		if (x + width > _pageSize) {
+			break;
+		}
+
+		// The rectangle rests on the highest node that it spans
+		uint32_t y = 0;
+		uint32_t spanned = 0;
+		for (size_t jx = ix; jx < page.Skyline.size() && spanned < width; jx++) {
+			y = std::max(y, page.Skyline[jx].Y);
+			spanned += page.Skyline[jx].Width;
+		}
+
+		uint32_t top = y + height;
+		if (top <= _pageSize && (top < bestTop || (top == bestTop && page.Skyline[ix].Width < bestWidth))) {
+			bestIndex = static_cast<int>(ix);
+			bestTop = top;
+			bestWidth = page.Skyline[ix].Width;
+			outY = y;
+		}
+	}
+
+	return bestIndex;
+}
+
+void TextureAtlas::_AddToSkyline(Page& page, int nodeIndex, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+	page.Skyline.insert(page.Skyline.begin() + nodeIndex, { x, y + height, width });
+
+	// Shrink or remove the nodes that are now underneath the new one
+	for (size_t ix = nodeIndex + 1; ix < page.Skyline.size();) {
+		SkylineNode& prev = page.Skyline[ix - 1];
+		SkylineNode& node = page.Skyline[ix];
+		uint32_t prevEnd = prev.X + prev.Width;
+		if (node.X >= prevEnd) {
+			break;
+		}
+
+		uint32_t shrink = prevEnd - node.X;
+		if (node.Width <= shrink) {
+			page.Skyline.erase(page.Skyline.begin() + ix);
+		} else {
+			node.X += shrink;
+			node.Width -= shrink;
+			break;
+		}
+	}
+
+	// Merge neighbours at the same height so the skyline stays short
+	for (size_t ix = 0; ix + 1 < page.Skyline.size();) {
+		if (page.Skyline[ix].Y == page.Skyline[ix + 1].Y) {
+			page.Skyline[ix].Width += page.Skyline[ix + 1].Width;
+			page.Skyline.erase(page.Skyline.begin() + ix + 1);
+		} else {
+			ix++;
+		}
+	}
+}
+
+TextureAtlas::Page& TextureAtlas::_CreatePage(MinFilter minFilter, MagFilter magFilter)
+{
+	Texture2DDescription desc = Texture2DDescription();
+	desc.Width = _pageSize;
+	desc.Height = _pageSize;
+	desc.Format = InternalFormat::RGBA8;
+	desc.HorizontalWrap = WrapMode::ClampToEdge;
+	desc.VerticalWrap = WrapMode::ClampToEdge;
+	desc.MinificationFilter = minFilter;
+	desc.MagnificationFilter = magFilter;
+	desc.GenerateMipMaps = false;
+
+	Page& page = _pages.emplace_back();
+	page.Texture = std::make_shared<Texture2D>(desc);
+	page.Skyline.push_back({ 0, 0, _pageSize });
+
+	// Start with a cleared page, so any gaps between textures are transparent
+	glClearTexImage(page.Texture->GetHandle(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	LOG_INFO("Allocated GUI atlas page {} ({}x{})", _pages.size(), _pageSize, _pageSize);
+	return page;
+}
+
+void TextureAtlas::_CopyIntoPage(const Texture2D::Sptr& texture, const Page& page, uint32_t x, uint32_t y)
+{
+	GLuint src = texture->GetHandle();
+	GLuint dst = page.Texture->GetHandle();
+	GLint width = texture->GetWidth();
+	GLint height = texture->GetHeight();
+
+	glCopyImageSubData(src, GL_TEXTURE_2D, 0, 0, 0, 0, dst, GL_TEXTURE_2D, 0, x, y, 0, width, height, 1);
+
+	// Extrude the edges into the padding, so that bilinear filtering at the edge of the region samples the texture's
+	// own edge rather than whatever is beside it in the page
+	for (GLint pad = 1; pad <= (GLint)PADDING; pad++) {
+		// Left and right columns, then bottom and top rows
+		glCopyImageSubData(src, GL_TEXTURE_2D, 0, 0,         0, 0, dst, GL_TEXTURE_2D, 0, x - pad,             y, 0, 1, height, 1);
+		glCopyImageSubData(src, GL_TEXTURE_2D, 0, width - 1, 0, 0, dst, GL_TEXTURE_2D, 0, x + width + pad - 1, y, 0, 1, height, 1);
+		glCopyImageSubData(src, GL_TEXTURE_2D, 0, 0, 0,          0, dst, GL_TEXTURE_2D, 0, x, y - pad,              0, width, 1, 1);
+		glCopyImageSubData(src, GL_TEXTURE_2D, 0, 0, height - 1, 0, dst, GL_TEXTURE_2D, 0, x, y + height + pad - 1, 0, width, 1, 1);
+	}
+}
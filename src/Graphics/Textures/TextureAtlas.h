@@ -0,0 +1,98 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include "Utils/Macros.h"
+#include "Graphics/Textures/Texture2D.h"
+
+/// <summary>
+/// Packs small textures into shared atlas pages at runtime, so that geometry using different
+/// textures can be drawn in a single call. Textures are copied into the pages on the GPU with
+/// a skyline packer, and are never moved once they have been packed
+///
+/// Note that the atlas holds a copy of each texture, so changes made to a texture after it has
+/// been packed will not show up in the atlas
+/// </summary>
+class TextureAtlas {
+public:
+	MAKE_PTRS(TextureAtlas);
+	NO_COPY(TextureAtlas);
+	NO_MOVE(TextureAtlas);
+
+	/// <summary>
+	/// The location of a texture within the atlas
+	/// </summary>
+	struct Region {
+		Texture2D::Sptr Page;
+		glm::vec2       UvMin;
+		glm::vec2       UvMax;
+	};
+
+	/// <summary>
+	/// Creates a new empty atlas, pages are only allocated when a texture is packed
+	/// </summary>
+	/// <param name="pageSize">The width and height of each page in pixels</param>
+	/// <param name="maxTextureSize">The largest texture (in either dimension) that will be packed, larger textures are left alone</param>
+	TextureAtlas(uint32_t pageSize = 2048, uint32_t maxTextureSize = 512);
+	~TextureAtlas();
+
+	/// <summary>
+	/// Gets where a texture lives in the atlas, packing it into a page if it hasn't been already
+	/// </summary>
+	/// <param name="texture">The texture to look up</param>
+	/// <param name="region">Will be set to the texture's region if the texture is in the atlas</param>
+	/// <returns>True if the texture is in the atlas, false if it can't be packed (ex: too big, or not RGBA8)</returns>
+	bool GetRegion(const Texture2D::Sptr& texture, Region& region);
+
+	/// <summary>
+	/// Gets the number of pages that have been allocated
+	/// </summary>
+	size_t GetPageCount() const { return _pages.size(); }
+
+protected:
+	// Textures are surrounded by a border of their own edge pixels, so filtering doesn't bleed between neighbours
+	static constexpr uint32_t PADDING = 1;
+
+	// A span of the skyline, everything below Y is in use from X to X + Width
+	struct SkylineNode {
+		uint32_t X;
+		uint32_t Y;
+		uint32_t Width;
+	};
+
+	struct Page {
+		Texture2D::Sptr          Texture;
+		std::vector<SkylineNode> Skyline;
+	};
+
+	struct Entry {
+		// Lets us detect when a texture has been freed and it's address re-used
+		std::weak_ptr<Texture2D> Source;
+		Region                   Location;
+	};
+
+	uint32_t _pageSize;
+	uint32_t _maxTextureSize;
+	std::vector<Page> _pages;
+	std::unordered_map<Texture2D*, Entry> _entries;
+	// Textures that can't be packed, so we don't re-check them every time
+	std::unordered_map<Texture2D*, std::weak_ptr<Texture2D>> _rejected;
+
+	/// <summary>
+	/// Finds the lowest spot in the page's skyline that fits the given size
+	/// </summary>
+	/// <returns>The index of the skyline node to place at, or -1 if the size does not fit</returns>
+	int _FindPosition(const Page& page, uint32_t width, uint32_t height, uint32_t& outY) const;
+	/// <summary>
+	/// Raises the skyline to account for a newly placed rectangle
+	/// </summary>
+	void _AddToSkyline(Page& page, int nodeIndex, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+	/// <summary>
+	/// Allocates a new page with the given filtering
+	/// </summary>
+	Page& _CreatePage(MinFilter minFilter, MagFilter magFilter);
+	/// <summary>
+	/// Copies a texture into a page, and extrudes it's edges into the padding around it
+	/// </summary>
+	void _CopyIntoPage(const Texture2D::Sptr& texture, const Page& page, uint32_t x, uint32_t y);
+};
@@ -8,6 +8,9 @@ VertexArrayObject::VertexArrayObject() :
 	_handle(0),
 	_vertexCount(0),
 	_elementCount(0),
+	_hasBounds(false),
+	_boundsMin(glm::vec3(0.0f)),
+	_boundsMax(glm::vec3(0.0f)),
 	_vertexBuffers(std::vector<VertexBufferBinding*>())
 {
 	glCreateVertexArrays(1, &_handle);
@@ -113,6 +116,18 @@ void VertexArrayObject::Draw(DrawMode mode) {
 	Unbind();
 }
 
+void VertexArrayObject::DrawRange(uint32_t firstElement, uint32_t elementCount, DrawMode mode)
+{
+	Bind();
+	if (_indexBuffer == nullptr) {
+		glDrawArrays((GLenum)mode, firstElement, elementCount);
+	} else {
+		const GLvoid* offset = (const GLvoid*)((size_t)firstElement * _indexBuffer->GetElementSize());
+		glDrawElements((GLenum)mode, elementCount, (GLenum)_indexBuffer->GetElementType(), offset);
+	}
+	Unbind();
+}
+
 void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
 {
 	Bind();
@@ -144,6 +159,12 @@ const VertexArrayObject::VertexDeclaration& VertexArrayObject::GetVDecl() {
 	return _vDecl;
 }
 
+void VertexArrayObject::SetBounds(const glm::vec3& min, const glm::vec3& max) {
+	_hasBounds = true;
+	_boundsMin = min;
+	_boundsMax = max;
+}
+
 GlResourceType VertexArrayObject::GetResourceClass() const {
 	return GlResourceType::VertexArray;
 }
@@ -177,6 +198,9 @@ VertexArrayObject::Sptr VertexArrayObject::Clone() const
 	}
 
 	result->SetVDecl(_vDecl);
+	if (_hasBounds) {
+		result->SetBounds(_boundsMin, _boundsMax);
+	}
 
 	return result;
 }
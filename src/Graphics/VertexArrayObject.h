@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <EnumToString.h>
+#include <GLM/glm.hpp>
 
 #include "Graphics/Buffers/VertexBuffer.h"
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -125,6 +126,14 @@ public:
 	/// </summary>
 	/// <param name="mode">The draw mode for primitives in this VAO</param>
 	void Draw(DrawMode mode = DrawMode::TriangleList);
+	/// <summary>
+	/// Renders a range of this VAO's elements (indices if there is an index buffer, otherwise vertices),
+	/// using the specified draw mode
+	/// </summary>
+	/// <param name="firstElement">The index of the first element to draw</param>
+	/// <param name="elementCount">The number of elements to draw</param>
+	/// <param name="mode">The draw mode for primitives in this VAO</param>
+	void DrawRange(uint32_t firstElement, uint32_t elementCount, DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Renders this VAO with the given instance count, using the specified draw mode. 
@@ -151,6 +160,19 @@ public:
 	void SetVDecl(const VertexDeclaration& vDecl);
 	const VertexDeclaration& GetVDecl();
 
+	/// <summary>
+	/// Sets the axis aligned bounding box of the mesh's vertex positions, for meshes where it is known
+	/// </summary>
+	/// <param name="min">The minimum corner of the bounds</param>
+	/// <param name="max">The maximum corner of the bounds</param>
+	void SetBounds(const glm::vec3& min, const glm::vec3& max);
+	/// <summary>
+	/// Returns true if the bounds of this mesh have been set
+	/// </summary>
+	bool HasBounds() const { return _hasBounds; }
+	const glm::vec3& GetBoundsMin() const { return _boundsMin; }
+	const glm::vec3& GetBoundsMax() const { return _boundsMax; }
+
 protected:
 	
 	// The index buffer bound to this VAO
@@ -165,6 +187,10 @@ protected:
 	uint32_t _vertexCount;
 	uint32_t _elementCount;
 
+	bool      _hasBounds;
+	glm::vec3 _boundsMin;
+	glm::vec3 _boundsMax;
+
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
 
@@ -1,4 +1,5 @@
 #include "VertexTypes.h"
+#include <GLM/gtc/packing.hpp>
 #pragma warning( push )
 
 VertexPosCol* VPC = nullptr;
@@ -7,6 +8,7 @@ VertexPosNormCol* VPNC = nullptr;
 VertexPosNormTex* VPNT = nullptr;
 VertexPosNormTexCol* VPNTC = nullptr;
 VertexPosNormTexColTangents* VPNTCT = nullptr;
+VertexPosNormTexColTangentsPacked* VPNTCTP = nullptr;
 
 const std::vector<BufferAttribute> VertexPosCol::V_DECL = {
 	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosCol), (size_t)&VPC->Position, AttribUsage::Position),
@@ -41,4 +43,24 @@ const std::vector<BufferAttribute> VertexPosNormTexColTangents::V_DECL ={
 	BufferAttribute(4, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->Tangent, AttribUsage::Tangent),
 	BufferAttribute(5, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->BiTangent, AttribUsage::BiTangent)
 };
+const std::vector<BufferAttribute> VertexPosNormTexColTangentsPacked::V_DECL ={
+	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Position, AttribUsage::Position),
+	BufferAttribute(1, 4, AttributeType::UByte, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Color, AttribUsage::Color, true),
+	BufferAttribute(2, 4, AttributeType::Int2_10_10_10, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Normal, AttribUsage::Normal, true),
+	BufferAttribute(3, 2, AttributeType::Float, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->UV, AttribUsage::Texture),
+	BufferAttribute(4, 4, AttributeType::Int2_10_10_10, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Tangent, AttribUsage::Tangent, true)
+};
+
+VertexPosNormTexColTangentsPacked VertexPosNormTexColTangentsPacked::Pack(const VertexPosNormTexColTangents& vertex) {
+	// Work out which way the bitangent points relative to the normal and tangent, so the shader can rebuild it
+	float handedness = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.BiTangent) < 0.0f ? -1.0f : 1.0f;
+
+	VertexPosNormTexColTangentsPacked result;
+	result.Position = vertex.Position;
+	result.Normal   = glm::packSnorm3x10_1x2(glm::vec4(vertex.Normal, 0.0f));
+	result.UV       = vertex.UV;
+	result.Color    = glm::packUnorm4x8(vertex.Color);
+	result.Tangent  = glm::packSnorm3x10_1x2(glm::vec4(vertex.Tangent, handedness));
+	return result;
+}
 #pragma warning(pop)
\ No newline at end of file
@@ -116,4 +116,33 @@ struct VertexPosNormTexColTangents {
 	{}
 
 	static const std::vector<BufferAttribute> V_DECL;
-};
\ No newline at end of file
+};
+
+/// <summary>
+/// A compact version of VertexPosNormTexColTangents for uploading to the GPU, about half the size. Normals and
+/// tangents are stored as normalized 10:10:10:2 integers, and colors as normalized bytes. The bitangent is not
+/// stored, instead the tangent's w component holds it's handedness, so shaders can derive it with
+/// cross(normal, tangent.xyz) * tangent.w
+/// </summary>
+struct VertexPosNormTexColTangentsPacked {
+	glm::vec3 Position;
+	uint32_t  Normal;
+	glm::vec2 UV;
+	uint32_t  Color;
+	uint32_t  Tangent;
+
+	VertexPosNormTexColTangentsPacked() :
+		Position(glm::vec3(0.0f)),
+		Normal(0),
+		UV(glm::vec2(0.0f)),
+		Color(0xFF000000),
+		Tangent(0)
+	{}
+
+	/// <summary>
+	/// Packs a full vertex, normals and tangents should already be normalized
+	/// </summary>
+	static VertexPosNormTexColTangentsPacked Pack(const VertexPosNormTexColTangents& vertex);
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
@@ -0,0 +1,224 @@
+#include "Utils/AssetCooker.h"
+
+#include <vector>
+#include <map>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <execution>
+#include <chrono>
+#include <json.hpp>
+#include <stb_image.h>
+
+#include "Utils/FileHelpers.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/StringUtils.h"
+#include "Utils/CookedTexture.h"
+#include "Utils/OptimizedObjLoader.h"
+#include "Graphics/Textures/Texture1D.h"
+#include "Graphics/Textures/Texture2D.h"
+#include "Graphics/Textures/Texture3D.h"
+#include "Gameplay/MeshResource.h"
+#include "Logging.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+	/// <summary>
+	/// A single asset to convert, along with the manifest entries to update once it's converted
+	/// </summary>
+	struct CookJob {
+		std::string Source;
+		std::string Output;
+		std::vector<nlohmann::ordered_json*> Entries;
+		std::function<bool(const CookJob&)> Cook;
+		bool Succeeded = false;
+	};
+
+	std::string GetExtension(const std::string& filename) {
+		std::string extension = fs::path(filename).extension().string();
+		StringTools::ToLower(extension);
+		return extension;
+	}
+
+	/// <summary>
+	/// Returns true if output is missing or older than source
+	/// </summary>
+	bool IsOutOfDate(const std::string& source, const std::string& output) {
+		std::error_code err;
+		if (!fs::exists(output, err)) {
+			return true;
+		}
+		return fs::last_write_time(output, err) < fs::last_write_time(source, err) || err;
+	}
+
+	bool CookMesh(const CookJob& job) {
+		if (OptimizedObjLoader::IsBinaryOutOfDate(job.Source, job.Output)) {
+			OptimizedObjLoader::ConvertToBinary(job.Source, job.Output);
+		}
+		return !OptimizedObjLoader::IsBinaryOutOfDate(job.Source, job.Output);
+	}
+
+	bool CookImage(const CookJob& job, int targetChannels) {
+		if (!IsOutOfDate(job.Source, job.Output)) {
+			return true;
+		}
+
+		// Load the same way the textures do at runtime, so the cooked data is identical to what we would have uploaded
+		int width, height, numChannels;
+		uint8_t* data = stbi_load(job.Source.c_str(), &width, &height, &numChannels, targetChannels);
+		if (data == nullptr) {
+			LOG_WARN("STBI Failed to load image from \"{}\"", job.Source);
+			return false;
+		}
+		if (targetChannels != 0) {
+			numChannels = targetChannels;
+		}
+
+		bool result = CookedTexture::Write(job.Output, width, height, 1, numChannels, data);
+		stbi_image_free(data);
+		return result;
+	}
+
+	bool CookLut(const CookJob& job) {
+		if (!IsOutOfDate(job.Source, job.Output)) {
+			return true;
+		}
+
+		std::vector<glm::u8vec3> data;
+		uint32_t size = 0;
+		std::string title;
+		if (!Texture3D::ParseCubeFile(job.Source, data, size, title)) {
+			return false;
+		}
+		return CookedTexture::Write(job.Output, size, size, size, 3, data.data());
+	}
+
+	/// <summary>
+	/// Gets the filename from a manifest entry, or an empty string if it does not have one
+	/// </summary>
+	std::string GetFilename(const nlohmann::ordered_json& entry) {
+		if (entry.contains("filename") && entry["filename"].is_string()) {
+			return entry["filename"].get<std::string>();
+		}
+		return "";
+	}
+
+	std::string GetTypeName(const std::type_info& type) {
+		return StringTools::SanitizeClassName(type.name());
+	}
+}
+
+int AssetCooker::CookManifest(const std::string& manifestPath, const std::string& outputPath) {
+	if (!fs::exists(manifestPath)) {
+		LOG_ERROR("Manifest \"{}\" does not exist", manifestPath);
+		return 1;
+	}
+
+	nlohmann::ordered_json manifest;
+	try {
+		manifest = nlohmann::ordered_json::parse(FileHelpers::ReadFile(manifestPath));
+	} catch (std::exception& e) {
+		LOG_ERROR("Failed to parse manifest \"{}\": {}", manifestPath, e.what());
+		return 1;
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	// Collect all the assets we know how to cook. Anything else (cubemaps, fonts, shaders) is left alone
+	std::vector<CookJob> jobs;
+	// Maps output files to their job, so assets that are referenced more than once only get cooked once
+	std::map<std::string, size_t> jobLookup;
+	for (auto& [typeName, items] : manifest.items()) {
+		if (!items.is_object()) {
+			continue;
+		}
+
+		for (auto& [guid, entry] : items.items()) {
+			std::string filename = GetFilename(entry);
+			if (filename.empty() || filename == "null" || !fs::exists(filename)) {
+				continue;
+			}
+			std::string extension = GetExtension(filename);
+			std::string cookedName = fs::path(filename).replace_extension(CookedTexture::EXTENSION).string();
+
+			CookJob job;
+			job.Source = filename;
+
+			if (typeName == GetTypeName(typeid(Gameplay::MeshResource)) && extension == ".obj") {
+				job.Output = fs::path(filename).replace_extension(".bin").string();
+				job.Cook   = CookMesh;
+			}
+			else if (typeName == GetTypeName(typeid(Texture2D)) && extension != CookedTexture::EXTENSION) {
+				// 2D textures don't read a format from JSON, so they always load with the default format hint (RGBA)
+				int targetChannels = GetTexelComponentCount(Texture2DDescription().FormatHint);
+				job.Output = cookedName;
+				job.Cook   = [targetChannels](const CookJob& image) { return CookImage(image, targetChannels); };
+			}
+			else if (typeName == GetTypeName(typeid(Texture1D)) && extension != CookedTexture::EXTENSION) {
+				// 1D textures can request a channel count with their format hint
+				int targetChannels = GetTexelComponentCount(JsonParseEnum(PixelFormat, entry, "format", PixelFormat::Unknown));
+				job.Output = cookedName;
+				job.Cook   = [targetChannels](const CookJob& image) { return CookImage(image, targetChannels); };
+			}
+			else if (typeName == GetTypeName(typeid(Texture3D)) && extension == ".cube") {
+				job.Output = cookedName;
+				job.Cook   = CookLut;
+			}
+			else {
+				continue;
+			}
+
+			auto it = jobLookup.find(job.Output);
+			if (it == jobLookup.end()) {
+				jobLookup[job.Output] = jobs.size();
+				jobs.push_back(job);
+				jobs.back().Entries.push_back(&entry);
+			} else {
+				jobs[it->second].Entries.push_back(&entry);
+			}
+		}
+	}
+
+	LOG_INFO("Cooking {} assets from \"{}\"", jobs.size(), manifestPath);
+
+	// stb's flip flag is global, so set it once up front rather than from every job
+	stbi_set_flip_vertically_on_load(true);
+
+	std::for_each(std::execution::par, jobs.begin(), jobs.end(), [](CookJob& job) {
+		try {
+			job.Succeeded = job.Cook(job);
+		} catch (std::exception& e) {
+			LOG_ERROR("Exception while cooking \"{}\": {}", job.Source, e.what());
+			job.Succeeded = false;
+		}
+	});
+
+	// Point the manifest at the cooked files, failed assets keep their source files so they can still be loaded
+	int failures = 0;
+	for (CookJob& job : jobs) {
+		if (job.Succeeded) {
+			for (nlohmann::ordered_json* entry : job.Entries) {
+				(*entry)["filename"] = job.Output;
+			}
+		} else {
+			LOG_WARN("Failed to cook \"{}\"", job.Source);
+			failures++;
+		}
+	}
+
+	std::string cookedPath = outputPath.empty() ? GetCookedManifestPath(manifestPath) : outputPath;
+	FileHelpers::WriteContentsToFile(cookedPath, manifest.dump(1, '\t'));
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	float seconds = std::chrono::duration<float>(endTime - startTime).count();
+	LOG_INFO("Cooked {} of {} assets in {} seconds, wrote \"{}\"", jobs.size() - failures, jobs.size(), seconds, cookedPath);
+
+	return failures;
+}
+
+std::string AssetCooker::GetCookedManifestPath(const std::string& manifestPath) {
+	fs::path path = manifestPath;
+	path.replace_extension(".cooked.json");
+	return path.string();
+}
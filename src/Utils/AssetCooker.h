@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+
+/// <summary>
+/// Converts all the source assets referenced by a resource manifest into the formats we can
+/// load fastest at runtime, and writes out a cooked manifest that points at the converted files
+///
+/// OBJ meshes are converted to binary meshes with OptimizedObjLoader, and 1D, 2D and 3D textures
+/// (including .cube LUTs) are decoded into cooked textures. Assets are converted in parallel,
+/// and assets that are already up to date are skipped. The cooker never touches OpenGL, so it
+/// can be run without a window or GL context
+/// </summary>
+class AssetCooker {
+public:
+	/// <summary>
+	/// Cooks all the assets in a manifest. Paths in the manifest are resolved relative to the
+	/// working directory, the same as when the manifest is loaded at runtime
+	/// </summary>
+	/// <param name="manifestPath">The path to the source manifest</param>
+	/// <param name="outputPath">The path to write the cooked manifest to, or empty to use GetCookedManifestPath</param>
+	/// <returns>The number of assets that failed to cook</returns>
+	static int CookManifest(const std::string& manifestPath, const std::string& outputPath = "");
+
+	/// <summary>
+	/// Gets the default path for the cooked version of a manifest, ex: scene-manifest.json becomes scene-manifest.cooked.json
+	/// </summary>
+	/// <param name="manifestPath">The path to the source manifest</param>
+	static std::string GetCookedManifestPath(const std::string& manifestPath);
+
+protected:
+	AssetCooker() = default;
+	~AssetCooker() = default;
+};
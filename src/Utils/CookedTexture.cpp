@@ -0,0 +1,63 @@
+#include "Utils/CookedTexture.h"
+
+#include <fstream>
+#include <cstring>
+
+#include "Utils/HashedString.h"
+#include "Logging.h"
+
+CookedTexture::CookedTexture(const std::string& filename) :
+	_file(filename),
+	_header(),
+	_data(nullptr),
+	_isValid(false)
+{
+	if (!_file.IsOpen() || _file.GetSize() < sizeof(Header)) {
+		return;
+	}
+
+	const char headerBytes[4] = { 'C', 'T', 'E', 'X' };
+	memcpy(&_header, _file.GetData(), sizeof(Header));
+	if (memcmp(_header.HeaderBytes, headerBytes, sizeof(headerBytes)) != 0 || _header.Version != 0x01) {
+		LOG_WARN("\"{}\" is not a supported cooked texture", filename);
+		return;
+	}
+	if (_header.Channels < 1 || _header.Channels > 4 || _header.Width == 0 || _header.Height == 0 || _header.Depth == 0) {
+		LOG_WARN("Cooked texture \"{}\" has an invalid size or format", filename);
+		return;
+	}
+
+	size_t dataSize = (size_t)_header.Width * _header.Height * _header.Depth * _header.Channels;
+	if (_file.GetSize() - sizeof(Header) < dataSize) {
+		LOG_WARN("Not enough data in cooked texture \"{}\"", filename);
+		return;
+	}
+	_data = reinterpret_cast<const uint8_t*>(_file.GetData()) + sizeof(Header);
+	if (Fnv1a32(_data, dataSize) != _header.Checksum) {
+		LOG_WARN("Checksum mismatch in cooked texture \"{}\", the file may be corrupt", filename);
+		_data = nullptr;
+		return;
+	}
+
+	_isValid = true;
+}
+
+bool CookedTexture::Write(const std::string& filename, uint32_t width, uint32_t height, uint32_t depth, uint32_t channels, const void* data) {
+	std::ofstream file(filename, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	size_t dataSize = (size_t)width * height * depth * channels;
+
+	Header header;
+	header.Channels = static_cast<uint16_t>(channels);
+	header.Width    = width;
+	header.Height   = height;
+	header.Depth    = depth;
+	header.Checksum = Fnv1a32(data, dataSize);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	file.write(reinterpret_cast<const char*>(data), dataSize);
+	return file.good();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+#include "Utils/Macros.h"
+#include "Utils/MappedFile.h"
+
+/// <summary>
+/// Texel data that has already been decoded by the asset cooker, stored as unsigned bytes with
+/// 1 to 4 channels. Loading a cooked texture just maps the file, so textures can be uploaded
+/// without decoding PNGs or parsing LUT files at runtime
+/// </summary>
+class CookedTexture {
+public:
+	NO_COPY(CookedTexture);
+	NO_MOVE(CookedTexture);
+
+	// The file extension used for cooked textures
+	static constexpr const char* EXTENSION = ".ctex";
+
+	/// <summary>
+	/// Maps and validates a cooked texture file, check IsValid to see if it could be loaded
+	/// </summary>
+	/// <param name="filename">The path to the cooked texture</param>
+	CookedTexture(const std::string& filename);
+	~CookedTexture() = default;
+
+	/// <summary>
+	/// Returns true if the file was loaded and passed validation
+	/// </summary>
+	bool IsValid() const { return _isValid; }
+
+	uint32_t GetWidth() const { return _header.Width; }
+	uint32_t GetHeight() const { return _header.Height; }
+	uint32_t GetDepth() const { return _header.Depth; }
+	uint32_t GetChannels() const { return _header.Channels; }
+	/// <summary>
+	/// Gets the texels, rows are stored bottom to top like OpenGL expects
+	/// </summary>
+	const uint8_t* GetData() const { return _data; }
+
+	/// <summary>
+	/// Writes texel data out to a cooked texture file
+	/// </summary>
+	/// <param name="filename">The path to write to</param>
+	/// <param name="width">The width of the texture in texels</param>
+	/// <param name="height">The height of the texture in texels</param>
+	/// <param name="depth">The depth of the texture in texels, 1 for 1D and 2D textures</param>
+	/// <param name="channels">The number of channels per texel, from 1 to 4</param>
+	/// <param name="data">The texels, width * height * depth * channels bytes</param>
+	/// <returns>False if the file could not be written</returns>
+	static bool Write(const std::string& filename, uint32_t width, uint32_t height, uint32_t depth, uint32_t channels, const void* data);
+
+protected:
+	struct Header {
+		char     HeaderBytes[4] = { 'C', 'T', 'E', 'X' };
+		uint16_t Version  = 0x01;
+		uint16_t Channels = 0;
+		uint32_t Width    = 0;
+		uint32_t Height   = 0;
+		uint32_t Depth    = 0;
+		// FNV-1a hash of the texel data
+		uint32_t Checksum = 0;
+	};
+
+	MappedFile     _file;
+	Header         _header;
+	const uint8_t* _data;
+	bool           _isValid;
+};
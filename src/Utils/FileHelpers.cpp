@@ -1,6 +1,8 @@
 #include "Utils/FileHelpers.h"
 #include <fstream>
 #include <filesystem>
+#include <unordered_map>
+#include <algorithm>
 #include <Logging.h>
 
 #include "Utils/StringUtils.h"
@@ -31,71 +33,142 @@ std::string FileHelpers::ReadFile(const std::string& filename) {
 	return result;
 }
 
-std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::vector<std::string> resolvedPaths) {
-	// Read the entire file contents for processing
-	std::string result = ReadFile(filename);
-	// Determine where the file we just read resides on the filesystem
-	const std::filesystem::path folder = std::filesystem::path(filename).parent_path();
-
-	// The token we're looking for, and it's length
-	const char* includeToken = "#include";
-	const size_t includeTokenLen = const_strlen(includeToken);
-
-	// Look for the token in the file
-	size_t seek = result.find(includeToken, 0); 
-	// If we found it, there's work to do!
-	while (seek != std::string::npos) {
-		// Find the end of the line
-		size_t eol = result.find_first_of("\r\n", seek);
-		if (eol == std::string::npos) {
-			eol = result.size();
+namespace {
+	// Stores the location of a single #include directive within a cached file
+	struct IncludeDirective {
+		size_t      Begin; // Offset of the start of the directive
+		size_t      End;   // Offset of the end of the line containing the directive
+		int         Line;  // The 1-based line number of the directive
+		std::string Path;  // The lexically normal path of the file to include
+	};
+
+	// Stores the contents of a file, along with the includes that we've already parsed out of it
+	struct CachedSource {
+		std::filesystem::file_time_type ModifiedTime;
+		std::string                     Contents;
+		std::vector<IncludeDirective>   Includes;
+	};
+
+	std::unordered_map<std::string, CachedSource> sourceCache;
+
+	// Gets a cached file, re-reading and parsing it if it has been modified since we last read it
+	const CachedSource& GetCachedSource(const std::string& filename) {
+		std::error_code error;
+		std::filesystem::file_time_type modified = std::filesystem::last_write_time(filename, error);
+
+		auto it = sourceCache.find(filename);
+		if (it != sourceCache.end() && !error && it->second.ModifiedTime == modified) {
+			return it->second;
 		}
 
-		// Calculate the area from end of token to end of line, snip out as the path
-		size_t begin = seek + includeTokenLen + 1;
-		std::string path = result.substr(begin, eol - begin);
-
-		// Trim whitespace and any quotes 
-		StringTools::Trim(path);
-		StringTools::Trim(path, '"');
-
-		// Determine the file path
-		std::filesystem::path target;
-		// If it starts with '/', relative to application directory
-		if (path[0] == '/') {
-			target = path;
+		CachedSource& result = sourceCache[filename];
+		result.ModifiedTime = modified;
+		result.Contents = FileHelpers::ReadFile(filename);
+		result.Includes.clear();
+
+		// Determine where the file we just read resides on the filesystem
+		const std::filesystem::path folder = std::filesystem::path(filename).parent_path();
+
+		// The token we're looking for, and it's length
+		const char* includeToken = "#include";
+		const size_t includeTokenLen = const_strlen(includeToken);
+
+		// Walk the file line by line, looking for lines that start with the include token
+		const std::string& contents = result.Contents;
+		int line = 1;
+		size_t seek = 0;
+		while (seek < contents.size()) {
+			// Find the end of the line
+			size_t eol = contents.find_first_of("\r\n", seek);
+			if (eol == std::string::npos) {
+				eol = contents.size();
+			}
+
+			// Skip leading whitespace, and check for the token
+			size_t begin = contents.find_first_not_of(" \t", seek);
+			if (begin < eol && contents.compare(begin, includeTokenLen, includeToken) == 0) {
+				// Snip out the area from end of token to end of line as the path
+				std::string path = contents.substr(begin + includeTokenLen, eol - begin - includeTokenLen);
+
+				// Trim whitespace and any quotes 
+				StringTools::Trim(path);
+				StringTools::Trim(path, '"');
+
+				// Determine the file path
+				std::filesystem::path target;
+				// If it starts with '/', relative to application directory
+				if (!path.empty() && path[0] == '/') {
+					target = path;
+				}
+				// Otherwise relative to the current directory
+				else {
+					target = folder / path;
+				}
+
+				// Get a lexically normal path (ie with the ../ parts resolved)
+				result.Includes.push_back({ begin, eol, line, target.lexically_normal().string() });
+			}
+
+			// Move to the start of the next line
+			seek = contents.find('\n', eol);
+			seek = seek == std::string::npos ? contents.size() : seek + 1;
+			line++;
 		}
-		// Otherwise relative to the current directory
-		else {
-			target = folder / path;
-		}
-		// Get a lexically normal path (ie with the ../ parts resolved)
-		target = target.lexically_normal();
 
-		// If we haven't included the file yet, include it now
-		if (std::find(resolvedPaths.begin(), resolvedPaths.end(), target.string()) == resolvedPaths.end()) {
+		return result;
+	}
+
+	// Appends the contents of a file to output, recursively expanding includes that are not in sourceFiles
+	void ExpandIncludes(const std::string& filename, std::string& output, std::vector<std::string>& sourceFiles) {
+		const CachedSource& source = GetCachedSource(filename);
+		const std::string sourceIndex = std::to_string(sourceFiles.size());
+		sourceFiles.push_back(filename);
 
-			// Make sure file exists, then load and resolve it's includes
-			LOG_ASSERT(std::filesystem::exists(target), "File does not exist");
-			std::string replacement = FileHelpers::ReadResolveIncludes(target.string(), resolvedPaths);
+		// Copy the text between includes, and the expanded includes into the output
+		size_t cursor = 0;
+		for (const IncludeDirective& include : source.Includes) {
+			output.append(source.Contents, cursor, include.Begin - cursor);
+			cursor = include.End;
 
-			// Inject result into our string
-			result.replace(seek, eol - seek, replacement);
-			// Look for more includes!
-			seek = result.find(includeToken, seek + replacement.length());
+			// If the file is already included, we skip the line
+			if (std::find(sourceFiles.begin(), sourceFiles.end(), include.Path) != sourceFiles.end()) {
+				continue;
+			}
 
-			resolvedPaths.push_back(target.string());
-		}
-		// File already included, remove the line and continue seeking
-		else {
-			result.replace(seek, eol - seek, "");
-			seek = result.find(includeToken, eol);
+			// Make sure file exists, then load and resolve it's includes
+			if (!std::filesystem::exists(include.Path)) {
+				LOG_ERROR("Could not find \"{}\" included from \"{}\" line {}", include.Path, filename, include.Line);
+				LOG_ASSERT(false, "File does not exist");
+				continue;
+			}
+
+			output += "#line 1 " + std::to_string(sourceFiles.size()) + "\n";
+			ExpandIncludes(include.Path, output, sourceFiles);
+			// The rest of the include line (it's newline) follows this, so the next line is Line + 1
+			output += "\n#line " + std::to_string(include.Line + 1) + " " + sourceIndex;
 		}
+		output.append(source.Contents, cursor, std::string::npos);
 	}
+}
+
+std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::vector<std::string>* sourceFiles) {
+	const std::string path = std::filesystem::path(filename).lexically_normal().string();
+	std::vector<std::string> files;
+	std::string result;
+	result.reserve(GetCachedSource(path).Contents.size() * 4);
+
+	ExpandIncludes(path, result, files);
 
+	if (sourceFiles != nullptr) {
+		*sourceFiles = std::move(files);
+	}
 	return result;
 }
 
+void FileHelpers::ClearSourceCache() {
+	sourceCache.clear();
+}
+
 void FileHelpers::WriteContentsToFile(const std::string& filename, const std::string& contents, bool append /*= false*/) {
 	std::ofstream output(filename, std::ios::out | (append ? std::ios::app : 0));
 	output << contents;
@@ -16,11 +16,22 @@ public:
 	/// <summary>
 	/// Reads the entire contents of a file, and will also recursively include
 	/// any other files needed as indicated by a #include fileName on a line
+	/// 
+	/// Each file will only be included once, and #line directives are emitted around
+	/// included content so that compiler errors report the original line numbers. The
+	/// source string number in the #line directive is the file's index in sourceFiles
+	/// 
+	/// File contents are cached and only re-read from disk when the file is modified
 	/// </summary>
 	/// <param name="filename">The path of the file to load</param>
-	/// <param name="resolvedPaths">The list of paths that have already been included</param>
+	/// <param name="sourceFiles">If not null, will receive the paths of all files that were included, starting with filename</param>
 	/// <returns>The entire contents of the file, with includes resolved, stored in a string</returns>
-	static std::string ReadResolveIncludes(const std::string& filename, std::vector<std::string> resolvedPaths = std::vector<std::string>());
+	static std::string ReadResolveIncludes(const std::string& filename, std::vector<std::string>* sourceFiles = nullptr);
+
+	/// <summary>
+	/// Clears the cache of files used by ReadResolveIncludes
+	/// </summary>
+	static void ClearSourceCache();
 
 	/// <summary>
 	/// Helper for writing the contents of a string into a file
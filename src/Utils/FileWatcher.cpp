@@ -0,0 +1,70 @@
+#include "Utils/FileWatcher.h"
+#include <algorithm>
+
+FileWatcher::FileWatcher(int pollIntervalMs) :
+	_thread(),
+	_mutex(),
+	_wake(),
+	_running(true),
+	_pollIntervalMs(pollIntervalMs),
+	_files(),
+	_changes()
+{
+	_thread = std::thread(&FileWatcher::_Run, this);
+}
+
+FileWatcher::~FileWatcher() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_running = false;
+	}
+	_wake.notify_all();
+	_thread.join();
+}
+
+void FileWatcher::Watch(const std::string& path) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_files.find(path) == _files.end()) {
+		std::error_code error;
+		_files[path] = std::filesystem::last_write_time(path, error);
+	}
+}
+
+std::vector<std::string> FileWatcher::PollChanges() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::vector<std::string> result;
+	result.swap(_changes);
+	return result;
+}
+
+void FileWatcher::_Run() {
+	std::vector<std::pair<std::string, std::filesystem::file_time_type>> snapshot;
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (_running) {
+		// Copy the watch list so we can hit the filesystem without holding the lock
+		snapshot.assign(_files.begin(), _files.end());
+		lock.unlock();
+
+		for (auto& [path, time] : snapshot) {
+			std::error_code error;
+			std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+			// Files can briefly disappear while editors save, we'll catch them next time
+			time = error ? time : modified;
+		}
+
+		lock.lock();
+		for (auto& [path, time] : snapshot) {
+			auto it = _files.find(path);
+			if (it != _files.end() && it->second != time) {
+				it->second = time;
+				if (std::find(_changes.begin(), _changes.end(), path) == _changes.end()) {
+					_changes.push_back(path);
+				}
+			}
+		}
+
+		// Sleep until the next poll, or until we're asked to stop
+		_wake.wait_for(lock, std::chrono::milliseconds(_pollIntervalMs), [this]() { return !_running; });
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Watches a set of files for modifications on a background thread, so that
+/// checking for changes never blocks the thread that consumes them
+/// </summary>
+class FileWatcher final {
+public:
+	MAKE_PTRS(FileWatcher);
+	NO_MOVE(FileWatcher);
+	NO_COPY(FileWatcher);
+
+	/// <summary>
+	/// Creates a new file watcher and starts it's background thread
+	/// </summary>
+	/// <param name="pollIntervalMs">The time between checks for modified files, in milliseconds</param>
+	FileWatcher(int pollIntervalMs = 250);
+	~FileWatcher();
+
+	/// <summary>
+	/// Adds a file to the set of watched files, does nothing if the file is already being watched
+	/// </summary>
+	/// <param name="path">The path of the file to watch</param>
+	void Watch(const std::string& path);
+
+	/// <summary>
+	/// Gets all the files that have been modified since the last call to PollChanges
+	/// </summary>
+	/// <returns>The paths of all modified files, as they were passed to Watch</returns>
+	std::vector<std::string> PollChanges();
+
+protected:
+	std::thread             _thread;
+	std::mutex              _mutex;
+	std::condition_variable _wake;
+	bool                    _running;
+	int                     _pollIntervalMs;
+
+	// The last known modification time of every file we are watching
+	std::unordered_map<std::string, std::filesystem::file_time_type> _files;
+	// Files that have been modified, but not yet returned from PollChanges
+	std::vector<std::string> _changes;
+
+	void _Run();
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// Calculates the 32 bit FNV-1a hash of a null terminated string, can be
+/// evaluated at compile time for string literals
+/// </summary>
+/// <param name="str">The string to hash</param>
+/// <returns>The FNV-1a hash of the string</returns>
+constexpr uint32_t Fnv1a32(const char* str) {
+	uint32_t hash = 2166136261u;
+	for (; *str != '\0'; str++) {
+		hash = (hash ^ static_cast<uint8_t>(*str)) * 16777619u;
+	}
+	return hash;
+}
+
+/// <summary>
+/// Calculates the 32 bit FNV-1a hash of a block of memory, the result of a previous call can be
+/// passed as the seed to combine hashes of several values
+/// </summary>
+/// <param name="data">The data to hash</param>
+/// <param name="size">The size of the data in bytes</param>
+/// <param name="hash">The hash to continue from</param>
+/// <returns>The FNV-1a hash of the data</returns>
+inline uint32_t Fnv1a32(const void* data, size_t size, uint32_t hash = 2166136261u) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t ix = 0; ix < size; ix++) {
+		hash = (hash ^ bytes[ix]) * 16777619u;
+	}
+	return hash;
+}
+
+/// <summary>
+/// A string paired with it's precomputed hash, used for fast lookups by name
+/// (ex: uniform names). When constructed from a string literal, the hash is 
+/// calculated at compile time
+/// 
+/// Note that this does NOT take ownership of the string, so it should only
+/// be used with literals or strings that outlive it
+/// </summary>
+struct HashedString {
+	uint32_t    Hash;
+	const char* Name;
+
+	constexpr HashedString(const char* name) :
+		Hash(Fnv1a32(name)),
+		Name(name) {}
+	HashedString(const std::string& name) :
+		Hash(Fnv1a32(name.c_str())),
+		Name(name.c_str()) {}
+};
+
+/// <summary>
+/// Creates a hashed string from a literal, ex: "u_ModelViewProjection"_hs
+/// </summary>
+constexpr HashedString operator""_hs(const char* str, size_t) {
+	return HashedString(str);
+}
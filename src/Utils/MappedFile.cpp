@@ -0,0 +1,94 @@
+#include "Utils/MappedFile.h"
+#include "Logging.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename) :
+	_isOpen(false),
+	_data(nullptr),
+	_size(0),
+	_fileHandle(nullptr),
+	_mappingHandle(nullptr),
+	_fileDescriptor(-1)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	_fileHandle = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		return;
+	}
+	_size = static_cast<size_t>(size.QuadPart);
+
+	// Windows can't map an empty file, but there's nothing to read anyways
+	if (_size > 0) {
+		_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (_mappingHandle == nullptr) {
+			LOG_WARN("Failed to create file mapping for \"{}\"", filename);
+			return;
+		}
+		_data = static_cast<const char*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (_data == nullptr) {
+			LOG_WARN("Failed to map view of \"{}\"", filename);
+			return;
+		}
+	}
+#else
+	_fileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (_fileDescriptor < 0) {
+		return;
+	}
+
+	struct stat info;
+	if (fstat(_fileDescriptor, &info) != 0) {
+		return;
+	}
+	_size = static_cast<size_t>(info.st_size);
+
+	if (_size > 0) {
+		void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+		if (mapping == MAP_FAILED) {
+			LOG_WARN("Failed to map \"{}\"", filename);
+			return;
+		}
+		// We read files front to back, so let the OS read ahead
+		madvise(mapping, _size, MADV_SEQUENTIAL);
+		_data = static_cast<const char*>(mapping);
+	}
+#endif
+	_isOpen = true;
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mappingHandle != nullptr) {
+		CloseHandle(_mappingHandle);
+	}
+	if (_fileHandle != nullptr) {
+		CloseHandle(_fileHandle);
+	}
+#else
+	if (_data != nullptr) {
+		munmap(const_cast<char*>(_data), _size);
+	}
+	if (_fileDescriptor >= 0) {
+		close(_fileDescriptor);
+	}
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Maps a file into memory as read-only, so that large files can be parsed in place
+/// without copying them into a buffer first. The mapping lives as long as this object
+/// </summary>
+class MappedFile {
+public:
+	NO_COPY(MappedFile);
+	NO_MOVE(MappedFile);
+
+	/// <summary>
+	/// Maps the given file into memory, check IsOpen to see if the file could be mapped
+	/// </summary>
+	/// <param name="filename">The path of the file to map</param>
+	MappedFile(const std::string& filename);
+	~MappedFile();
+
+	/// <summary>
+	/// Returns true if the file was opened successfully (empty files are open, but have no data)
+	/// </summary>
+	bool IsOpen() const { return _isOpen; }
+	/// <summary>
+	/// Gets a pointer to the start of the file's contents, or nullptr if the file is empty
+	/// </summary>
+	const char* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the file in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+
+protected:
+	bool        _isOpen;
+	const char* _data;
+	size_t      _size;
+
+	// Platform handles for the file and it's mapping
+	void*       _fileHandle;
+	void*       _mappingHandle;
+	int         _fileDescriptor;
+};
@@ -1,6 +1,13 @@
 #pragma once
 #include <vector>
+#include <cstring>
+#include <type_traits>
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/VertexTypes.h"
+#include "Graphics/VertexParamMap.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/MeshCollisionData.h"
+#include "Logging.h"
 
 /// <summary>
 /// A utility class that lets us add vertices and indices, then bake it into a final mesh, using interleaved
@@ -13,7 +20,8 @@ class MeshBuilder
 public:
 	MeshBuilder() :
 		_vertices(std::vector<VertType>()),
-		_indices(std::vector<uint32_t>()) {}
+		_indices(std::vector<uint32_t>()),
+		_lods(std::vector<Lod>()) {}
 	~MeshBuilder() = default;
 
 	/// <summary>
@@ -117,26 +125,145 @@ public:
 	size_t GetTriangleCount() const { return _indices.size() > 0 ? _indices.size() / 3 : _vertices.size() / 3; }
 
 	/// <summary>
-	/// Creates and returns a VertexArraybject from the current data
+	/// Reorders the triangles and vertices in this mesh so that it renders faster, by making better use of
+	/// the vertex cache, reducing overdraw, and making vertex fetches more linear. Vertices that are not used
+	/// by any triangles are removed. Only works on indexed meshes, and invalidates any indices returned
+	/// from AddVertex
 	/// </summary>
+	void Optimize() {
+		if (_indices.size() < 3) {
+			return;
+		}
+
+		MeshOptimizer::VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+
+		MeshOptimizer::OptimizeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+		// We can only sort for overdraw if we know where the positions are
+		VertexParamMap vMap = VertexParamMap(VertType::V_DECL);
+		if (vMap.PositionOffset != (uint32_t)-1) {
+			MeshOptimizer::OptimizeOverdraw(_indices.data(), _indices.size(), _vertices.data(), _vertices.size(), sizeof(VertType), vMap.PositionOffset);
+		}
+		size_t vertexCount = MeshOptimizer::OptimizeVertexFetch(_vertices.data(), _indices.data(), _indices.size(), _vertices.size(), sizeof(VertType));
+		_vertices.resize(vertexCount);
+
+		// The vertices have moved, so any LODs we had are no longer valid
+		_lods.clear();
+
+		MeshOptimizer::VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+		LOG_TRACE("Optimized mesh: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+	}
+
+	/// <summary>
+	/// Generates a chain of simplified versions of this mesh, each with about half the triangles of the one before it.
+	/// The LODs share the vertices of the full mesh, so they only add index data. Should be called after Optimize,
+	/// and any changes to the mesh afterwards will invalidate the LODs
+	/// </summary>
+	/// <param name="maxLods">The maximum number of LODs to generate, not including the full detail mesh</param>
+	/// <param name="maxError">The maximum error for the lowest detail LOD, relative to the size of the mesh</param>
+	void GenerateLods(uint32_t maxLods = 3, float maxError = 0.05f) {
+		_lods.clear();
+
+		VertexParamMap vMap = VertexParamMap(VertType::V_DECL);
+		if (_indices.size() < 3 || vMap.PositionOffset == (uint32_t)-1) {
+			return;
+		}
+
+		float error = 0.0f;
+		for (uint32_t ix = 0; ix < maxLods && error < maxError; ix++) {
+			// Simplify from the previous LOD, since it's smaller and already close to what we want
+			const std::vector<uint32_t>& source = ix == 0 ? _indices : _lods[ix - 1].Indices;
+			size_t target = source.size() / 6 * 3;
+
+			Lod lod;
+			lod.Indices.resize(source.size());
+			float lodError = 0.0f;
+			size_t indexCount = MeshOptimizer::Simplify(lod.Indices.data(), source.data(), source.size(), _vertices.data(), _vertices.size(),
+														sizeof(VertType), vMap.PositionOffset, target, maxError - error, &lodError);
+
+			// Stop once the mesh can't be simplified much further without going over the error limit
+			if (indexCount == 0 || indexCount > source.size() * 4 / 5) {
+				break;
+			}
+
+			lod.Indices.resize(indexCount);
+			MeshOptimizer::OptimizeVertexCache(lod.Indices.data(), lod.Indices.size(), _vertices.size());
+			// Each LOD's error is on top of the LOD it was simplified from
+			error += lodError;
+			lod.Error = error;
+			_lods.push_back(std::move(lod));
+
+			LOG_TRACE("Generated LOD {} with {} triangles (error {:.4f})", ix + 1, indexCount / 3, error);
+		}
+	}
+
+	/// <summary>
+	/// Returns the number of LODs generated by GenerateLods, not including the full detail mesh
+	/// </summary>
+	size_t GetLodCount() const { return _lods.size(); }
+	/// <summary>
+	/// Gets the indices for one of the LODs from GenerateLods, where 0 is the first simplified LOD
+	/// </summary>
+	const std::vector<uint32_t>& GetLodIndices(size_t lod) const { return _lods[lod].Indices; }
+	/// <summary>
+	/// Gets how far the surface of an LOD is from the full detail mesh, relative to the largest dimension of the mesh
+	/// </summary>
+	float GetLodError(size_t lod) const { return _lods[lod].Error; }
+
+	/// <summary>
+	/// Copies the positions and indices of this mesh, so that physics can build colliders from it without
+	/// having to read the mesh back from the GPU. Any existing hull in result is cleared
+	/// </summary>
+	/// <param name="result">The collision data to copy into</param>
+	void GetCollisionData(MeshCollisionData& result) const {
+		result.Positions.clear();
+		result.HullVertices.clear();
+		VertexParamMap vMap = VertexParamMap(VertType::V_DECL);
+		if (vMap.PositionOffset != (uint32_t)-1) {
+			result.Positions.resize(_vertices.size());
+			for (size_t ix = 0; ix < _vertices.size(); ix++) {
+				memcpy(&result.Positions[ix], reinterpret_cast<const uint8_t*>(&_vertices[ix]) + vMap.PositionOffset, sizeof(glm::vec3));
+			}
+		}
+		result.Indices = _indices;
+	}
+
+	/// <summary>
+	/// Creates and returns a VertexArraybject from the current data. Indices are stored as 16 bit if there are
+	/// few enough vertices, and VertexPosNormTexColTangents meshes are packed into VertexPosNormTexColTangentsPacked
+	/// </summary>
+	/// <param name="packVertices">False to upload VertexPosNormTexColTangents meshes as-is</param>
 	/// <returns>A VertexArrayObject</returns>
-	VertexArrayObject::Sptr Bake() {
+	VertexArrayObject::Sptr Bake(bool packVertices = true) {
 		VertexBuffer::Sptr vbo = VertexBuffer::Create();
-		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
+		const VertexArrayObject::VertexDeclaration* vDecl = &VertType::V_DECL;
+		if constexpr (std::is_same_v<VertType, VertexPosNormTexColTangents>) {
+			if (packVertices) {
+				std::vector<VertexPosNormTexColTangentsPacked> packed;
+				packed.reserve(_vertices.size());
+				for (const VertType& vertex : _vertices) {
+					packed.push_back(VertexPosNormTexColTangentsPacked::Pack(vertex));
+				}
+				vbo->LoadData(packed.data(), static_cast<uint32_t>(packed.size()));
+				vDecl = &VertexPosNormTexColTangentsPacked::V_DECL;
+			}
+		}
+		if (vDecl == &VertType::V_DECL) {
+			vbo->LoadData(GetVertexDataPtr(), _vertices.size());
+		}
 
 		IndexBuffer::Sptr ebo = nullptr;
 		if (_indices.size() > 0) {
 			ebo = IndexBuffer::Create();
-			ebo->LoadData(GetIndexDataPtr(), _indices.size());
+			ebo->LoadIndices(GetIndexDataPtr(), static_cast<uint32_t>(_indices.size()), _vertices.size());
 		}
 
 		// Create VAO and attach the buffers
 		VertexArrayObject::Sptr result = VertexArrayObject::Create();
-		result->AddVertexBuffer(vbo, VertType::V_DECL);
+		result->AddVertexBuffer(vbo, *vDecl);
 		result->SetIndexBuffer(ebo);
 
 		// Store our vertex type in the VAO's vertex declaration
-		result->SetVDecl(VertType::V_DECL);
+		result->SetVDecl(*vDecl);
 
 		return result;
 	}
@@ -147,6 +274,7 @@ public:
 	void Reset() {
 		_vertices.clear();
 		_indices.clear();
+		_lods.clear();
 	}
 
 	/// <summary>
@@ -157,6 +285,13 @@ public:
 		return _vertices.data();
 	}
 	/// <summary>
+	/// Gets a mutable pointer to the underlying vertex data in the mesh, valid only
+	/// until another call to AddVertex
+	/// </summary>
+	VertType* GetVertexDataPtr() {
+		return _vertices.data();
+	}
+	/// <summary>
 	/// Gets a pointer to the underlying index data in the mesh, valid only
 	/// until another call to AddIndex or AddIndexTri
 	/// </summary>
@@ -166,7 +301,13 @@ public:
 	
 protected:
 	friend class MeshFactory;
+
+	struct Lod {
+		std::vector<uint32_t> Indices;
+		float                 Error = 0.0f;
+	};
 	
 	std::vector<VertType> _vertices;
 	std::vector<uint32_t> _indices;
+	std::vector<Lod>      _lods;
 };
@@ -0,0 +1,33 @@
+#include "Utils/MeshCollisionData.h"
+
+#include <btBulletCollisionCommon.h>
+#include <BulletCollision/CollisionShapes/btShapeHull.h>
+
+#include "Logging.h"
+
+bool MeshCollisionData::BuildHull() {
+	HullVertices.clear();
+	if (Positions.size() < 4) {
+		return false;
+	}
+
+	// Wrap all our points in a temporary hull shape so btShapeHull can sample it
+	btConvexHullShape shape;
+	for (const glm::vec3& position : Positions) {
+		shape.addPoint(btVector3(position.x, position.y, position.z), false);
+	}
+	shape.recalcLocalAabb();
+
+	btShapeHull hull(&shape);
+	if (!hull.buildHull(shape.getMargin())) {
+		LOG_WARN("Failed to build hull for convex mesh");
+		return false;
+	}
+
+	HullVertices.reserve(hull.numVertices());
+	for (int ix = 0; ix < hull.numVertices(); ix++) {
+		const btVector3& vertex = hull.getVertexPointer()[ix];
+		HullVertices.push_back(glm::vec3(vertex.x(), vertex.y(), vertex.z()));
+	}
+	return true;
+}
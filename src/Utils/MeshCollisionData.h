@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <GLM/glm.hpp>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A compact CPU side copy of a mesh's triangles, kept around so that physics can build colliders
+/// without reading the mesh back from the GPU
+/// </summary>
+struct MeshCollisionData {
+	MAKE_PTRS(MeshCollisionData);
+
+	// The position of every vertex in the mesh
+	std::vector<glm::vec3> Positions;
+	// The triangle list indices into Positions
+	std::vector<uint32_t>  Indices;
+	// The vertices of a simplified convex hull around the mesh, empty until BuildHull is called or
+	// it is loaded from a binary mesh file
+	std::vector<glm::vec3> HullVertices;
+
+	/// <summary>
+	/// Calculates HullVertices from Positions using bullet's btShapeHull, which reduces the hull
+	/// down to a few dozen vertices no matter how detailed the mesh is
+	/// </summary>
+	/// <returns>True if a hull was built</returns>
+	bool BuildHull();
+};
@@ -0,0 +1,182 @@
+#include "Utils/MeshCompression.h"
+
+#include <cstring>
+
+namespace {
+	// Vertex bytes are packed in groups of this many, with a 2 bit header per group
+	constexpr size_t VERTEX_GROUP_SIZE = 16;
+	// The number of bits used per byte for each group header value
+	constexpr uint32_t GROUP_BITS[4] = { 0, 2, 4, 8 };
+
+	inline uint8_t ZigZag8(uint8_t delta) {
+		return static_cast<uint8_t>((delta << 1) ^ static_cast<uint8_t>(static_cast<int8_t>(delta) >> 7));
+	}
+	inline uint8_t UnZigZag8(uint8_t value) {
+		return static_cast<uint8_t>((value >> 1) ^ static_cast<uint8_t>(-(value & 1)));
+	}
+
+	inline uint32_t ZigZag32(int32_t delta) {
+		return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+	}
+	inline int32_t UnZigZag32(uint32_t value) {
+		return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+	}
+}
+
+void MeshCompression::EncodeIndices(const uint32_t* indices, size_t count, std::vector<uint8_t>& output) {
+	// Worst case is 5 bytes per index, but most will only need 1 or 2
+	output.reserve(output.size() + count * 2);
+
+	uint32_t previous = 0;
+	for (size_t ix = 0; ix < count; ix++) {
+		uint32_t value = ZigZag32(static_cast<int32_t>(indices[ix] - previous));
+		previous = indices[ix];
+
+		// Write out 7 bits at a time, with the top bit marking that there's more to come
+		while (value >= 0x80) {
+			output.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		output.push_back(static_cast<uint8_t>(value));
+	}
+}
+
+bool MeshCompression::DecodeIndices(const uint8_t* data, size_t size, uint32_t* output, size_t count) {
+	const uint8_t* end = data + size;
+	uint32_t previous = 0;
+	for (size_t ix = 0; ix < count; ix++) {
+		uint32_t value = 0;
+		uint32_t shift = 0;
+		while (true) {
+			if (data >= end || shift > 28) {
+				return false;
+			}
+			uint8_t byte = *data++;
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			shift += 7;
+			if ((byte & 0x80) == 0) {
+				break;
+			}
+		}
+		previous += static_cast<uint32_t>(UnZigZag32(value));
+		output[ix] = previous;
+	}
+	return data == end;
+}
+
+void MeshCompression::EncodeVertices(const void* vertices, size_t count, size_t stride, std::vector<uint8_t>& output) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(vertices);
+	size_t groupCount = (count + VERTEX_GROUP_SIZE - 1) / VERTEX_GROUP_SIZE;
+
+	// Each byte of the vertex is stored as it's own stream, so that similar data ends up together
+	for (size_t byteIx = 0; byteIx < stride; byteIx++) {
+		size_t headerStart = output.size();
+		output.resize(output.size() + (groupCount + 3) / 4, 0);
+
+		uint8_t previous = 0;
+		for (size_t group = 0; group < groupCount; group++) {
+			uint8_t deltas[VERTEX_GROUP_SIZE] = { 0 };
+			uint8_t combined = 0;
+			for (size_t ix = 0; ix < VERTEX_GROUP_SIZE; ix++) {
+				size_t vertex = group * VERTEX_GROUP_SIZE + ix;
+				if (vertex < count) {
+					uint8_t value = bytes[vertex * stride + byteIx];
+					deltas[ix] = ZigZag8(static_cast<uint8_t>(value - previous));
+					previous = value;
+					combined |= deltas[ix];
+				}
+			}
+
+			// Pick the smallest bit width that fits every delta in the group
+			uint8_t code = combined == 0 ? 0 : combined < 4 ? 1 : combined < 16 ? 2 : 3;
+			output[headerStart + group / 4] |= static_cast<uint8_t>(code << ((group % 4) * 2));
+
+			uint32_t bits = GROUP_BITS[code];
+			if (bits == 8) {
+				output.insert(output.end(), deltas, deltas + VERTEX_GROUP_SIZE);
+			} else if (bits > 0) {
+				uint32_t perByte = 8 / bits;
+				for (size_t ix = 0; ix < VERTEX_GROUP_SIZE; ix += perByte) {
+					uint8_t packed = 0;
+					for (uint32_t jx = 0; jx < perByte; jx++) {
+						packed |= static_cast<uint8_t>(deltas[ix + jx] << (jx * bits));
+					}
+					output.push_back(packed);
+				}
+			}
+		}
+	}
+}
+
+bool MeshCompression::DecodeVertices(const uint8_t* data, size_t size, void* output, size_t count, size_t stride) {
+	uint8_t* bytes = static_cast<uint8_t*>(output);
+	const uint8_t* end = data + size;
+	size_t groupCount = (count + VERTEX_GROUP_SIZE - 1) / VERTEX_GROUP_SIZE;
+
+	for (size_t byteIx = 0; byteIx < stride; byteIx++) {
+		const uint8_t* header = data;
+		data += (groupCount + 3) / 4;
+		if (data > end) {
+			return false;
+		}
+
+		uint8_t previous = 0;
+		for (size_t group = 0; group < groupCount; group++) {
+			uint8_t code = (header[group / 4] >> ((group % 4) * 2)) & 0b11;
+			uint32_t bits = GROUP_BITS[code];
+
+			uint8_t deltas[VERTEX_GROUP_SIZE] = { 0 };
+			if (bits == 8) {
+				if (static_cast<size_t>(end - data) < VERTEX_GROUP_SIZE) {
+					return false;
+				}
+				memcpy(deltas, data, VERTEX_GROUP_SIZE);
+				data += VERTEX_GROUP_SIZE;
+			} else if (bits > 0) {
+				uint32_t perByte = 8 / bits;
+				uint8_t mask = static_cast<uint8_t>((1 << bits) - 1);
+				if (static_cast<size_t>(end - data) < VERTEX_GROUP_SIZE / perByte) {
+					return false;
+				}
+				for (size_t ix = 0; ix < VERTEX_GROUP_SIZE; ix += perByte) {
+					uint8_t packed = *data++;
+					for (uint32_t jx = 0; jx < perByte; jx++) {
+						deltas[ix + jx] = (packed >> (jx * bits)) & mask;
+					}
+				}
+			}
+
+			for (size_t ix = 0; ix < VERTEX_GROUP_SIZE; ix++) {
+				size_t vertex = group * VERTEX_GROUP_SIZE + ix;
+				if (vertex < count) {
+					previous = static_cast<uint8_t>(previous + UnZigZag8(deltas[ix]));
+					bytes[vertex * stride + byteIx] = previous;
+				}
+			}
+		}
+	}
+	return data == end;
+}
+
+uint32_t MeshCompression::EncodeOctahedral(const glm::vec3& normal) {
+	// Project onto the octahedron, then fold the bottom half over the top
+	float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+	if (length == 0.0f) {
+		return glm::packSnorm2x16(glm::vec2(0.0f));
+	}
+	glm::vec2 result = glm::vec2(normal.x, normal.y) / length;
+	if (normal.z < 0.0f) {
+		glm::vec2 sign = glm::vec2(result.x >= 0.0f ? 1.0f : -1.0f, result.y >= 0.0f ? 1.0f : -1.0f);
+		result = (1.0f - glm::abs(glm::vec2(result.y, result.x))) * sign;
+	}
+	return glm::packSnorm2x16(result);
+}
+
+glm::vec3 MeshCompression::DecodeOctahedral(uint32_t encoded) {
+	glm::vec2 value = glm::unpackSnorm2x16(encoded);
+	glm::vec3 result = glm::vec3(value.x, value.y, 1.0f - glm::abs(value.x) - glm::abs(value.y));
+	float fold = glm::max(-result.z, 0.0f);
+	result.x += result.x >= 0.0f ? -fold : fold;
+	result.y += result.y >= 0.0f ? -fold : fold;
+	return glm::normalize(result);
+}
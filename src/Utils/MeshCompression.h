@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Lossless codecs for vertex and index data, along with helpers for quantizing
+/// vertex attributes into smaller formats
+///
+/// The vertex codec works on each byte of the vertex separately, storing the difference
+/// from the same byte in the previous vertex. Neighbouring vertices tend to be similar,
+/// so most of these deltas are small and are bit-packed into 2 or 4 bits per byte
+///
+/// The index codec stores each index as a variable length delta from the previous index,
+/// which works best on meshes that have been optimized for the vertex cache
+/// </summary>
+class MeshCompression {
+public:
+	/// <summary>
+	/// Compresses an array of indices, appending the result to output
+	/// </summary>
+	/// <param name="indices">The indices to compress</param>
+	/// <param name="count">The number of indices</param>
+	/// <param name="output">The buffer to append the compressed data to</param>
+	static void EncodeIndices(const uint32_t* indices, size_t count, std::vector<uint8_t>& output);
+	/// <summary>
+	/// Decompresses indices that were written by EncodeIndices
+	/// </summary>
+	/// <param name="data">The compressed data</param>
+	/// <param name="size">The size of the compressed data in bytes</param>
+	/// <param name="output">Receives the decoded indices, must have room for count indices</param>
+	/// <param name="count">The number of indices to decode</param>
+	/// <returns>False if the data is truncated or malformed</returns>
+	static bool DecodeIndices(const uint8_t* data, size_t size, uint32_t* output, size_t count);
+
+	/// <summary>
+	/// Compresses an array of vertices, appending the result to output
+	/// </summary>
+	/// <param name="vertices">The vertex data to compress</param>
+	/// <param name="count">The number of vertices</param>
+	/// <param name="stride">The size of a single vertex in bytes</param>
+	/// <param name="output">The buffer to append the compressed data to</param>
+	static void EncodeVertices(const void* vertices, size_t count, size_t stride, std::vector<uint8_t>& output);
+	/// <summary>
+	/// Decompresses vertices that were written by EncodeVertices
+	/// </summary>
+	/// <param name="data">The compressed data</param>
+	/// <param name="size">The size of the compressed data in bytes</param>
+	/// <param name="output">Receives the decoded vertices, must have room for count * stride bytes</param>
+	/// <param name="count">The number of vertices to decode</param>
+	/// <param name="stride">The size of a single vertex in bytes</param>
+	/// <returns>False if the data is truncated or malformed</returns>
+	static bool DecodeVertices(const uint8_t* data, size_t size, void* output, size_t count, size_t stride);
+
+	/// <summary>
+	/// Encodes a unit vector as 2 signed 16 bit values using an octahedral mapping
+	/// </summary>
+	static uint32_t EncodeOctahedral(const glm::vec3& normal);
+	/// <summary>
+	/// Decodes a unit vector from EncodeOctahedral
+	/// </summary>
+	static glm::vec3 DecodeOctahedral(uint32_t encoded);
+
+protected:
+	MeshCompression() = default;
+	~MeshCompression() = default;
+};
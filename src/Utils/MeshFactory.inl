@@ -4,6 +4,10 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <GLM/gtx/euler_angles.hpp>
 #include <unordered_map>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <execution>
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include "Graphics/VertexArrayObject.h"
 #include "Logging.h"
@@ -570,50 +574,115 @@ void MeshFactory::CalculateTBN(MeshBuilder<Vertex>& mesh)
 		return;
 	}
 
-	for (size_t i = 0; i < mesh._vertices.size(); i++) {
-		vMap.SetTangent(mesh._vertices[i], glm::vec3(0.0f));
-		vMap.SetBiTangent(mesh._vertices[i], glm::vec3(0.0f));
-	}
+	const std::vector<uint32_t>& indices = mesh._indices;
+	std::vector<Vertex>& vertices = mesh._vertices;
+	const size_t triangleCount = indices.size() / 3;
+	const size_t vertexCount = vertices.size();
+
+	// Runs func(begin, end) over [0, count) in parallel, in chunks that are big enough to be worth a thread
+	auto parallelFor = [](size_t count, const auto& func) {
+		const size_t chunkSize = 4096;
+		std::vector<size_t> chunks((count + chunkSize - 1) / chunkSize);
+		std::iota(chunks.begin(), chunks.end(), 0);
+		std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+			func(chunk * chunkSize, std::min((chunk + 1) * chunkSize, count));
+		});
+	};
+
+	// Work out which way the UVs run across every triangle, and how much each corner contributes to it's vertex.
+	// Corners are weighted by their angle, so the result doesn't depend on how the surface was split into triangles
+	std::vector<glm::vec3> faceTangents(triangleCount);
+	std::vector<glm::vec3> faceBiTangents(triangleCount);
+	std::vector<float>     cornerWeights(triangleCount * 3);
+	parallelFor(triangleCount, [&](size_t begin, size_t end) {
+		for (size_t ix = begin; ix < end; ix++) {
+			glm::vec3 pos[3];
+			glm::vec2 uvs[3];
+			for (int corner = 0; corner < 3; corner++) {
+				Vertex& vertex = vertices[indices[ix * 3 + corner]];
+				pos[corner] = vMap.GetPosition(vertex);
+				uvs[corner] = vMap.GetTexture(vertex);
+			}
+
+			// Calculate 2 corner vectors and their UV deltas
+			glm::vec3 deltaP1 = pos[1] - pos[0];
+			glm::vec3 deltaP2 = pos[2] - pos[0];
+			glm::vec2 deltaT1 = uvs[1] - uvs[0];
+			glm::vec2 deltaT2 = uvs[2] - uvs[0];
+
+			// Use the deltas in position and UV to calculate the tangent and bitangent
+			// https://learnopengl.com/Advanced-Lighting/Normal-Mapping
+			// Triangles with no area in UV space can't tell us which way the texture goes, so they don't contribute
+			float det = deltaT1.x * deltaT2.y - deltaT1.y * deltaT2.x;
+			glm::vec3 tangent = deltaP1 * deltaT2.y - deltaP2 * deltaT1.y;
+			glm::vec3 bitangent = deltaP2 * deltaT1.x - deltaP1 * deltaT2.x;
+			float tangentLength = glm::length(tangent);
+			float bitangentLength = glm::length(bitangent);
+			if (det == 0.0f || tangentLength == 0.0f || bitangentLength == 0.0f) {
+				faceTangents[ix] = glm::vec3(0.0f);
+				faceBiTangents[ix] = glm::vec3(0.0f);
+				cornerWeights[ix * 3 + 0] = cornerWeights[ix * 3 + 1] = cornerWeights[ix * 3 + 2] = 0.0f;
+				continue;
+			}
+			// We only need the directions, so we can use the sign of the determinant instead of dividing by it
+			float sign = det < 0.0f ? -1.0f : 1.0f;
+			faceTangents[ix] = tangent * (sign / tangentLength);
+			faceBiTangents[ix] = bitangent * (sign / bitangentLength);
+
+			for (int corner = 0; corner < 3; corner++) {
+				glm::vec3 edgeA = pos[(corner + 1) % 3] - pos[corner];
+				glm::vec3 edgeB = pos[(corner + 2) % 3] - pos[corner];
+				float lengths = glm::length(edgeA) * glm::length(edgeB);
+				cornerWeights[ix * 3 + corner] = lengths > 0.0f ? glm::acos(glm::clamp(glm::dot(edgeA, edgeB) / lengths, -1.0f, 1.0f)) : 0.0f;
+			}
+		}
+	});
 
-	// Iterate over all indices in the mesh, we'll assume that the mesh is indexed
-	for (size_t i = 0; i < mesh._indices.size(); i += 3) {
-		Vertex& v1 = mesh._vertices[mesh._indices[i + 0u]];
-		Vertex& v2 = mesh._vertices[mesh._indices[i + 1u]];
-		Vertex& v3 = mesh._vertices[mesh._indices[i + 2u]];
-
-		// Extract the positions from the mesh
-		glm::vec3 pos[3];
-		pos[0] = vMap.GetPosition(v1);
-		pos[1] = vMap.GetPosition(v2);
-		pos[2] = vMap.GetPosition(v3);
-
-		// Extract the UVs from the mesh
-		glm::vec2 uvs[3];
-		uvs[0] = vMap.GetTexture(v1);
-		uvs[1] = vMap.GetTexture(v2);
-		uvs[2] = vMap.GetTexture(v3);
-
-		// Calculate 2 corner vectors
-		glm::vec3 deltaP1 = pos[1] - pos[0];
-		glm::vec3 deltaP2 = pos[2] - pos[0];
-
-		// Calculate UV deltas
-		glm::vec2 deltaT1 = uvs[1] - uvs[0];
-		glm::vec2 deltaT2 = uvs[2] - uvs[0];
-
-		// Use the deltas in position and UV to calculate the tangent and bitangent
-		// https://learnopengl.com/Advanced-Lighting/Normal-Mapping
-		float r = 1.0f / (deltaT1.x * deltaT2.y - deltaT1.y * deltaT2.x);
-		glm::vec3 tangent = glm::normalize((deltaP1 * deltaT2.y - deltaP2 * deltaT1.y) * r);
-		glm::vec3 bitangent = glm::normalize((deltaP2 * deltaT1.x - deltaP1 * deltaT2.x) * r);
-
-		// Set attributes in the vertex
-		vMap.SetTangent(v1, glm::normalize((vMap.GetTangent(v1) + tangent) / 2.0f));
-		vMap.SetTangent(v2, glm::normalize((vMap.GetTangent(v2) + tangent) / 2.0f));
-		vMap.SetTangent(v3, glm::normalize((vMap.GetTangent(v3) + tangent) / 2.0f));
-
-		vMap.SetBiTangent(v1, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
-		vMap.SetBiTangent(v2, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
-		vMap.SetBiTangent(v3, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
+	// Make a list of the corners around each vertex, so that every vertex can be summed up on it's own
+	std::vector<uint32_t> cornerOffsets(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < triangleCount * 3; ix++) {
+		cornerOffsets[indices[ix] + 1]++;
 	}
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		cornerOffsets[ix + 1] += cornerOffsets[ix];
+	}
+	std::vector<uint32_t> vertexCorners(triangleCount * 3);
+	std::vector<uint32_t> cornerCursors(cornerOffsets.begin(), cornerOffsets.end() - 1);
+	for (size_t ix = 0; ix < triangleCount * 3; ix++) {
+		vertexCorners[cornerCursors[indices[ix]]++] = static_cast<uint32_t>(ix);
+	}
+
+	// Sum up the corners around each vertex, then make the tangent perpendicular to the normal (Gram-Schmidt) and
+	// rebuild the bitangent from the normal and tangent. The handedness of the UVs is kept in the bitangent's direction
+	parallelFor(vertexCount, [&](size_t begin, size_t end) {
+		for (size_t ix = begin; ix < end; ix++) {
+			glm::vec3 tangent = glm::vec3(0.0f);
+			glm::vec3 bitangent = glm::vec3(0.0f);
+			for (uint32_t corner = cornerOffsets[ix]; corner < cornerOffsets[ix + 1]; corner++) {
+				uint32_t cornerIx = vertexCorners[corner];
+				tangent += faceTangents[cornerIx / 3] * cornerWeights[cornerIx];
+				bitangent += faceBiTangents[cornerIx / 3] * cornerWeights[cornerIx];
+			}
+
+			glm::vec3 normal = vMap.GetNormal(vertices[ix]);
+			if (glm::dot(normal, normal) > 0.0f) {
+				normal = glm::normalize(normal);
+				tangent -= normal * glm::dot(normal, tangent);
+				// If the vertex doesn't have a usable tangent, any direction along the surface will do
+				if (glm::dot(tangent, tangent) < 1e-12f) {
+					tangent = glm::cross(normal, glm::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+				}
+				tangent = glm::normalize(tangent);
+				float handedness = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+				bitangent = glm::cross(normal, tangent) * handedness;
+			} else {
+				// Without a normal, the best we can do is normalize what we have
+				tangent = glm::dot(tangent, tangent) > 0.0f ? glm::normalize(tangent) : tangent;
+				bitangent = glm::dot(bitangent, bitangent) > 0.0f ? glm::normalize(bitangent) : bitangent;
+			}
+
+			vMap.SetTangent(vertices[ix], tangent);
+			vMap.SetBiTangent(vertices[ix], bitangent);
+		}
+	});
 }
\ No newline at end of file
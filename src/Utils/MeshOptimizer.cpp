@@ -0,0 +1,647 @@
+#include "Utils/MeshOptimizer.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <GLM/glm.hpp>
+
+#include "Logging.h"
+
+namespace {
+	// The size of the cache the vertex scores are tuned for, this does not need to match the hardware
+	constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+	constexpr float    CACHE_DECAY_POWER   = 1.5f;
+	constexpr float    LAST_TRI_SCORE      = 0.75f;
+	constexpr float    VALENCE_BOOST_SCALE = 2.0f;
+	constexpr float    VALENCE_BOOST_POWER = 0.5f;
+
+	// The cache size used to find cluster boundaries when optimizing overdraw
+	constexpr uint32_t OVERDRAW_CACHE_SIZE = 16;
+
+	/// <summary>
+	/// Scores a vertex based on where it is in the cache, and how many triangles still need it. Vertices
+	/// with only a few triangles left get a boost, so we finish them off instead of leaving lone triangles
+	/// </summary>
+	float VertexScore(int cachePosition, uint32_t remainingTris) {
+		if (remainingTris == 0) {
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			// Vertices from the last triangle get a fixed score, so we don't just keep walking back and forth
+			if (cachePosition < 3) {
+				score = LAST_TRI_SCORE;
+			} else {
+				const float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+				score = powf(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+			}
+		}
+
+		score += VALENCE_BOOST_SCALE * powf(static_cast<float>(remainingTris), -VALENCE_BOOST_POWER);
+		return score;
+	}
+
+	/// <summary>
+	/// A FIFO cache that uses timestamps, so it can be flushed in constant time
+	/// </summary>
+	struct FifoCache {
+		std::vector<uint32_t> Timestamps;
+		uint32_t Time;
+		uint32_t Size;
+
+		FifoCache(size_t vertexCount, uint32_t size) :
+			Timestamps(vertexCount, 0),
+			Time(size + 1),
+			Size(size)
+		{ }
+
+		// Returns 1 if the vertex was not in the cache
+		uint32_t Access(uint32_t vertex) {
+			if (Time - Timestamps[vertex] > Size) {
+				Timestamps[vertex] = Time++;
+				return 1;
+			}
+			return 0;
+		}
+
+		uint32_t AccessTriangle(const uint32_t* tri) {
+			return Access(tri[0]) + Access(tri[1]) + Access(tri[2]);
+		}
+
+		void Flush() {
+			Time += Size + 1;
+		}
+	};
+
+	/// <summary>
+	/// A symmetric 4x4 matrix that measures the sum of squared distances from a point to a set of planes
+	/// </summary>
+	struct Quadric {
+		double A2 = 0, AB = 0, AC = 0, AD = 0;
+		double B2 = 0, BC = 0, BD = 0;
+		double C2 = 0, CD = 0;
+		double D2 = 0;
+
+		void AddPlane(const glm::vec3& normal, float distance) {
+			double a = normal.x, b = normal.y, c = normal.z, d = distance;
+			A2 += a * a; AB += a * b; AC += a * c; AD += a * d;
+			B2 += b * b; BC += b * c; BD += b * d;
+			C2 += c * c; CD += c * d;
+			D2 += d * d;
+		}
+
+		Quadric& operator +=(const Quadric& other) {
+			A2 += other.A2; AB += other.AB; AC += other.AC; AD += other.AD;
+			B2 += other.B2; BC += other.BC; BD += other.BD;
+			C2 += other.C2; CD += other.CD;
+			D2 += other.D2;
+			return *this;
+		}
+
+		double Evaluate(const glm::vec3& p) const {
+			double x = p.x, y = p.y, z = p.z;
+			double result =
+				A2 * x * x + 2 * AB * x * y + 2 * AC * x * z + 2 * AD * x +
+				B2 * y * y + 2 * BC * y * z + 2 * BD * y +
+				C2 * z * z + 2 * CD * z +
+				D2;
+			// Rounding can push us slightly below zero
+			return result > 0.0 ? result : 0.0;
+		}
+	};
+
+	bool ValidateIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+		for (size_t ix = 0; ix < indexCount; ix++) {
+			if (indices[ix] >= vertexCount) {
+				LOG_WARN("Index {} is out of range for a mesh with {} vertices, skipping optimization", indices[ix], vertexCount);
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStats result;
+	if (indexCount < 3 || !ValidateIndices(indices, indexCount, vertexCount)) {
+		return result;
+	}
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> used(vertexCount, false);
+	size_t misses = 0;
+	size_t usedCount = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		misses += cache.Access(indices[ix]);
+		if (!used[indices[ix]]) {
+			used[indices[ix]] = true;
+			usedCount++;
+		}
+	}
+
+	result.ACMR = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+	result.ATVR = static_cast<float>(misses) / static_cast<float>(usedCount);
+	return result;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	const size_t triCount = indexCount / 3;
+	if (triCount == 0 || !ValidateIndices(indices, indexCount, vertexCount)) {
+		return;
+	}
+
+	// Build a list of the triangles that use each vertex
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (size_t ix = 0; ix < triCount * 3; ix++) {
+		remaining[indices[ix]]++;
+	}
+	std::vector<uint32_t> offsets(vertexCount, 0);
+	for (size_t ix = 1; ix < vertexCount; ix++) {
+		offsets[ix] = offsets[ix - 1] + remaining[ix - 1];
+	}
+	std::vector<uint32_t> adjacency(triCount * 3);
+	{
+		std::vector<uint32_t> fill = offsets;
+		for (size_t ix = 0; ix < triCount * 3; ix++) {
+			adjacency[fill[indices[ix]]++] = static_cast<uint32_t>(ix / 3);
+		}
+	}
+
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexScores[ix] = VertexScore(-1, remaining[ix]);
+	}
+
+	std::vector<float> triScores(triCount);
+	std::vector<bool> emitted(triCount, false);
+	int bestTri = -1;
+	float bestScore = -1.0f;
+	for (size_t ix = 0; ix < triCount; ix++) {
+		const uint32_t* tri = indices + ix * 3;
+		triScores[ix] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+		if (triScores[ix] > bestScore) {
+			bestScore = triScores[ix];
+			bestTri = static_cast<int>(ix);
+		}
+	}
+
+	std::vector<uint32_t> output;
+	output.reserve(triCount * 3);
+
+	// We keep 3 extra slots so the new triangle can push vertices out of the cache
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t cacheCount = 0;
+	size_t cursor = 0;
+
+	while (true) {
+		// If nothing in the cache has triangles left, continue from the next triangle that hasn't been used
+		if (bestTri < 0) {
+			while (cursor < triCount && emitted[cursor]) {
+				cursor++;
+			}
+			if (cursor == triCount) {
+				break;
+			}
+			bestTri = static_cast<int>(cursor);
+		}
+
+		const uint32_t* tri = indices + bestTri * 3;
+		output.insert(output.end(), tri, tri + 3);
+		emitted[bestTri] = true;
+
+		// Remove the triangle from the adjacency of it's vertices
+		for (int ix = 0; ix < 3; ix++) {
+			uint32_t vertex = tri[ix];
+			uint32_t* begin = adjacency.data() + offsets[vertex];
+			uint32_t* end = begin + remaining[vertex];
+			uint32_t* it = std::find(begin, end, static_cast<uint32_t>(bestTri));
+			if (it != end) {
+				*it = *(end - 1);
+				remaining[vertex]--;
+			}
+		}
+
+		// Push the triangle's vertices to the front of the cache
+		uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+		uint32_t newCount = 0;
+		newCache[newCount++] = tri[0];
+		newCache[newCount++] = tri[1];
+		newCache[newCount++] = tri[2];
+		for (uint32_t ix = 0; ix < cacheCount; ix++) {
+			uint32_t vertex = cache[ix];
+			if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2]) {
+				newCache[newCount++] = vertex;
+			}
+		}
+
+		// Anything that fell off the end of the cache needs it's score updated
+		for (uint32_t ix = FORSYTH_CACHE_SIZE; ix < newCount; ix++) {
+			vertexScores[newCache[ix]] = VertexScore(-1, remaining[newCache[ix]]);
+		}
+
+		cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+		memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+		for (uint32_t ix = 0; ix < cacheCount; ix++) {
+			vertexScores[cache[ix]] = VertexScore(static_cast<int>(ix), remaining[cache[ix]]);
+		}
+
+		// The next triangle will be the best scoring one that uses a vertex in the cache
+		bestTri = -1;
+		bestScore = -1.0f;
+		for (uint32_t ix = 0; ix < cacheCount; ix++) {
+			uint32_t vertex = cache[ix];
+			const uint32_t* adjacent = adjacency.data() + offsets[vertex];
+			for (uint32_t jx = 0; jx < remaining[vertex]; jx++) {
+				uint32_t triIx = adjacent[jx];
+				const uint32_t* other = indices + triIx * 3;
+				triScores[triIx] = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				if (triScores[triIx] > bestScore) {
+					bestScore = triScores[triIx];
+					bestTri = static_cast<int>(triIx);
+				}
+			}
+		}
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t stride, size_t positionOffset, float threshold) {
+	const size_t triCount = indexCount / 3;
+	if (triCount == 0 || !ValidateIndices(indices, indexCount, vertexCount)) {
+		return;
+	}
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(vertices);
+	auto GetPosition = [&](uint32_t vertex) {
+		glm::vec3 result;
+		memcpy(&result, bytes + vertex * stride + positionOffset, sizeof(glm::vec3));
+		return result;
+	};
+
+	FifoCache cache(vertexCount, OVERDRAW_CACHE_SIZE);
+
+	// Hard boundaries are where the cache gets flushed anyways, so splitting there costs us nothing
+	std::vector<size_t> hardBoundaries;
+	for (size_t ix = 0; ix < triCount; ix++) {
+		if (cache.AccessTriangle(indices + ix * 3) == 3 || ix == 0) {
+			hardBoundaries.push_back(ix);
+		}
+	}
+	hardBoundaries.push_back(triCount);
+
+	// Soft boundaries split the hard clusters further, wherever the cluster so far has a good enough ACMR
+	std::vector<size_t> clusters;
+	for (size_t hard = 0; hard + 1 < hardBoundaries.size(); hard++) {
+		size_t start = hardBoundaries[hard];
+		size_t end = hardBoundaries[hard + 1];
+
+		cache.Flush();
+		uint32_t clusterMisses = 0;
+		for (size_t ix = start; ix < end; ix++) {
+			clusterMisses += cache.AccessTriangle(indices + ix * 3);
+		}
+		float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+		cache.Flush();
+		clusters.push_back(start);
+		size_t softStart = start;
+		uint32_t misses = 0;
+		for (size_t ix = start; ix < end; ix++) {
+			misses += cache.AccessTriangle(indices + ix * 3);
+			if (ix + 1 < end && static_cast<float>(misses) / static_cast<float>(ix + 1 - softStart) <= clusterThreshold) {
+				clusters.push_back(ix + 1);
+				softStart = ix + 1;
+				misses = 0;
+				cache.Flush();
+			}
+		}
+	}
+	clusters.push_back(triCount);
+
+	// Find the area weighted center of the mesh
+	glm::vec3 meshCenter = glm::vec3(0.0f);
+	float meshArea = 0.0f;
+	std::vector<glm::vec3> triCenters(triCount);
+	std::vector<glm::vec3> triNormals(triCount);
+	for (size_t ix = 0; ix < triCount; ix++) {
+		const uint32_t* tri = indices + ix * 3;
+		glm::vec3 p0 = GetPosition(tri[0]);
+		glm::vec3 p1 = GetPosition(tri[1]);
+		glm::vec3 p2 = GetPosition(tri[2]);
+
+		// The length of the cross product is twice the area, which is fine since we only need relative weights
+		triNormals[ix] = glm::cross(p1 - p0, p2 - p0);
+		triCenters[ix] = (p0 + p1 + p2) / 3.0f;
+
+		float area = glm::length(triNormals[ix]);
+		meshCenter += triCenters[ix] * area;
+		meshArea += area;
+	}
+	meshCenter = meshArea > 0.0f ? meshCenter / meshArea : meshCenter;
+
+	// Clusters that are further out and facing away from the center are more likely to be occluders
+	struct ClusterSort {
+		size_t Start;
+		size_t End;
+		float  Key;
+	};
+	std::vector<ClusterSort> sorted(clusters.size() - 1);
+	for (size_t ix = 0; ix + 1 < clusters.size(); ix++) {
+		glm::vec3 center = glm::vec3(0.0f);
+		glm::vec3 normal = glm::vec3(0.0f);
+		float area = 0.0f;
+		for (size_t tri = clusters[ix]; tri < clusters[ix + 1]; tri++) {
+			float triArea = glm::length(triNormals[tri]);
+			center += triCenters[tri] * triArea;
+			normal += triNormals[tri];
+			area += triArea;
+		}
+		center = area > 0.0f ? center / area : center;
+		float normalLength = glm::length(normal);
+
+		sorted[ix].Start = clusters[ix];
+		sorted[ix].End = clusters[ix + 1];
+		sorted[ix].Key = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const ClusterSort& a, const ClusterSort& b) {
+		return a.Key > b.Key;
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(triCount * 3);
+	for (const ClusterSort& cluster : sorted) {
+		output.insert(output.end(), indices + cluster.Start * 3, indices + cluster.End * 3);
+	}
+	memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(void* vertices, uint32_t* indices, size_t indexCount, size_t vertexCount, size_t stride) {
+	if (!ValidateIndices(indices, indexCount, vertexCount)) {
+		return vertexCount;
+	}
+
+	// Number vertices in the order they are first referenced
+	constexpr uint32_t UNUSED = ~0u;
+	std::vector<uint32_t> remap(vertexCount, UNUSED);
+	uint32_t nextVertex = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& mapped = remap[indices[ix]];
+		if (mapped == UNUSED) {
+			mapped = nextVertex++;
+		}
+		indices[ix] = mapped;
+	}
+
+	uint8_t* bytes = static_cast<uint8_t*>(vertices);
+	std::vector<uint8_t> reordered(static_cast<size_t>(nextVertex) * stride);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		if (remap[ix] != UNUSED) {
+			memcpy(reordered.data() + remap[ix] * stride, bytes + ix * stride, stride);
+		}
+	}
+	memcpy(bytes, reordered.data(), reordered.size());
+
+	return nextVertex;
+}
+
+size_t MeshOptimizer::Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t stride, size_t positionOffset,
+							   size_t targetIndexCount, float targetError, float* resultError)
+{
+	const size_t triCount = indexCount / 3;
+	if (resultError != nullptr) {
+		*resultError = 0.0f;
+	}
+	if (triCount == 0 || !ValidateIndices(indices, indexCount, vertexCount)) {
+		memcpy(destination, indices, indexCount * sizeof(uint32_t));
+		return indexCount;
+	}
+
+	// Load the positions, scaling them so that errors are relative to the size of the mesh
+	const uint8_t* bytes = static_cast<const uint8_t*>(vertices);
+	std::vector<glm::vec3> positions(vertexCount);
+	glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		memcpy(&positions[ix], bytes + ix * stride + positionOffset, sizeof(glm::vec3));
+		boundsMin = glm::min(boundsMin, positions[ix]);
+		boundsMax = glm::max(boundsMax, positions[ix]);
+	}
+	glm::vec3 size = boundsMax - boundsMin;
+	float extent = glm::max(size.x, glm::max(size.y, size.z));
+	float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+	for (glm::vec3& position : positions) {
+		position = (position - boundsMin) * scale;
+	}
+
+	// Vertices that share a position are the same point on the surface with different attributes. Every
+	// vertex gets mapped to the first vertex with the same position
+	std::vector<uint32_t> sorted(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		sorted[ix] = static_cast<uint32_t>(ix);
+	}
+	std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+		const glm::vec3& pa = positions[a];
+		const glm::vec3& pb = positions[b];
+		return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z != pb.z ? pa.z < pb.z : a < b;
+	});
+	std::vector<uint32_t> canonical(vertexCount);
+	std::vector<bool> locked(vertexCount, false);
+	for (size_t ix = 0; ix < vertexCount;) {
+		size_t end = ix + 1;
+		while (end < vertexCount && positions[sorted[end]] == positions[sorted[ix]]) {
+			end++;
+		}
+		for (size_t jx = ix; jx < end; jx++) {
+			canonical[sorted[jx]] = sorted[ix];
+			// Seams can't be collapsed without breaking the attributes on one side, so we leave them alone
+			locked[sorted[jx]] = end - ix > 1;
+		}
+		ix = end;
+	}
+
+	// Edges that don't have exactly 2 triangles are on the border of the mesh (or non-manifold), so we lock those too
+	{
+		std::vector<uint64_t> edges;
+		edges.reserve(triCount * 3);
+		for (size_t tri = 0; tri < triCount; tri++) {
+			for (int ix = 0; ix < 3; ix++) {
+				uint32_t a = canonical[indices[tri * 3 + ix]];
+				uint32_t b = canonical[indices[tri * 3 + (ix + 1) % 3]];
+				if (a != b) {
+					edges.push_back(a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a);
+				}
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		for (size_t ix = 0; ix < edges.size();) {
+			size_t end = ix + 1;
+			while (end < edges.size() && edges[end] == edges[ix]) {
+				end++;
+			}
+			if (end - ix != 2) {
+				locked[static_cast<uint32_t>(edges[ix] >> 32)] = true;
+				locked[static_cast<uint32_t>(edges[ix])] = true;
+			}
+			ix = end;
+		}
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			if (locked[canonical[ix]]) {
+				locked[ix] = true;
+			}
+		}
+	}
+
+	// Every position gets the planes of all the triangles around it
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t tri = 0; tri < triCount; tri++) {
+		const uint32_t* triIndices = indices + tri * 3;
+		glm::vec3 p0 = positions[triIndices[0]];
+		glm::vec3 normal = glm::cross(positions[triIndices[1]] - p0, positions[triIndices[2]] - p0);
+		float length = glm::length(normal);
+		if (length > 0.0f) {
+			normal /= length;
+			for (int ix = 0; ix < 3; ix++) {
+				quadrics[canonical[triIndices[ix]]].AddPlane(normal, -glm::dot(normal, p0));
+			}
+		}
+	}
+
+	struct Collapse {
+		uint32_t From;
+		uint32_t To;
+		double   Cost;
+	};
+
+	std::vector<uint32_t> result(indices, indices + triCount * 3);
+	const double maxCost = static_cast<double>(targetError) * targetError;
+	double largestCost = 0.0;
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+
+	// Each pass collapses as many edges as it can without collapses interfering with each other
+	while (result.size() > targetIndexCount) {
+		size_t resultTris = result.size() / 3;
+
+		// Build the list of triangles around each vertex
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : result) {
+			adjacencyOffsets[index + 1]++;
+		}
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			adjacencyOffsets[ix + 1] += adjacencyOffsets[ix];
+		}
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t ix = 0; ix < result.size(); ix++) {
+				adjacency[fill[result[ix]]++] = static_cast<uint32_t>(ix / 3);
+			}
+		}
+
+		// Find the cost of collapsing every edge in both directions
+		collapses.clear();
+		for (size_t tri = 0; tri < resultTris; tri++) {
+			for (int ix = 0; ix < 3; ix++) {
+				uint32_t from = result[tri * 3 + ix];
+				uint32_t to = result[tri * 3 + (ix + 1) % 3];
+				for (int direction = 0; direction < 2; direction++) {
+					if (!locked[from] && canonical[from] != canonical[to]) {
+						Quadric quadric = quadrics[canonical[from]];
+						quadric += quadrics[canonical[to]];
+						collapses.push_back({ from, to, quadric.Evaluate(positions[to]) });
+					}
+					std::swap(from, to);
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+			return a.Cost < b.Cost;
+		});
+
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			remap[ix] = static_cast<uint32_t>(ix);
+		}
+		std::fill(touched.begin(), touched.end(), false);
+
+		size_t removedTris = 0;
+		size_t collapseCount = 0;
+		for (const Collapse& collapse : collapses) {
+			if (collapse.Cost > maxCost || resultTris - removedTris <= targetIndexCount / 3) {
+				break;
+			}
+			if (touched[canonical[collapse.From]] || touched[canonical[collapse.To]]) {
+				continue;
+			}
+
+			// Make sure none of the triangles that move would flip over
+			bool valid = true;
+			size_t collapsedTris = 0;
+			for (uint32_t jx = adjacencyOffsets[collapse.From]; jx < adjacencyOffsets[collapse.From + 1] && valid; jx++) {
+				const uint32_t* tri = result.data() + adjacency[jx] * 3;
+				if (canonical[tri[0]] == canonical[collapse.To] || canonical[tri[1]] == canonical[collapse.To] || canonical[tri[2]] == canonical[collapse.To]) {
+					collapsedTris++;
+					continue;
+				}
+
+				glm::vec3 points[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+				glm::vec3 before = glm::cross(points[1] - points[0], points[2] - points[0]);
+				for (int kx = 0; kx < 3; kx++) {
+					if (tri[kx] == collapse.From) {
+						points[kx] = positions[collapse.To];
+					}
+				}
+				glm::vec3 after = glm::cross(points[1] - points[0], points[2] - points[0]);
+				// We don't let triangles rotate too far in a single pass either, otherwise they can flip over a few passes
+				valid = glm::dot(before, after) > 0.25f * glm::length(before) * glm::length(after);
+			}
+			if (!valid) {
+				continue;
+			}
+
+			// Lock the whole neighbourhood for the rest of this pass, so the flip check above stays valid
+			for (uint32_t jx = adjacencyOffsets[collapse.From]; jx < adjacencyOffsets[collapse.From + 1]; jx++) {
+				const uint32_t* tri = result.data() + adjacency[jx] * 3;
+				touched[canonical[tri[0]]] = touched[canonical[tri[1]]] = touched[canonical[tri[2]]] = true;
+			}
+			touched[canonical[collapse.To]] = true;
+
+			remap[collapse.From] = collapse.To;
+			quadrics[canonical[collapse.To]] += quadrics[canonical[collapse.From]];
+			largestCost = std::max(largestCost, collapse.Cost);
+			removedTris += collapsedTris;
+			collapseCount++;
+		}
+
+		if (collapseCount == 0) {
+			break;
+		}
+
+		// Apply the collapses and throw out any triangles that have become degenerate
+		size_t writeIx = 0;
+		for (size_t tri = 0; tri < resultTris; tri++) {
+			uint32_t a = remap[result[tri * 3 + 0]];
+			uint32_t b = remap[result[tri * 3 + 1]];
+			uint32_t c = remap[result[tri * 3 + 2]];
+			if (canonical[a] != canonical[b] && canonical[b] != canonical[c] && canonical[a] != canonical[c]) {
+				result[writeIx++] = a;
+				result[writeIx++] = b;
+				result[writeIx++] = c;
+			}
+		}
+		result.resize(writeIx);
+	}
+
+	if (resultError != nullptr) {
+		*resultError = static_cast<float>(sqrt(largestCost));
+	}
+	memcpy(destination, result.data(), result.size() * sizeof(uint32_t));
+	return result.size();
+}
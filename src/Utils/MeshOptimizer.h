@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Reorders triangles and vertices so meshes make better use of the GPU. Meshes should be run through
+/// OptimizeVertexCache, then OptimizeOverdraw, then OptimizeVertexFetch, since each step relies on the
+/// order produced by the one before it
+/// </summary>
+class MeshOptimizer {
+public:
+	/// <summary>
+	/// Statistics about how well a mesh uses the post-transform vertex cache
+	/// </summary>
+	struct VertexCacheStats {
+		// Average cache miss ratio, the number of vertices transformed per triangle. 0.5 is ideal for large grids, 3 is the worst case
+		float ACMR = 0.0f;
+		// Average transform to vertex ratio, the number of times each vertex is transformed. 1 is ideal
+		float ATVR = 0.0f;
+	};
+
+	/// <summary>
+	/// Simulates a FIFO vertex cache to measure how many vertices a mesh will transform
+	/// </summary>
+	/// <param name="indices">The triangle list indices</param>
+	/// <param name="indexCount">The number of indices, should be a multiple of 3</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	/// <param name="cacheSize">The number of vertices to keep in the simulated cache</param>
+	static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+	/// <summary>
+	/// Reorders triangles to reduce the number of vertices that need to be transformed, using Tom Forsyth's
+	/// linear-speed vertex cache optimization. Works well without knowing the actual size of the GPU's cache
+	/// </summary>
+	/// <param name="indices">The triangle list indices, will be reordered in place</param>
+	/// <param name="indexCount">The number of indices, should be a multiple of 3</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Reorders triangles to reduce overdraw while keeping most of the vertex cache efficiency. Triangles
+	/// are split into clusters wherever the cache would be flushed anyways, then clusters that face away
+	/// from the center of the mesh are drawn first, so they are more likely to occlude the rest of the mesh
+	/// </summary>
+	/// <param name="indices">The triangle list indices, should already be optimized with OptimizeVertexCache</param>
+	/// <param name="indexCount">The number of indices, should be a multiple of 3</param>
+	/// <param name="vertices">The vertex data</param>
+	/// <param name="vertexCount">The number of vertices in vertices</param>
+	/// <param name="stride">The size of a single vertex in bytes</param>
+	/// <param name="positionOffset">The byte offset of the float3 position in each vertex</param>
+	/// <param name="threshold">How much worse than the original ACMR each cluster can get, 1.05 allows 5% more vertex transforms</param>
+	static void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t stride, size_t positionOffset, float threshold = 1.05f);
+
+	/// <summary>
+	/// Reorders vertices into the order they are first used by the indices, so vertex fetches walk
+	/// through memory linearly. Vertices that are not referenced by any index are removed
+	/// </summary>
+	/// <param name="vertices">The vertex data, will be reordered in place</param>
+	/// <param name="indices">The triangle list indices, will be remapped in place</param>
+	/// <param name="indexCount">The number of indices</param>
+	/// <param name="vertexCount">The number of vertices in vertices</param>
+	/// <param name="stride">The size of a single vertex in bytes</param>
+	/// <returns>The number of vertices remaining, the rest of the vertex data can be discarded</returns>
+	static size_t OptimizeVertexFetch(void* vertices, uint32_t* indices, size_t indexCount, size_t vertexCount, size_t stride);
+
+	/// <summary>
+	/// Reduces the number of triangles in a mesh by collapsing edges, picking the collapses that move the surface
+	/// the least using quadric error metrics. Vertices are only ever moved onto other existing vertices, so the
+	/// simplified indices can keep using the original vertex buffer. Vertices on open borders and attribute seams
+	/// (such as UV or hard normal splits) are never moved, so the outline and texturing of the mesh are preserved
+	/// </summary>
+	/// <param name="destination">Receives the simplified indices, must have room for indexCount indices</param>
+	/// <param name="indices">The triangle list indices to simplify</param>
+	/// <param name="indexCount">The number of indices, should be a multiple of 3</param>
+	/// <param name="vertices">The vertex data</param>
+	/// <param name="vertexCount">The number of vertices in vertices</param>
+	/// <param name="stride">The size of a single vertex in bytes</param>
+	/// <param name="positionOffset">The byte offset of the float3 position in each vertex</param>
+	/// <param name="targetIndexCount">The number of indices to try and reduce the mesh to</param>
+	/// <param name="targetError">The maximum error allowed, relative to the largest dimension of the mesh (ex: 0.01 is 1%)</param>
+	/// <param name="resultError">If not null, receives the largest error of any collapse, relative to the size of the mesh</param>
+	/// <returns>The number of indices written to destination</returns>
+	static size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t stride, size_t positionOffset,
+						   size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+protected:
+	MeshOptimizer() = default;
+	~MeshOptimizer() = default;
+};
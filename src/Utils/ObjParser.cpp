@@ -0,0 +1,466 @@
+#include "Utils/ObjParser.h"
+
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <thread>
+#include <chrono>
+#include <limits>
+
+#include "Utils/MappedFile.h"
+#include "Logging.h"
+
+namespace {
+	inline bool IsSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* SkipSpace(const char* it, const char* end) {
+		while (it < end && IsSpace(*it)) {
+			it++;
+		}
+		return it;
+	}
+
+	inline const char* SkipToken(const char* it, const char* end) {
+		while (it < end && !IsSpace(*it)) {
+			it++;
+		}
+		return it;
+	}
+
+	/// <summary>
+	/// Parses a float, skipping leading whitespace. Malformed numbers are read as 0 and skipped
+	/// </summary>
+	inline const char* ParseFloat(const char* it, const char* end, float& result) {
+		it = SkipSpace(it, end);
+		// from_chars doesn't accept a leading +
+		if (it < end && *it == '+') {
+			it++;
+		}
+		std::from_chars_result parsed = std::from_chars(it, end, result);
+		if (parsed.ec != std::errc()) {
+			result = 0.0f;
+			return SkipToken(it, end);
+		}
+		return parsed.ptr;
+	}
+
+	/// <summary>
+	/// Parses a (possibly negative) integer, returns false if there was no number at the current position
+	/// </summary>
+	inline bool ParseInt(const char*& it, const char* end, int& result) {
+		std::from_chars_result parsed = std::from_chars(it, end, result);
+		if (parsed.ec != std::errc()) {
+			return false;
+		}
+		it = parsed.ptr;
+		return true;
+	}
+
+	/// <summary>
+	/// Converts a 1 based OBJ index to a 0 based index, negative indices are relative to the
+	/// number of attributes read so far in the chunk and set the given bit in relativeMask.
+	/// Missing indices (0) become -1
+	/// </summary>
+	inline int ResolveIndex(int index, size_t count, uint8_t bit, uint8_t& relativeMask) {
+		if (index > 0) {
+			return index - 1;
+		} else if (index < 0) {
+			relativeMask |= bit;
+			return static_cast<int>(count) + index;
+		}
+		return -1;
+	}
+
+	// Files smaller than this per thread aren't worth splitting up
+	constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+	// Bits in a corner's relative mask
+	constexpr uint8_t RELATIVE_POSITION = 1 << 0;
+	constexpr uint8_t RELATIVE_UV       = 1 << 1;
+	constexpr uint8_t RELATIVE_NORMAL   = 1 << 2;
+
+	/// <summary>
+	/// The records parsed from a line-aligned range of the file
+	/// </summary>
+	struct ParsedChunk {
+		const char* Begin;
+		const char* End;
+
+		std::vector<glm::vec3>  Positions;
+		std::vector<glm::vec2>  UVs;
+		std::vector<glm::vec3>  Normals;
+		// Face corners as 0 based indices, relative indices are only resolved within the chunk until
+		// we know how many attributes came before it
+		std::vector<glm::ivec3> Corners;
+		std::vector<uint8_t>    RelativeMasks;
+		// The number of corners in each face
+		std::vector<uint32_t>   FaceSizes;
+
+		// Where this chunk's data starts in the merged results
+		glm::uvec3 AttributeOffset;
+		size_t     CornerOffset;
+		size_t     CornerCount;
+		size_t     IndexOffset;
+		size_t     IndexCount;
+	};
+
+	/// <summary>
+	/// Parses all of the records in a chunk into the chunk's own buffers
+	/// </summary>
+	void ParseChunk(ParsedChunk& chunk) {
+		// Rough guesses so the buffers don't have to grow as often, based on typical line lengths
+		size_t size = chunk.End - chunk.Begin;
+		chunk.Positions.reserve(size / 128);
+		chunk.Corners.reserve(size / 16);
+		chunk.RelativeMasks.reserve(size / 16);
+		chunk.FaceSizes.reserve(size / 64);
+
+		const char* it = chunk.Begin;
+		const char* chunkEnd = chunk.End;
+
+		while (it < chunkEnd) {
+			// Find the end of the line, we treat \r as whitespace so CRLF files work as well
+			const char* end = static_cast<const char*>(memchr(it, '\n', chunkEnd - it));
+			if (end == nullptr) {
+				end = chunkEnd;
+			}
+
+			it = SkipSpace(it, end);
+			if (it < end) {
+				// We only care about the first 2 characters of the command, and whether it's followed by whitespace
+				char c0 = it[0];
+				char c1 = it + 1 < end ? it[1] : ' ';
+				char c2 = it + 2 < end ? it[2] : ' ';
+
+				// The v command defines a vertex's position
+				if (c0 == 'v' && IsSpace(c1)) {
+					glm::vec3& position = chunk.Positions.emplace_back();
+					const char* seek = ParseFloat(it + 1, end, position.x);
+					seek = ParseFloat(seek, end, position.y);
+					ParseFloat(seek, end, position.z);
+				}
+				else if (c0 == 'v' && c1 == 'n' && IsSpace(c2)) {
+					glm::vec3& normal = chunk.Normals.emplace_back();
+					const char* seek = ParseFloat(it + 2, end, normal.x);
+					seek = ParseFloat(seek, end, normal.y);
+					ParseFloat(seek, end, normal.z);
+				}
+				else if (c0 == 'v' && c1 == 't' && IsSpace(c2)) {
+					glm::vec2& uv = chunk.UVs.emplace_back();
+					const char* seek = ParseFloat(it + 2, end, uv.x);
+					ParseFloat(seek, end, uv.y);
+				}
+				// The f command defines a polygon in the mesh, each corner is v, v/vt, v//vn or v/vt/vn
+				else if (c0 == 'f' && IsSpace(c1)) {
+					uint32_t faceSize = 0;
+					const char* seek = it + 1;
+					while (true) {
+						seek = SkipSpace(seek, end);
+						if (seek >= end) {
+							break;
+						}
+
+						int position = 0, uv = 0, normal = 0;
+						if (!ParseInt(seek, end, position)) {
+							LOG_WARN("Malformed face in OBJ data, skipping the rest of the face");
+							break;
+						}
+						if (seek < end && *seek == '/') {
+							seek++;
+							ParseInt(seek, end, uv);
+							if (seek < end && *seek == '/') {
+								seek++;
+								ParseInt(seek, end, normal);
+							}
+						}
+
+						uint8_t relativeMask = 0;
+						chunk.Corners.emplace_back(
+							ResolveIndex(position, chunk.Positions.size(), RELATIVE_POSITION, relativeMask),
+							ResolveIndex(uv, chunk.UVs.size(), RELATIVE_UV, relativeMask),
+							ResolveIndex(normal, chunk.Normals.size(), RELATIVE_NORMAL, relativeMask)
+						);
+						chunk.RelativeMasks.push_back(relativeMask);
+						faceSize++;
+
+						seek = SkipToken(seek, end);
+					}
+					chunk.FaceSizes.push_back(faceSize);
+				}
+				// Comments, groups, materials and anything else we don't support are skipped
+			}
+
+			it = end + 1;
+		}
+	}
+
+	/// <summary>
+	/// Hashes the full attribute index triple of a corner
+	/// </summary>
+	inline uint64_t HashCorner(const glm::ivec3& corner) {
+		uint64_t hash = static_cast<uint32_t>(corner.x);
+		hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(corner.y);
+		hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(corner.z);
+		// Final mix so that both the high and low bits depend on all 3 indices
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/// <summary>
+	/// A flat, linear probing hash table from corner attributes to the first corner that used them. All
+	/// the slots live in one allocation, so inserting doesn't allocate unless the table needs to grow
+	/// </summary>
+	class CornerTable {
+	public:
+		CornerTable(size_t expectedCount) :
+			_slots(),
+			_mask(0),
+			_count(0)
+		{
+			// Keep the load factor under 1/2 for the expected number of entries
+			size_t capacity = 16;
+			while (capacity < expectedCount * 2) {
+				capacity <<= 1;
+			}
+			_slots.resize(capacity);
+			_mask = capacity - 1;
+		}
+
+		/// <summary>
+		/// Gets the value for the given corner, inserting cornerIndex if it's not in the table yet
+		/// </summary>
+		uint32_t FindOrInsert(const glm::ivec3& corner, uint64_t hash, uint32_t cornerIndex) {
+			if ((_count + 1) * 4 > _slots.size() * 3) {
+				_Grow();
+			}
+
+			size_t ix = hash & _mask;
+			while (true) {
+				Slot& slot = _slots[ix];
+				if (slot.Value == EMPTY) {
+					slot.Key = corner;
+					slot.Value = cornerIndex;
+					_count++;
+					return cornerIndex;
+				}
+				if (slot.Key == corner) {
+					return slot.Value;
+				}
+				ix = (ix + 1) & _mask;
+			}
+		}
+
+	protected:
+		static constexpr uint32_t EMPTY = UINT32_MAX;
+
+		struct Slot {
+			glm::ivec3 Key   = glm::ivec3(0);
+			uint32_t   Value = EMPTY;
+		};
+
+		std::vector<Slot> _slots;
+		size_t            _mask;
+		size_t            _count;
+
+		void _Grow() {
+			std::vector<Slot> old = std::move(_slots);
+			_slots = std::vector<Slot>(old.size() * 2);
+			_mask = _slots.size() - 1;
+			for (const Slot& slot : old) {
+				if (slot.Value != EMPTY) {
+					size_t ix = HashCorner(slot.Key) & _mask;
+					while (_slots[ix].Value != EMPTY) {
+						ix = (ix + 1) & _mask;
+					}
+					_slots[ix] = slot;
+				}
+			}
+		}
+	};
+}
+
+bool ObjParser::ParseFile(const std::string& filename, ObjMeshData& result, uint32_t threadCount) {
+	MappedFile file(filename);
+	if (!file.IsOpen()) {
+		return false;
+	}
+	Parse(file.GetData(), file.GetSize(), result, threadCount);
+	return true;
+}
+
+void ObjParser::Parse(const char* data, size_t size, ObjMeshData& result, uint32_t threadCount) {
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// Split the file into line-aligned chunks, one per thread
+	size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, size / MIN_CHUNK_SIZE));
+	std::vector<ParsedChunk> chunks(chunkCount);
+	const char* fileEnd = data + size;
+	const char* chunkStart = data;
+	for (size_t ix = 0; ix < chunkCount; ix++) {
+		const char* chunkEnd = fileEnd;
+		if (ix + 1 < chunkCount) {
+			chunkEnd = std::max(chunkStart, data + (size * (ix + 1)) / chunkCount);
+			const char* newline = static_cast<const char*>(memchr(chunkEnd, '\n', fileEnd - chunkEnd));
+			chunkEnd = newline != nullptr ? newline + 1 : fileEnd;
+		}
+		chunks[ix].Begin = chunkStart;
+		chunks[ix].End = chunkEnd;
+		chunkStart = chunkEnd;
+	}
+
+	// Parse all of the chunks at once
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), ParseChunk);
+
+	// Prefix sum over the attribute, corner and index counts, so each chunk knows where it's data goes.
+	// This is done in file order, so the results are the same no matter how many chunks there are
+	glm::uvec3 attributeCount = glm::uvec3(0);
+	size_t cornerCount = 0;
+	size_t indexCount = 0;
+	for (ParsedChunk& chunk : chunks) {
+		chunk.AttributeOffset = attributeCount;
+		chunk.CornerOffset = cornerCount;
+		chunk.CornerCount = chunk.Corners.size();
+		chunk.IndexOffset = indexCount;
+		chunk.IndexCount = 0;
+		for (uint32_t faceSize : chunk.FaceSizes) {
+			chunk.IndexCount += faceSize > 2 ? (faceSize - 2) * 3 : 0;
+		}
+
+		attributeCount += glm::uvec3(chunk.Positions.size(), chunk.UVs.size(), chunk.Normals.size());
+		cornerCount += chunk.Corners.size();
+		indexCount += chunk.IndexCount;
+	}
+
+	// Merge the attributes, and move relative corners into the global index space
+	result.Positions.resize(attributeCount.x);
+	result.UVs.resize(attributeCount.y);
+	result.Normals.resize(attributeCount.z);
+	std::vector<glm::ivec3> corners(cornerCount);
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](ParsedChunk& chunk) {
+		std::copy(chunk.Positions.begin(), chunk.Positions.end(), result.Positions.begin() + chunk.AttributeOffset.x);
+		std::copy(chunk.UVs.begin(), chunk.UVs.end(), result.UVs.begin() + chunk.AttributeOffset.y);
+		std::copy(chunk.Normals.begin(), chunk.Normals.end(), result.Normals.begin() + chunk.AttributeOffset.z);
+
+		glm::ivec3 offset = glm::ivec3(chunk.AttributeOffset);
+		for (size_t ix = 0; ix < chunk.Corners.size(); ix++) {
+			glm::ivec3 corner = chunk.Corners[ix];
+			uint8_t mask = chunk.RelativeMasks[ix];
+			if (mask & RELATIVE_POSITION) { corner.x += offset.x; }
+			if (mask & RELATIVE_UV)       { corner.y += offset.y; }
+			if (mask & RELATIVE_NORMAL)   { corner.z += offset.z; }
+			corners[chunk.CornerOffset + ix] = corner;
+		}
+
+		// Free the chunk's copies as we go, large files can have a lot of data
+		chunk.Positions = std::vector<glm::vec3>();
+		chunk.UVs = std::vector<glm::vec2>();
+		chunk.Normals = std::vector<glm::vec3>();
+		chunk.Corners = std::vector<glm::ivec3>();
+		chunk.RelativeMasks = std::vector<uint8_t>();
+	});
+
+	// Deduplicate corners. The key space is split into shards that are processed in parallel, each shard
+	// walks the corners in file order and records the first corner with each key
+	uint32_t shardCount = static_cast<uint32_t>(std::min<size_t>(chunkCount, UINT8_MAX));
+	std::vector<uint64_t> cornerHashes(cornerCount);
+	std::vector<uint8_t> cornerShards(cornerCount);
+	std::vector<uint32_t> firstCorner(cornerCount);
+	std::vector<size_t> shardSizes(chunkCount * shardCount, 0);
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const ParsedChunk& chunk) {
+		size_t* sizes = shardSizes.data() + (&chunk - chunks.data()) * shardCount;
+		for (size_t ix = chunk.CornerOffset; ix < chunk.CornerOffset + chunk.CornerCount; ix++) {
+			// The table uses the low bits of the hash, so pick the shard with the high bits
+			uint64_t hash = HashCorner(corners[ix]);
+			uint8_t shard = static_cast<uint8_t>((hash >> 32) % shardCount);
+			cornerHashes[ix] = hash;
+			cornerShards[ix] = shard;
+			sizes[shard]++;
+		}
+	});
+
+	std::vector<uint32_t> shards(shardCount);
+	std::iota(shards.begin(), shards.end(), 0);
+	std::for_each(std::execution::par, shards.begin(), shards.end(), [&](uint32_t shard) {
+		// Most meshes share each vertex between several faces, so we expect roughly one unique vertex per
+		// face, which is about a third of the corners. The table grows if the mesh has more than that
+		size_t shardCorners = 0;
+		for (size_t ix = 0; ix < chunkCount; ix++) {
+			shardCorners += shardSizes[ix * shardCount + shard];
+		}
+		CornerTable table(shardCorners / 3);
+		for (size_t ix = 0; ix < cornerCount; ix++) {
+			if (cornerShards[ix] == shard) {
+				firstCorner[ix] = table.FindOrInsert(corners[ix], cornerHashes[ix], static_cast<uint32_t>(ix));
+			}
+		}
+	});
+
+	// Number the vertices in order of first use, this is what a serial parse would produce. A corner's first
+	// use is always before it, so we can overwrite firstCorner with vertex indices as we go
+	result.Vertices.clear();
+	result.Vertices.reserve(cornerCount / 4);
+	for (size_t ix = 0; ix < cornerCount; ix++) {
+		if (firstCorner[ix] == ix) {
+			firstCorner[ix] = static_cast<uint32_t>(result.Vertices.size());
+			result.Vertices.push_back(corners[ix]);
+		} else {
+			firstCorner[ix] = firstCorner[firstCorner[ix]];
+		}
+	}
+
+	// Triangulate the polygons as fans, this matches how quads were split before
+	result.Indices.resize(indexCount);
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const ParsedChunk& chunk) {
+		size_t corner = chunk.CornerOffset;
+		size_t index = chunk.IndexOffset;
+		for (uint32_t faceSize : chunk.FaceSizes) {
+			for (uint32_t ix = 2; ix < faceSize; ix++) {
+				result.Indices[index++] = firstCorner[corner];
+				result.Indices[index++] = firstCorner[corner + ix - 1];
+				result.Indices[index++] = firstCorner[corner + ix];
+			}
+			corner += faceSize;
+		}
+	});
+}
+
+int ObjParser::Benchmark(const std::vector<std::string>& filenames, uint32_t iterations, uint32_t threadCount) {
+	int failures = 0;
+	iterations = std::max(1u, iterations);
+	for (const std::string& filename : filenames) {
+		ObjMeshData data;
+		// Parse once up front so the file is in the OS cache, otherwise the first run is mostly disk time
+		if (!ParseFile(filename, data, threadCount)) {
+			LOG_WARN("Failed to open \"{}\" for benchmarking", filename);
+			failures++;
+			continue;
+		}
+		size_t fileSize = MappedFile(filename).GetSize();
+
+		double fastest = std::numeric_limits<double>::max();
+		double total = 0.0;
+		for (uint32_t ix = 0; ix < iterations; ix++) {
+			data = ObjMeshData();
+			auto startTime = std::chrono::high_resolution_clock::now();
+			ParseFile(filename, data, threadCount);
+			auto endTime = std::chrono::high_resolution_clock::now();
+
+			double ms = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+			fastest = std::min(fastest, ms);
+			total += ms;
+		}
+
+		LOG_INFO("Parsed \"{}\" ({} KB, {} vertices, {} indices) in {:.3f} ms best, {:.3f} ms average over {} runs ({:.1f} MB/s)",
+			filename, fileSize / 1024, data.Vertices.size(), data.Indices.size(), fastest, total / iterations, iterations,
+			(fileSize / (1024.0 * 1024.0)) / (fastest / 1000.0));
+	}
+	return failures;
+}
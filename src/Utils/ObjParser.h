@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Utils/MeshBuilder.h"
+#include "Graphics/VertexParamMap.h"
+
+/// <summary>
+/// The attributes and faces read from an OBJ file, before they are turned into vertices
+/// </summary>
+struct ObjMeshData {
+	std::vector<glm::vec3>  Positions;
+	std::vector<glm::vec2>  UVs;
+	std::vector<glm::vec3>  Normals;
+	// Unique combinations of attribute indices (position, uv, normal), 0 based with -1 for missing attributes
+	std::vector<glm::ivec3> Vertices;
+	// Indices into Vertices, polygons are triangulated as fans
+	std::vector<uint32_t>   Indices;
+};
+
+/// <summary>
+/// Parses OBJ files straight out of a memory mapped file, without going through iostreams
+/// or allocating per line. Handles v, vt, vn and f records (with any polygon size, and
+/// v, v/vt, v//vn and v/vt/vn face formats), everything else is skipped
+///
+/// Large files are split into line-aligned chunks that are parsed in parallel, then merged
+/// in file order, so the results are identical no matter how many threads are used
+/// </summary>
+class ObjParser {
+public:
+	/// <summary>
+	/// Parses an OBJ file from disk
+	/// </summary>
+	/// <param name="filename">The path to the OBJ file</param>
+	/// <param name="result">Receives the parsed mesh data</param>
+	/// <param name="threadCount">The maximum number of chunks to parse at once, or 0 to use all hardware threads</param>
+	/// <returns>False if the file could not be opened</returns>
+	static bool ParseFile(const std::string& filename, ObjMeshData& result, uint32_t threadCount = 0);
+	/// <summary>
+	/// Parses OBJ text from memory
+	/// </summary>
+	/// <param name="data">The start of the OBJ text, does not need to be null terminated</param>
+	/// <param name="size">The size of the text in bytes</param>
+	/// <param name="result">Receives the parsed mesh data</param>
+	/// <param name="threadCount">The maximum number of chunks to parse at once, or 0 to use all hardware threads</param>
+	static void Parse(const char* data, size_t size, ObjMeshData& result, uint32_t threadCount = 0);
+
+	/// <summary>
+	/// Times ParseFile on each of the given files and logs the fastest and average times, so that
+	/// changes to the parser can be compared. Run with --bench-obj from the command line
+	/// </summary>
+	/// <param name="filenames">The OBJ files to parse</param>
+	/// <param name="iterations">How many times to parse each file</param>
+	/// <param name="threadCount">The maximum number of chunks to parse at once, or 0 to use all hardware threads</param>
+	/// <returns>The number of files that could not be opened</returns>
+	static int Benchmark(const std::vector<std::string>& filenames, uint32_t iterations = 20, uint32_t threadCount = 0);
+
+	/// <summary>
+	/// Adds the vertices and indices from parsed OBJ data to a mesh builder
+	/// </summary>
+	/// <param name="data">The data parsed from an OBJ file</param>
+	/// <param name="mesh">The mesh to add the geometry to</param>
+	/// <param name="color">The color to give all vertices</param>
+	template <typename VertexType>
+	static void BuildMesh(const ObjMeshData& data, MeshBuilder<VertexType>& mesh, const glm::vec4& color = glm::vec4(1.0f));
+
+protected:
+	ObjParser() = default;
+	~ObjParser() = default;
+};
+
+template <typename VertexType>
+void ObjParser::BuildMesh(const ObjMeshData& data, MeshBuilder<VertexType>& mesh, const glm::vec4& color) {
+	// We'll use a vertex param mapper for our attributes
+	VertexParamMap vMap = VertexParamMap(VertexType::V_DECL);
+
+	mesh.ReserveVertexSpace(data.Vertices.size());
+	for (const glm::ivec3& vertexIndices : data.Vertices) {
+		// Construct a new vertex using the indices for the vertex, indices that are missing or out of range get defaults
+		VertexType vertex;
+		bool hasPosition = vertexIndices.x >= 0 && vertexIndices.x < (int)data.Positions.size();
+		bool hasUv       = vertexIndices.y >= 0 && vertexIndices.y < (int)data.UVs.size();
+		bool hasNormal   = vertexIndices.z >= 0 && vertexIndices.z < (int)data.Normals.size();
+		vMap.SetPosition(vertex, hasPosition ? data.Positions[vertexIndices.x] : glm::vec3(0.0f));
+		vMap.SetTexture(vertex,  hasUv       ? data.UVs[vertexIndices.y]       : glm::vec2(0.0f));
+		vMap.SetNormal(vertex,   hasNormal   ? data.Normals[vertexIndices.z]   : glm::vec3(0.0f, 0.0f, 1.0f));
+		vMap.SetColor(vertex, color);
+
+		mesh.AddVertex(vertex);
+	}
+
+	mesh.ReserveIndexSpace(data.Indices.size());
+	for (uint32_t ix : data.Indices) {
+		mesh.AddIndex(ix);
+	}
+}
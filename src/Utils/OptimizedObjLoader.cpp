@@ -1,15 +1,23 @@
 #include "Utils/OptimizedObjLoader.h"
 
 #include "ObjLoader.h"
+#include "Utils/ObjParser.h"
 
 #include <string>
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <limits>
+#include <chrono>
 
 #include "Utils/StringUtils.h"
-#include "GLFW/glfw3.h"
+#include "Utils/MappedFile.h"
+#include "Utils/MeshCompression.h"
+#include "Utils/HashedString.h"
 #include "Logging.h"
 
 const char HEADER_BYTES[4] = { 'B', 'O', 'B', 'J' };
@@ -17,7 +25,198 @@ const std::string binaryExtension = ".bin";
 
 namespace fs = std::filesystem;
 
-VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename) {
+namespace {
+	/// <summary>
+	/// How a single vertex attribute is stored in a quantized vertex
+	/// </summary>
+	enum class AttributeEncoding {
+		Raw,
+		Octahedral,
+		Half,
+		Unorm8
+	};
+
+	struct QuantizedAttribute {
+		AttributeEncoding Encoding;
+		// Where the attribute is in the full vertex
+		uint32_t SourceOffset;
+		// Where the attribute is in the quantized vertex
+		uint32_t Offset;
+		uint32_t Size;
+	};
+
+	inline uint32_t GetAttributeTypeSize(AttributeType type) {
+		switch (type) {
+			case AttributeType::Byte:
+			case AttributeType::UByte:  return 1;
+			case AttributeType::Short:
+			case AttributeType::UShort: return 2;
+			case AttributeType::Int:
+			case AttributeType::UInt:
+			case AttributeType::Float:  return 4;
+			case AttributeType::Double: return 8;
+			// Packed types always have 4 components in 4 bytes
+			case AttributeType::Int2_10_10_10: return 1;
+			default:                    return 0;
+		}
+	}
+
+	/// <summary>
+	/// Works out how each attribute in a vertex declaration is stored when vertices are quantized
+	/// </summary>
+	/// <returns>The size of a quantized vertex in bytes</returns>
+	uint32_t GetQuantizedLayout(const VertexArrayObject::VertexDeclaration& vDecl, std::vector<QuantizedAttribute>& layout) {
+		uint32_t stride = 0;
+		for (const BufferAttribute& attrib : vDecl) {
+			QuantizedAttribute result;
+			result.Encoding = AttributeEncoding::Raw;
+			result.SourceOffset = attrib.Offset;
+			result.Offset = stride;
+			result.Size = attrib.Size * GetAttributeTypeSize(attrib.Type);
+
+			if (attrib.Type == AttributeType::Float) {
+				switch (attrib.Usage) {
+					case AttribUsage::Normal:
+					case AttribUsage::Tangent:
+					case AttribUsage::BiTangent:
+						if (attrib.Size == 3) { result.Encoding = AttributeEncoding::Octahedral; }
+						break;
+					case AttribUsage::Texture:
+					case AttribUsage::Texture1:
+					case AttribUsage::Texture2:
+					case AttribUsage::Texture3:
+						if (attrib.Size == 2) { result.Encoding = AttributeEncoding::Half; }
+						break;
+					case AttribUsage::Color:
+					case AttribUsage::Color1:
+					case AttribUsage::Color2:
+					case AttribUsage::Color3:
+						if (attrib.Size == 4) { result.Encoding = AttributeEncoding::Unorm8; }
+						break;
+					default:
+						break;
+				}
+			}
+			// All of our quantized formats pack into 4 bytes
+			if (result.Encoding != AttributeEncoding::Raw) {
+				result.Size = 4;
+			}
+
+			stride += result.Size;
+			layout.push_back(result);
+		}
+		return stride;
+	}
+
+	void QuantizeVertex(const uint8_t* vertex, uint8_t* output, const std::vector<QuantizedAttribute>& layout) {
+		for (const QuantizedAttribute& attrib : layout) {
+			const float* values = reinterpret_cast<const float*>(vertex + attrib.SourceOffset);
+			uint32_t packed = 0;
+			switch (attrib.Encoding) {
+				case AttributeEncoding::Octahedral:
+					packed = MeshCompression::EncodeOctahedral(glm::vec3(values[0], values[1], values[2]));
+					break;
+				case AttributeEncoding::Half:
+					packed = glm::packHalf2x16(glm::vec2(values[0], values[1]));
+					break;
+				case AttributeEncoding::Unorm8:
+					packed = glm::packUnorm4x8(glm::vec4(values[0], values[1], values[2], values[3]));
+					break;
+				case AttributeEncoding::Raw:
+				default:
+					memcpy(output + attrib.Offset, vertex + attrib.SourceOffset, attrib.Size);
+					continue;
+			}
+			memcpy(output + attrib.Offset, &packed, sizeof(uint32_t));
+		}
+	}
+
+	/// <summary>
+	/// Creates an index buffer and decodes indices into it, using 16 bit indices if the mesh is small enough
+	/// </summary>
+	/// <param name="cpuCopy">If not null, receives a copy of the decoded indices</param>
+	/// <returns>The index buffer, or nullptr if the data could not be decoded</returns>
+	IndexBuffer::Sptr DecodeIndexBuffer(const uint8_t* data, uint32_t dataSize, uint32_t indexCount, uint32_t vertexCount, bool compressed, std::vector<uint32_t>* cpuCopy = nullptr) {
+		IndexBuffer::Sptr result = IndexBuffer::Create(BufferUsage::StaticDraw);
+
+		// Files always store 32 bit indices, so 16 bit indices need to be decoded somewhere else and narrowed
+		if (IndexBuffer::GetIndexTypeForVertexCount(vertexCount) == IndexType::UShort || cpuCopy != nullptr) {
+			std::vector<uint32_t> decoded;
+			std::vector<uint32_t>& target = cpuCopy != nullptr ? *cpuCopy : decoded;
+			target.resize(indexCount);
+			if (compressed) {
+				if (!MeshCompression::DecodeIndices(data, dataSize, target.data(), indexCount)) {
+					return nullptr;
+				}
+			} else {
+				memcpy(target.data(), data, dataSize);
+			}
+			result->LoadIndices(target.data(), indexCount, vertexCount);
+			return result;
+		}
+
+		// Otherwise we can decode straight into the buffer
+		result->LoadData(nullptr, sizeof(uint32_t), indexCount, IndexType::UInt);
+
+		uint32_t* mapped = reinterpret_cast<uint32_t*>(result->Map(BufferMapMode::Write | BufferMapMode::InvalidateBuffer));
+		bool success = mapped != nullptr;
+		if (success) {
+			if (compressed) {
+				success = MeshCompression::DecodeIndices(data, dataSize, mapped, indexCount);
+			} else {
+				memcpy(mapped, data, dataSize);
+			}
+			result->Unmap();
+		}
+		return success ? result : nullptr;
+	}
+
+	/// <summary>
+	/// Returns true if a vertex declaration loaded from a file matches the declaration of a vertex type
+	/// </summary>
+	bool IsDeclaration(const VertexArrayObject::VertexDeclaration& vDecl, size_t stride, const VertexArrayObject::VertexDeclaration& expected, size_t expectedStride) {
+		if (vDecl.size() != expected.size() || stride != expectedStride) {
+			return false;
+		}
+		for (size_t ix = 0; ix < vDecl.size(); ix++) {
+			if (vDecl[ix].Slot != expected[ix].Slot || vDecl[ix].Size != expected[ix].Size || vDecl[ix].Type != expected[ix].Type ||
+				vDecl[ix].Offset != expected[ix].Offset || vDecl[ix].Usage != expected[ix].Usage) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void DequantizeVertex(const uint8_t* vertex, uint8_t* output, const std::vector<QuantizedAttribute>& layout) {
+		for (const QuantizedAttribute& attrib : layout) {
+			uint32_t packed;
+			memcpy(&packed, vertex + attrib.Offset, sizeof(uint32_t));
+			switch (attrib.Encoding) {
+				case AttributeEncoding::Octahedral: {
+					glm::vec3 value = MeshCompression::DecodeOctahedral(packed);
+					memcpy(output + attrib.SourceOffset, &value, sizeof(glm::vec3));
+					break;
+				}
+				case AttributeEncoding::Half: {
+					glm::vec2 value = glm::unpackHalf2x16(packed);
+					memcpy(output + attrib.SourceOffset, &value, sizeof(glm::vec2));
+					break;
+				}
+				case AttributeEncoding::Unorm8: {
+					glm::vec4 value = glm::unpackUnorm4x8(packed);
+					memcpy(output + attrib.SourceOffset, &value, sizeof(glm::vec4));
+					break;
+				}
+				case AttributeEncoding::Raw:
+				default:
+					memcpy(output + attrib.SourceOffset, vertex + attrib.Offset, attrib.Size);
+					break;
+			}
+		}
+	}
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename, std::vector<MeshLod>* lods, MeshCollisionData* collision, bool collisionTriangles) {
 	// Get the file extension and lowercase it
 	fs::path filePath = std::filesystem::path(filename);
 	std::string extension = filePath.extension().string();
@@ -27,16 +226,16 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 	if (extension == ".obj") {
 		// Get the binary path
 		fs::path binPath = filePath.replace_extension(binaryExtension);
-		// If the file does not exist, convert the OBJ file to a binary file
-		if (!fs::exists(binPath)) {
+		// If the file does not exist or the OBJ has changed, convert the OBJ file to a binary file
+		if (IsBinaryOutOfDate(filename, binPath.string())) {
 			ConvertToBinary(filename, binPath.string());
 		}
 		// Load the corresponding binary file
-		return _LoadFromBinFile(binPath.string());
+		return _LoadFromBinFile(binPath.string(), lods, collision, collisionTriangles);
 	} 
 	// Load our fancy binary files
 	else if (extension == ".bin") {
-		return _LoadFromBinFile(filename);
+		return _LoadFromBinFile(filename, lods, collision, collisionTriangles);
 	}
 	// We've never met this extension in our life
 	else {
@@ -45,11 +244,17 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 	}
 }
 
-void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::string& outFile) {
+void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::string& outFile, MeshFileFlags flags) {
 	// Load in the input file
 	MeshBuilder<VertexPosNormTexColTangents>* mesh = _LoadFromObjFile(inFile);
 
-	float startTime = static_cast<float>(glfwGetTime());
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	// Binary files are only written once, so it's worth taking the time to reorder the mesh for the GPU
+	mesh->Optimize();
+	if (*(flags & MeshFileFlags::Lods)) {
+		mesh->GenerateLods();
+	}
 
 	// If we didn't get an output path, just take the input and replace the extension
 	std::string outFileName = outFile;
@@ -63,266 +268,504 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 	}
 
 	// Save the mesh to the file
-	SaveBinaryFile(*mesh, outFileName);
+	SaveBinaryFile(*mesh, outFileName, flags, inFile);
 
-	float endTime = static_cast<float>(glfwGetTime());
-	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+	auto endTime = std::chrono::high_resolution_clock::now();
+	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, std::chrono::duration<float>(endTime - startTime).count(), mesh->GetVertexCount(), mesh->GetIndexCount());
 
 	// We no longer need the mesh data, free it
 	delete mesh;
 }
 
 MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(const std::string& filename) {
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
+	auto startTime = std::chrono::high_resolution_clock::now();
 
-	// If our file fails to open, we will throw an error
-	if (!file) {
+	// Parse the attributes and faces straight from the file
+	ObjMeshData data;
+	if (!ObjParser::ParseFile(filename, data)) {
 		throw std::runtime_error("Failed to open file");
 	}
 
-	// Could also take this in as a parameter
-	glm::vec4 color = glm::vec4(1.0f);
-
-	// Our attributes
-	std::vector<glm::vec3>  positions;
-	std::vector<glm::vec3>  normals;
-	std::vector<glm::vec2>  uvs;
-	std::vector<glm::ivec3> vertices;
-	std::vector<uint32_t>   indices;
-
-	// Maps a key generated from obj indices to a vertex index that
-	// has been added to the mesh already
-	std::unordered_map<uint64_t, uint32_t> vertexMap;
-
 	// We'll use the mesh builder since it supports easily adding
 	// vertices and indices
 	MeshBuilder<VertexPosNormTexColTangents>* mesh = new MeshBuilder<VertexPosNormTexColTangents>();
+	ObjParser::BuildMesh(data, *mesh);
 
-	// Storage for temporary data
-	std::string line;
-	glm::vec3 vecData;
-	glm::ivec3 vertexIndices;
+	// Calculate our tangents
+	MeshFactory::CalculateTBN(*mesh);
 
-	float startTime = static_cast<float>(glfwGetTime());
+	// Calculate and trace out how long it took us to load
+	auto endTime = std::chrono::high_resolution_clock::now();
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, std::chrono::duration<float>(endTime - startTime).count(), mesh->GetVertexCount(), mesh->GetIndexCount());
 
-	// Read and process the entire file
-	while (file.peek() != EOF) {
-		// Read in the first part of the line (ex: f, v, vn, etc...)
-		std::string command;
-		file >> command;
+	// Move our data into a VAO and return it
+	return mesh;
+}
 
-		// We will ignore the rest of the line for comment lines
-		if (command == "#") {
-			std::getline(file, line);
+bool OptimizedObjLoader::IsBinaryOutOfDate(const std::string& sourceFile, const std::string& binaryFile) {
+	// Only keep the binary mapped long enough to grab the header, since we may need to write to it below
+	BinaryHeaderV2 header;
+	{
+		MappedFile file(binaryFile);
+		if (!file.IsOpen() || file.GetSize() < sizeof(BinaryHeaderV2)) {
+			return true;
 		}
+		memcpy(&header, file.GetData(), sizeof(BinaryHeaderV2));
+	}
 
-		// The v command defines a vertex's position
-		else if (command == "v") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			positions.push_back(vecData);
-		}
-		// TODO: handle normals and textures
-		else if (command == "vn") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			normals.push_back(vecData);
-		} else if (command == "vt") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y;
-			uvs.push_back(vecData);
-		}
+	// Older versions don't know what they were converted from, so we always re-convert them
+	if (memcmp(header.HeaderBytes, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0 || header.Version != 0x02) {
+		return true;
+	}
 
-		// The f command defines a polygon in the mesh
-		// NOTE: make sure you triangulate in blender, otherwise it will
-		// output quads instead of triangles
-		else if (command == "f") {
-			// Read the rest of the line from the file
-			std::getline(file, line);
-			// Trim whitespace from either end of the line
-			StringTools::Trim(line);
-			// Create a string stream so we can use streaming operators on it
-			std::stringstream stream = std::stringstream(line);
-
-			uint32_t edges[4];
-			int ix = 0;
-			// Iterate over up to 4 sets of attributes
-			for (; ix < 4; ix++) {
-				if (stream.peek() != EOF) {
-					// Load in the faces, split up by slashes
-					char tempChar;
-					vertexIndices = glm::ivec3(0);
-					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
-					// The OBJ format can have negative values, which are a reference from the last added attributes
-					if (vertexIndices.x < 0) { vertexIndices.x = positions.size() + 1 + vertexIndices.x; }
-					if (vertexIndices.y < 0) { vertexIndices.y = uvs.size()       + 1 + vertexIndices.y; }
-					if (vertexIndices.z < 0) { vertexIndices.z = normals.size()   + 1 + vertexIndices.z; }
-
-					// We can construct a key using a bitmask of the attribute indices
-					// This let's us quickly look up a combination of attributes to see if it's already been added
-					// Note that this limits us to 2,097,150 unique attributes for positions, normals and textures
-					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
-					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
-
-					// Find the index associated with the combination of attributes
-					auto it = vertexMap.find(key);
-
-					// If it exists, we push the index to our indices
-					if (it != vertexMap.end()) {
-						edges[ix] = it->second;
-					} else {
-						vertices.push_back(vertexIndices - glm::ivec3(1));
-						uint32_t index = static_cast<uint32_t>(vertices.size()) - 1;
-
-						// Cache the index based on our key
-						vertexMap[key] = index;
-						// Add index to mesh, and add to edges list for if we are using quads
-						edges[ix] = index;
-					}
-				}
-				// We've reached the end of the line, break out of the loop
-				else { break; }
-			}
+	// If the source is gone, the binary is all we've got
+	std::error_code error;
+	uint64_t sourceSize = static_cast<uint64_t>(fs::file_size(sourceFile, error));
+	if (error) {
+		return false;
+	}
+	if (sourceSize != header.SourceSize) {
+		return true;
+	}
+	int64_t sourceTime = static_cast<int64_t>(fs::last_write_time(sourceFile, error).time_since_epoch().count());
+	if (!error && sourceTime == header.SourceTime) {
+		return false;
+	}
 
-			// Handling for triangle faces
-			if (ix == 3) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-			}
-			// Handling for quad faces
-			else if (ix == 4) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-
-				indices.push_back(edges[0]);
-				indices.push_back(edges[2]);
-				indices.push_back(edges[3]);
-			}
-		}
+	// The file has been touched but is the same size, it may not have actually changed (ex: checked out
+	// again from version control), so only re-convert if the contents are different
+	BinaryHeaderV2 current;
+	if (!_GetSourceInfo(sourceFile, current) || current.SourceHash != header.SourceHash) {
+		return true;
 	}
 
-	mesh->ReserveVertexSpace(vertices.size());
-	for (const auto& vertexIndices : vertices) {
-		// Construct a new vertex using the indices for the vertex
-		VertexPosNormTexColTangents vertex;
-		vertex.Position = positions[vertexIndices.x];
-		vertex.UV       = vertexIndices.y != 0 ? uvs[vertexIndices.y] : glm::vec2(0.0f);
-		vertex.Normal   = vertexIndices.z != 0 ? normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
-		vertex.Color    = color;
+	// Same contents, so store the new timestamp in the binary so that the next load doesn't need to hash it again
+	std::fstream out(binaryFile, std::ios::binary | std::ios::in | std::ios::out);
+	if (out) {
+		out.seekp(offsetof(BinaryHeaderV2, SourceTime));
+		out.write(reinterpret_cast<const char*>(&current.SourceTime), sizeof(current.SourceTime));
+	}
+	if (!out) {
+		LOG_WARN("Failed to update the source timestamp in \"{}\", it will be re-hashed on the next load", binaryFile);
+	}
+	return false;
+}
 
-		// Add to the mesh, get index of the added vertex
-		mesh->AddVertex(vertex);
+bool OptimizedObjLoader::_GetSourceInfo(const std::string& sourceFile, BinaryHeaderV2& header) {
+	MappedFile file(sourceFile);
+	if (!file.IsOpen()) {
+		return false;
 	}
-	mesh->ReserveIndexSpace(indices.size());
-	for (uint32_t ix : indices) {
-		mesh->AddIndex(ix);
+
+	std::error_code error;
+	header.SourceSize = file.GetSize();
+	header.SourceTime = static_cast<int64_t>(fs::last_write_time(sourceFile, error).time_since_epoch().count());
+	header.SourceHash = Fnv1a32(file.GetData(), file.GetSize());
+	return true;
+}
+
+void OptimizedObjLoader::_WriteBinaryFile(const void* vertices, uint32_t vertexCount, uint16_t vertexStride, const VertexArrayObject::VertexDeclaration& vDecl,
+										  const uint32_t* indices, uint32_t indexCount, const std::vector<LodData>& lods, const std::vector<glm::vec3>& hull,
+										  const std::string& outFilename, MeshFileFlags flags, const std::string& sourceFile)
+{
+	// Open the output file
+	std::ofstream file(outFilename, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open output file");
 	}
 
-	// Calculate our tangents
-	MeshFactory::CalculateTBN(*mesh);
+	// Create the fixed size header for our output file
+	BinaryHeaderV2 header  = BinaryHeaderV2();
+	header.Flags         = flags;
+	header.NumIndices    = indexCount;
+	header.NumVertices   = vertexCount;
+	header.VertexStride  = vertexStride;
+	header.NumAttributes = static_cast<uint16_t>(vDecl.size());
+	header.NumLods       = static_cast<uint32_t>(lods.size());
+	if (!sourceFile.empty() && !_GetSourceInfo(sourceFile, header)) {
+		LOG_WARN("Could not read source file \"{}\", binary file will not be updated when it changes", sourceFile);
+	}
 
-	// Calculate and trace out how long it took us to load
-	float endTime = static_cast<float>(glfwGetTime());
-	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+	// Calculate the bounds from the position attribute
+	const uint8_t* vertexBytes = static_cast<const uint8_t*>(vertices);
+	auto position = std::find_if(vDecl.begin(), vDecl.end(), [](const BufferAttribute& attrib) {
+		return attrib.Usage == AttribUsage::Position && attrib.Type == AttributeType::Float && attrib.Size == 3;
+	});
+	if (position != vDecl.end() && vertexCount > 0) {
+		header.BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+		header.BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+		for (uint32_t ix = 0; ix < vertexCount; ix++) {
+			glm::vec3 pos;
+			memcpy(&pos, vertexBytes + ix * (size_t)vertexStride + position->Offset, sizeof(glm::vec3));
+			header.BoundsMin = glm::min(header.BoundsMin, pos);
+			header.BoundsMax = glm::max(header.BoundsMax, pos);
+		}
+	}
 
-	// Move our data into a VAO and return it
-	return mesh;
-}
+	// Encode the indices
+	auto EncodeIndices = [flags](const uint32_t* indices, uint32_t indexCount, std::vector<uint8_t>& output) {
+		if (*(flags & MeshFileFlags::CompressedIndices)) {
+			MeshCompression::EncodeIndices(indices, indexCount, output);
+		} else {
+			const uint8_t* indexBytes = reinterpret_cast<const uint8_t*>(indices);
+			output.insert(output.end(), indexBytes, indexBytes + indexCount * sizeof(uint32_t));
+		}
+	};
+	std::vector<uint8_t> indexData;
+	EncodeIndices(indices, indexCount, indexData);
+
+	// Quantize the vertices if needed, then encode them
+	std::vector<uint8_t> quantized;
+	size_t storedStride = vertexStride;
+	if (*(flags & MeshFileFlags::QuantizedVertices)) {
+		std::vector<QuantizedAttribute> layout;
+		storedStride = GetQuantizedLayout(vDecl, layout);
+		quantized.resize(vertexCount * storedStride);
+		for (uint32_t ix = 0; ix < vertexCount; ix++) {
+			QuantizeVertex(vertexBytes + ix * (size_t)vertexStride, quantized.data() + ix * storedStride, layout);
+		}
+		vertexBytes = quantized.data();
+	}
+	std::vector<uint8_t> vertexData;
+	if (*(flags & MeshFileFlags::CompressedVertices)) {
+		MeshCompression::EncodeVertices(vertexBytes, vertexCount, storedStride, vertexData);
+	} else {
+		vertexData.assign(vertexBytes, vertexBytes + vertexCount * storedStride);
+	}
 
-VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
+	// LODs go at the end, with a table describing each one before their indices
+	std::vector<BinaryLod> lodTable(lods.size());
+	std::vector<uint8_t> lodData;
+	for (size_t ix = 0; ix < lods.size(); ix++) {
+		size_t start = lodData.size();
+		EncodeIndices(lods[ix].Indices, lods[ix].NumIndices, lodData);
+		lodTable[ix].NumIndices = lods[ix].NumIndices;
+		lodTable[ix].DataSize   = static_cast<uint32_t>(lodData.size() - start);
+		lodTable[ix].Error      = lods[ix].Error;
+	}
 
-	// Open the output file
-	std::ifstream file(filename, std::ios::binary);
+	header.IndexDataSize  = static_cast<uint32_t>(indexData.size());
+	header.VertexDataSize = static_cast<uint32_t>(vertexData.size());
+	header.Checksum = Fnv1a32(vDecl.data(), vDecl.size() * sizeof(BufferAttribute));
+	header.Checksum = Fnv1a32(indexData.data(), indexData.size(), header.Checksum);
+	header.Checksum = Fnv1a32(vertexData.data(), vertexData.size(), header.Checksum);
+	header.Checksum = Fnv1a32(lodTable.data(), lodTable.size() * sizeof(BinaryLod), header.Checksum);
+	header.Checksum = Fnv1a32(lodData.data(), lodData.size(), header.Checksum);
+
+	// The hull goes right at the end, and only if the flag is set so older files can still be read
+	uint32_t hullCount = static_cast<uint32_t>(hull.size());
+	if (*(flags & MeshFileFlags::ConvexHull)) {
+		header.Checksum = Fnv1a32(&hullCount, sizeof(uint32_t), header.Checksum);
+		header.Checksum = Fnv1a32(hull.data(), hull.size() * sizeof(glm::vec3), header.Checksum);
+	}
+
+	// Write everything out
+	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeaderV2));
+	file.write(reinterpret_cast<const char*>(vDecl.data()), vDecl.size() * sizeof(BufferAttribute));
+	file.write(reinterpret_cast<const char*>(indexData.data()), indexData.size());
+	file.write(reinterpret_cast<const char*>(vertexData.data()), vertexData.size());
+	file.write(reinterpret_cast<const char*>(lodTable.data()), lodTable.size() * sizeof(BinaryLod));
+	file.write(reinterpret_cast<const char*>(lodData.data()), lodData.size());
+	if (*(flags & MeshFileFlags::ConvexHull)) {
+		file.write(reinterpret_cast<const char*>(&hullCount), sizeof(uint32_t));
+		file.write(reinterpret_cast<const char*>(hull.data()), hull.size() * sizeof(glm::vec3));
+	}
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename, std::vector<MeshLod>* lods, MeshCollisionData* collision, bool collisionTriangles) {
+	// Map the file so we can decode straight out of it
+	MappedFile file(filename);
 	// If our file fails to open, we will throw an error
-	if (!file) { throw std::runtime_error("Failed to open file"); }
+	if (!file.IsOpen()) { throw std::runtime_error("Failed to open file"); }
 
-	float startTime = static_cast<float>(glfwGetTime());
+	// The magic bytes and version are in the same place for all versions
+	const size_t versionEnd = sizeof(HEADER_BYTES) + sizeof(uint16_t);
+	if (file.GetSize() < versionEnd || memcmp(file.GetData(), HEADER_BYTES, sizeof(HEADER_BYTES)) != 0) {
+		LOG_ERROR("\"{}\" is not a binary mesh file!", filename);
+		return nullptr;
+	}
 
-	// Get the file size so we can avoid reading past the end
-	file.seekg(0, std::ios::end);
-	size_t size = file.tellg();
-	file.seekg(0, std::ios::beg);
+	// Handle our version
+	uint16_t version;
+	memcpy(&version, file.GetData() + sizeof(HEADER_BYTES), sizeof(uint16_t));
+	switch (version) {
+		case 0x01: return _LoadVersion1(file.GetData(), file.GetSize(), filename);
+		case 0x02: return _LoadVersion2(file.GetData(), file.GetSize(), filename, lods, collision, collisionTriangles);
+		default:
+			LOG_ERROR("Unsupported binary mesh version {} in \"{}\"", version, filename);
+			return nullptr;
+	}
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadVersion1(const char* data, size_t size, const std::string& filename) {
+	auto startTime = std::chrono::high_resolution_clock::now();
 
 	// Read the header from the file
 	BinaryHeader header = BinaryHeader();
 	if (size >= sizeof(BinaryHeader)) {
-		file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
+		memcpy(&header, data, sizeof(BinaryHeader));
 	} else {
 		LOG_ERROR("Not enough data in the file!");
 		return nullptr;
 	}
 
-	// TODO: validate header
+	// Determine how many bytes we need in the file
+	size_t requiredBytes =
+		sizeof(BinaryHeader) +
+		(header.NumAttributes * sizeof(BufferAttribute)) +
+		(header.VertexStride * (size_t)header.NumVertices) +
+		(header.NumIndices * GetIndexTypeSize(header.IndicesType));
 
-	// Handle our version
-	if (header.Version == 0x01) {
-		// Determine how many bytes we need in the file
-		size_t requiredBytes =
-			sizeof(BinaryHeader) +
-			(header.NumAttributes * sizeof(BufferAttribute)) +
-			(header.VertexStride * (size_t)header.NumVertices) +
-			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-
-		// Make sure there's enough data in the file
-		if (size < requiredBytes) {
-			LOG_ERROR("Not enough data in the file!");
+	// Make sure there's enough data in the file
+	if (size < requiredBytes) {
+		LOG_ERROR("Not enough data in the file!");
+		return nullptr;
+	}
+	const char* seek = data + sizeof(BinaryHeader);
+
+	// Read all attributes from the file, this is basically our VDECL
+	std::vector<BufferAttribute> vertexDeclaration;
+	vertexDeclaration.resize(header.NumAttributes);
+	memcpy(vertexDeclaration.data(), seek, header.NumAttributes * sizeof(BufferAttribute));
+	seek += header.NumAttributes * sizeof(BufferAttribute);
+
+	// These will have the buffer pointers
+	IndexBuffer::Sptr indices = nullptr;
+	VertexBuffer::Sptr vertices = nullptr;
+
+	// If we have index data, load it straight from the file
+	if (header.NumIndices > 0) {
+		indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+		indices->LoadData(seek, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
+		seek += header.NumIndices * GetIndexTypeSize(header.IndicesType);
+	}
+
+	// Create a new VBO and load the vertices from the file
+	vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	vertices->LoadData(seek, header.VertexStride, header.NumVertices);
+
+	// Create the VAO and attach our index and vertex buffers
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->SetIndexBuffer(indices);
+	result->AddVertexBuffer(vertices, vertexDeclaration);
+
+	// Copy in the vertex declaration we loaded
+	result->SetVDecl(vertexDeclaration);
+
+	// Calculate and trace out how long it took us to load
+	auto endTime = std::chrono::high_resolution_clock::now();
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, std::chrono::duration<float>(endTime - startTime).count(), header.NumVertices, header.NumIndices);
+
+	return result;
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadVersion2(const char* data, size_t size, const std::string& filename, std::vector<MeshLod>* lods, MeshCollisionData* collision, bool collisionTriangles) {
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	// Read and validate the header
+	BinaryHeaderV2 header;
+	if (size < sizeof(BinaryHeaderV2)) {
+		LOG_ERROR("Not enough data in \"{}\"!", filename);
+		return nullptr;
+	}
+	memcpy(&header, data, sizeof(BinaryHeaderV2));
+
+	if (header.NumAttributes == 0 || header.VertexStride == 0) {
+		LOG_ERROR("Binary mesh \"{}\" has no vertex attributes!", filename);
+		return nullptr;
+	}
+	size_t declarationSize = header.NumAttributes * sizeof(BufferAttribute);
+	size_t lodTableSize = header.NumLods * sizeof(BinaryLod);
+	size_t requiredBytes = sizeof(BinaryHeaderV2) + declarationSize + (size_t)header.IndexDataSize + header.VertexDataSize + lodTableSize;
+	if (size < requiredBytes) {
+		LOG_ERROR("Not enough data in \"{}\"!", filename);
+		return nullptr;
+	}
+
+	const uint8_t* declarationData = reinterpret_cast<const uint8_t*>(data) + sizeof(BinaryHeaderV2);
+	const uint8_t* indexData = declarationData + declarationSize;
+	const uint8_t* vertexData = indexData + header.IndexDataSize;
+
+	// The LOD table tells us how much LOD data comes after it
+	std::vector<BinaryLod> lodTable(header.NumLods);
+	memcpy(lodTable.data(), vertexData + header.VertexDataSize, lodTableSize);
+	const uint8_t* lodData = vertexData + header.VertexDataSize + lodTableSize;
+	for (const BinaryLod& lod : lodTable) {
+		if (!*(header.Flags & MeshFileFlags::CompressedIndices) && lod.DataSize != lod.NumIndices * sizeof(uint32_t)) {
+			LOG_ERROR("LOD data in \"{}\" does not match the header", filename);
 			return nullptr;
 		}
+		requiredBytes += lod.DataSize;
+	}
 
-		// Read all attributes from the file, this is basically our VDECL
-		std::vector<BufferAttribute> vertexDeclaration;
-		vertexDeclaration.resize(header.NumAttributes);
-		for (int ix = 0; ix < header.NumAttributes; ix++) {
-			file.read(reinterpret_cast<char*>(&vertexDeclaration[ix]), sizeof(BufferAttribute));
+	// Then the hull, if the file has one
+	uint32_t hullCount = 0;
+	const uint8_t* hullData = nullptr;
+	if (*(header.Flags & MeshFileFlags::ConvexHull)) {
+		if (size < requiredBytes + sizeof(uint32_t)) {
+			LOG_ERROR("Not enough data in \"{}\"!", filename);
+			return nullptr;
 		}
+		memcpy(&hullCount, data + requiredBytes, sizeof(uint32_t));
+		hullData = reinterpret_cast<const uint8_t*>(data) + requiredBytes + sizeof(uint32_t);
+		requiredBytes += sizeof(uint32_t) + hullCount * sizeof(glm::vec3);
+	}
+	if (size < requiredBytes) {
+		LOG_ERROR("Not enough data in \"{}\"!", filename);
+		return nullptr;
+	}
 
-		// These will have the buffer pointers
-		IndexBuffer::Sptr indices = nullptr;
-		VertexBuffer::Sptr vertices = nullptr;
-
-		// If we have index data, load it
-		if (header.NumIndices > 0) {
-			// Create index buffer
-			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
-
-			// Create memory to store indices, then read from the file
-			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
-			free(dataStore);
+	uint32_t checksum = Fnv1a32(declarationData, requiredBytes - sizeof(BinaryHeaderV2));
+	if (checksum != header.Checksum) {
+		LOG_ERROR("Checksum mismatch in \"{}\", the file may be corrupt", filename);
+		return nullptr;
+	}
+
+	// Read all attributes from the file, and make sure they fit in the vertex
+	std::vector<BufferAttribute> vertexDeclaration;
+	vertexDeclaration.resize(header.NumAttributes);
+	memcpy(vertexDeclaration.data(), declarationData, declarationSize);
+	for (const BufferAttribute& attrib : vertexDeclaration) {
+		uint32_t attribSize = attrib.Size * GetAttributeTypeSize(attrib.Type);
+		if (attrib.Size < 1 || attrib.Size > 4 || attribSize == 0 || attrib.Offset < 0 || attrib.Offset + attribSize > header.VertexStride) {
+			LOG_ERROR("Invalid vertex attribute in \"{}\"", filename);
+			return nullptr;
 		}
+	}
 
-		// Create a new VBO
-		vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	// Work out the layout of the stored vertices, and make sure uncompressed data is the size we expect
+	std::vector<QuantizedAttribute> layout;
+	size_t storedStride = header.VertexStride;
+	bool quantized = *(header.Flags & MeshFileFlags::QuantizedVertices);
+	if (quantized) {
+		storedStride = GetQuantizedLayout(vertexDeclaration, layout);
+	}
+	if ((!*(header.Flags & MeshFileFlags::CompressedVertices) && header.VertexDataSize != header.NumVertices * storedStride) ||
+		(!*(header.Flags & MeshFileFlags::CompressedIndices) && header.IndexDataSize != header.NumIndices * sizeof(uint32_t))) {
+		LOG_ERROR("Mesh data in \"{}\" does not match the header", filename);
+		return nullptr;
+	}
 
-		// Create memory to store vertices and load from file
-		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
-		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
+	// The hull is tiny, but the positions and indices are a full copy of the mesh, so they are only kept if asked for
+	MeshCollisionData* triangles = collisionTriangles ? collision : nullptr;
 
-		// Load data into OpenGL and free the CPU copy
-		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
+	// Indices get decoded straight into the index buffer's memory
+	IndexBuffer::Sptr indices = nullptr;
+	if (header.NumIndices > 0) {
+		indices = DecodeIndexBuffer(indexData, header.IndexDataSize, header.NumIndices, header.NumVertices, *(header.Flags & MeshFileFlags::CompressedIndices),
+									triangles != nullptr ? &triangles->Indices : nullptr);
+		if (indices == nullptr) {
+			LOG_ERROR("Failed to decode indices from \"{}\"", filename);
+			return nullptr;
+		}
+	}
 
-		// Create the VAO and attach our index and vertex buffers
-		VertexArrayObject::Sptr result = VertexArrayObject::Create();
-		result->SetIndexBuffer(indices);
-		result->AddVertexBuffer(vertices, vertexDeclaration);
+	// Meshes using our default vertex type get packed down to about half the size before they are uploaded
+	bool packed = IsDeclaration(vertexDeclaration, header.VertexStride, VertexPosNormTexColTangents::V_DECL, sizeof(VertexPosNormTexColTangents));
+	const VertexArrayObject::VertexDeclaration& uploadDeclaration = packed ? VertexPosNormTexColTangentsPacked::V_DECL : vertexDeclaration;
+
+	// If we're keeping a copy of the positions, we need to know where they are
+	auto position = std::find_if(vertexDeclaration.begin(), vertexDeclaration.end(), [](const BufferAttribute& attrib) {
+		return attrib.Usage == AttribUsage::Position && attrib.Type == AttributeType::Float && attrib.Size == 3;
+	});
+	bool copyPositions = triangles != nullptr && position != vertexDeclaration.end();
+	// Vertices we need to convert or copy from can't be decoded straight into the buffer
+	bool convert = quantized || packed || copyPositions;
+
+	// Same for vertices, if they are quantized or packed we need to convert them as we go
+	VertexBuffer::Sptr vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	vertices->LoadData(nullptr, packed ? sizeof(VertexPosNormTexColTangentsPacked) : header.VertexStride, header.NumVertices);
+	if (header.NumVertices > 0) {
+		uint8_t* mapped = reinterpret_cast<uint8_t*>(vertices->Map(BufferMapMode::Write | BufferMapMode::InvalidateBuffer));
+		bool success = mapped != nullptr;
+		if (success) {
+			if (!convert && *(header.Flags & MeshFileFlags::CompressedVertices)) {
+				success = MeshCompression::DecodeVertices(vertexData, header.VertexDataSize, mapped, header.NumVertices, storedStride);
+			} else if (!convert) {
+				memcpy(mapped, vertexData, header.VertexDataSize);
+			} else {
+				// Data we need to convert needs to be decompressed somewhere else first, since we can't read back from the mapped buffer
+				std::vector<uint8_t> decoded;
+				const uint8_t* source = vertexData;
+				if (*(header.Flags & MeshFileFlags::CompressedVertices)) {
+					decoded.resize(header.NumVertices * storedStride);
+					success = MeshCompression::DecodeVertices(vertexData, header.VertexDataSize, decoded.data(), header.NumVertices, storedStride);
+					source = decoded.data();
+				}
+				// If we're packing or copying, we need the full vertices somewhere we can read them
+				std::vector<uint8_t> expanded;
+				if (success && quantized) {
+					uint8_t* target = mapped;
+					if (packed || copyPositions) {
+						expanded.resize(header.NumVertices * (size_t)header.VertexStride);
+						target = expanded.data();
+					}
+					for (uint32_t ix = 0; ix < header.NumVertices; ix++) {
+						DequantizeVertex(source + ix * storedStride, target + ix * (size_t)header.VertexStride, layout);
+					}
+					source = target;
+				}
+				if (success && packed) {
+					VertexPosNormTexColTangentsPacked* output = reinterpret_cast<VertexPosNormTexColTangentsPacked*>(mapped);
+					for (uint32_t ix = 0; ix < header.NumVertices; ix++) {
+						// The source may not be aligned if it's straight from the file
+						VertexPosNormTexColTangents vertex;
+						memcpy(&vertex, source + ix * sizeof(VertexPosNormTexColTangents), sizeof(VertexPosNormTexColTangents));
+						output[ix] = VertexPosNormTexColTangentsPacked::Pack(vertex);
+					}
+				} else if (success && source != mapped) {
+					memcpy(mapped, source, header.NumVertices * (size_t)header.VertexStride);
+				}
+				if (success && copyPositions) {
+					triangles->Positions.resize(header.NumVertices);
+					for (uint32_t ix = 0; ix < header.NumVertices; ix++) {
+						memcpy(&triangles->Positions[ix], source + ix * (size_t)header.VertexStride + position->Offset, sizeof(glm::vec3));
+					}
+				}
+			}
+			vertices->Unmap();
+		}
+		if (!success) {
+			LOG_ERROR("Failed to decode vertices from \"{}\"", filename);
+			return nullptr;
+		}
+	}
 
-		// Copy in the vertex declaration we loaded
-		result->SetVDecl(vertexDeclaration);
+	// Create the VAO and attach our index and vertex buffers
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->SetIndexBuffer(indices);
+	result->AddVertexBuffer(vertices, uploadDeclaration);
+	result->SetVDecl(uploadDeclaration);
+	result->SetBounds(header.BoundsMin, header.BoundsMax);
+
+	// Each LOD gets it's own VAO, that uses the same vertex buffer with a smaller index buffer
+	if (lods != nullptr) {
+		lods->clear();
+		for (const BinaryLod& lod : lodTable) {
+			IndexBuffer::Sptr lodIndices = DecodeIndexBuffer(lodData, lod.DataSize, lod.NumIndices, header.NumVertices, *(header.Flags & MeshFileFlags::CompressedIndices));
+			if (lodIndices == nullptr) {
+				LOG_WARN("Failed to decode LOD {} from \"{}\", skipping remaining LODs", lods->size() + 1, filename);
+				break;
+			}
+			lodData += lod.DataSize;
 
-		// Calculate and trace out how long it took us to load
-		float endTime = static_cast<float>(glfwGetTime());
-		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+			MeshLod meshLod;
+			meshLod.Mesh = result->Clone();
+			meshLod.Mesh->SetIndexBuffer(lodIndices);
+			meshLod.Error = lod.Error;
+			lods->push_back(meshLod);
+		}
+	}
 
-		return result;
+	// Files without a hull leave it empty, so it can be built when it's first needed
+	if (collision != nullptr && hullCount > 0) {
+		collision->HullVertices.resize(hullCount);
+		memcpy(collision->HullVertices.data(), hullData, hullCount * sizeof(glm::vec3));
 	}
 
-	return nullptr;
+	// Calculate and trace out how long it took us to load
+	auto endTime = std::chrono::high_resolution_clock::now();
+	LOG_TRACE("Loaded binary mesh \"{}\" in {} seconds ({} vertices, {} indices, {} LODs)", filename, std::chrono::duration<float>(endTime - startTime).count(), header.NumVertices, header.NumIndices, header.NumLods);
+
+	return result;
 }
@@ -7,11 +7,41 @@
  */
 #pragma once
 #include <fstream>
+#include <EnumToString.h>
 
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
 
 #include "Utils/MeshBuilder.h"
+#include "Utils/MeshCollisionData.h"
+
+/// <summary>
+/// Options for how vertex and index data is stored in a binary mesh file
+/// </summary>
+ENUM_FLAGS(MeshFileFlags, uint16_t,
+	None               = 0,
+	// Normals and tangents are stored as octahedral snorm16s, UVs as half floats and colors as unorm8s.
+	// Positions and any other attributes are stored as-is
+	QuantizedVertices  = 1 << 0,
+	// Vertices are delta encoded and bit packed with MeshCompression
+	CompressedVertices = 1 << 1,
+	// Indices are delta encoded with MeshCompression
+	CompressedIndices  = 1 << 2,
+	// Simplified LODs are generated when converting from OBJ files
+	Lods               = 1 << 3,
+	// A simplified convex hull is stored for building physics colliders
+	ConvexHull         = 1 << 4,
+	Default            = QuantizedVertices | CompressedVertices | CompressedIndices | Lods | ConvexHull
+)
+
+/// <summary>
+/// A lower detail version of a mesh, which shares the vertex buffer of the full detail mesh
+/// </summary>
+struct MeshLod {
+	VertexArrayObject::Sptr Mesh;
+	// How far the surface is from the full detail mesh, relative to the largest dimension of the mesh
+	float                   Error = 0.0f;
+};
 
 /// <summary>
 /// An optimized OBJ loader that can convert an OBJ file to a binary representation
@@ -21,29 +51,45 @@ class OptimizedObjLoader {
 public:
 	/// <summary>
 	/// Loads a VAO from an OBJ file. On the first time this is called for an OBJ file, will convert the OBJ file 
-	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
+	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead, unless
+	/// the OBJ file has changed since it was converted
 	/// </summary>
 	/// <param name="filename">The path to the .obj or .bin file to load</param>
+	/// <param name="lods">If not null, receives any LODs stored in the binary file, from highest to lowest detail</param>
+	/// <param name="collision">If not null, receives the convex hull if the file has one, along with a CPU side copy of the positions and indices</param>
+	/// <param name="collisionTriangles">False to only load the hull into collision, and skip copying the positions and indices</param>
 	/// <returns>A VAO loaded from disk</returns>
-	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename);
+	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, std::vector<MeshLod>* lods = nullptr, MeshCollisionData* collision = nullptr, bool collisionTriangles = true);
 	/// <summary>
 	/// Manually converts an OBJ file into a binary mesh file
 	/// </summary>
 	/// <param name="inFile">The path to OBJ file to convert</param>
 	/// <param name="outFile">The output path for the bin file, or empty to use the inFile path and replace the extension with .bin</param>
-	static void ConvertToBinary(const std::string& inFile, const std::string& outFile = "");
+	/// <param name="flags">How to store the vertex and index data</param>
+	static void ConvertToBinary(const std::string& inFile, const std::string& outFile = "", MeshFileFlags flags = MeshFileFlags::Default);
 
 	/// <summary>
-	/// Saves a mesh builder of the given type to a binary file
+	/// Checks whether a binary file needs to be regenerated from it's source OBJ file. Binary files are out
+	/// of date if they are missing, invalid, from an older version, or were converted from different data
 	/// </summary>
-	/// <typeparam name="VertexType"></typeparam>
-	/// <param name="mesh"></param>
-	/// <param name="outFilename"></param>
+	/// <param name="sourceFile">The path to the OBJ file</param>
+	/// <param name="binaryFile">The path to the binary file</param>
+	static bool IsBinaryOutOfDate(const std::string& sourceFile, const std::string& binaryFile);
+
+	/// <summary>
+	/// Saves a mesh builder of the given type to a binary file, along with any LODs from MeshBuilder::GenerateLods,
+	/// and the mesh's convex hull if flags includes ConvexHull
+	/// </summary>
+	/// <typeparam name="VertexType">The type of vertex in the mesh</typeparam>
+	/// <param name="mesh">The mesh to save</param>
+	/// <param name="outFilename">The path to save the binary file to</param>
+	/// <param name="flags">How to store the vertex and index data</param>
+	/// <param name="sourceFile">The file the mesh was loaded from, if any, so we can tell when the binary is out of date</param>
 	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, MeshFileFlags flags = MeshFileFlags::Default, const std::string& sourceFile = "");
 
 protected:
-	// Will be put at the start of the binary file, contains info about the contents of the file
+	// Will be put at the start of version 1 binary files, contains info about the contents of the file
 	struct BinaryHeader {
 		// A check value so we can ensure that we're loading in the right file type
 		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
@@ -61,42 +107,87 @@ protected:
 		uint8_t   NumAttributes = 0;
 	};
 
+	// The header for version 2 binary files. The magic bytes and version are in the same place as version 1,
+	// so we can check those before deciding which header to read.
+	// The header is followed by the vertex declaration, then the index data, then the vertex data, then
+	// a BinaryLod for each LOD, then the index data for each LOD. Files with the ConvexHull flag end with
+	// the number of hull vertices as a uint32_t, followed by the hull vertices
+	struct BinaryHeaderV2 {
+		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
+		uint16_t  Version = 0x02;
+		// How the vertex and index data is stored
+		MeshFileFlags Flags = MeshFileFlags::None;
+		uint32_t  NumIndices = 0;
+		uint32_t  NumVertices = 0;
+		// The size of a single vertex once it has been loaded into the vertex buffer
+		uint16_t  VertexStride = 0;
+		uint16_t  NumAttributes = 0;
+		// The number of LODs stored after the vertex data, older files always have 0 here
+		uint32_t  NumLods = 0;
+		// The size, modification time and hash of the file we were converted from, or 0 if unknown
+		uint64_t  SourceSize = 0;
+		int64_t   SourceTime = 0;
+		uint32_t  SourceHash = 0;
+		// The axis aligned bounds of the vertex positions
+		glm::vec3 BoundsMin = glm::vec3(0.0f);
+		glm::vec3 BoundsMax = glm::vec3(0.0f);
+		// The number of bytes of index and vertex data that follow the vertex declaration
+		uint32_t  IndexDataSize = 0;
+		uint32_t  VertexDataSize = 0;
+		// FNV-1a hash of everything after the header
+		uint32_t  Checksum = 0;
+	};
+
+	// Describes a single LOD in a version 2 file. LOD indices are stored the same way as the full mesh's indices
+	struct BinaryLod {
+		uint32_t NumIndices = 0;
+		uint32_t DataSize = 0;
+		float    Error = 0.0f;
+	};
+
+	// The indices for an LOD that is being written out
+	struct LodData {
+		const uint32_t* Indices;
+		uint32_t        NumIndices;
+		float           Error;
+	};
+
 	OptimizedObjLoader() = default;
 	~OptimizedObjLoader() = default;
 
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
-	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename, std::vector<MeshLod>* lods, MeshCollisionData* collision, bool collisionTriangles);
+	static VertexArrayObject::Sptr _LoadVersion1(const char* data, size_t size, const std::string& filename);
+	static VertexArrayObject::Sptr _LoadVersion2(const char* data, size_t size, const std::string& filename, std::vector<MeshLod>* lods, MeshCollisionData* collision, bool collisionTriangles);
+
+	static void _WriteBinaryFile(const void* vertices, uint32_t vertexCount, uint16_t vertexStride, const VertexArrayObject::VertexDeclaration& vDecl,
+								 const uint32_t* indices, uint32_t indexCount, const std::vector<LodData>& lods, const std::vector<glm::vec3>& hull,
+								 const std::string& outFilename, MeshFileFlags flags, const std::string& sourceFile);
+
+	/// <summary>
+	/// Reads the size, modification time and hash of a source file into a header
+	/// </summary>
+	/// <returns>False if the file could not be read</returns>
+	static bool _GetSourceInfo(const std::string& sourceFile, BinaryHeaderV2& header);
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
-	// Open the output file
-	std::ofstream file(outFilename, std::ios::binary);
-	if (!file) {
-		throw std::runtime_error("Failed to open output file");
+void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, MeshFileFlags flags, const std::string& sourceFile) {
+	std::vector<LodData> lods;
+	for (size_t ix = 0; ix < mesh.GetLodCount(); ix++) {
+		const std::vector<uint32_t>& indices = mesh.GetLodIndices(ix);
+		lods.push_back({ indices.data(), static_cast<uint32_t>(indices.size()), mesh.GetLodError(ix) });
 	}
 
-	// Create the fixed size header for our output file
-	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
-	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
-	header.NumVertices   = mesh.GetVertexCount();
-	header.VertexStride  = sizeof(VertexType);
-	header.NumAttributes = VertexType::V_DECL.size();
-
-	// Write header bytes to the stream
-	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
-
-	// Write which attributes we have to the stream
-	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
-		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
-	}
-	// Write any index data to the file
-	if (mesh.GetIndexCount() > 0) {
-		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
+	// Physics only needs a rough hull, so we do the expensive part now instead of every time the mesh is loaded
+	MeshCollisionData collision;
+	if (*(flags & MeshFileFlags::ConvexHull)) {
+		mesh.GetCollisionData(collision);
+		if (!collision.BuildHull()) {
+			flags = (MeshFileFlags)(*flags & ~*MeshFileFlags::ConvexHull);
+		}
 	}
 
-	// Write vertex data to file
-	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+	_WriteBinaryFile(mesh.GetVertexDataPtr(), static_cast<uint32_t>(mesh.GetVertexCount()), sizeof(VertexType), VertexType::V_DECL,
+					 mesh.GetIndexDataPtr(), static_cast<uint32_t>(mesh.GetIndexCount()), lods, collision.HullVertices, outFilename, flags, sourceFile);
 }
@@ -65,3 +65,125 @@ int StringTools::Split(const std::string& s, std::vector<std::string>& results,
 	results.push_back(s.substr(lastPos, seek));
 	return ++result;
 }
+
+uint32_t StringTools::DecodeUtf8(const char*& it, const char* end)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(it);
+	uint8_t lead = bytes[0];
+
+	// Most text is ASCII, so we check that first
+	if (lead < 0x80) {
+		it++;
+		return lead;
+	}
+
+	// Work out how many continuation bytes follow, and the smallest codepoint that should use that many (to reject overlong forms)
+	uint32_t length, codePoint, minValue;
+	if ((lead & 0xE0) == 0xC0)      { length = 2; codePoint = lead & 0x1F; minValue = 0x80; }
+	else if ((lead & 0xF0) == 0xE0) { length = 3; codePoint = lead & 0x0F; minValue = 0x800; }
+	else if ((lead & 0xF8) == 0xF0) { length = 4; codePoint = lead & 0x07; minValue = 0x10000; }
+	else {
+		it++;
+		return 0xFFFD;
+	}
+
+	if (end - it < (ptrdiff_t)length) {
+		it++;
+		return 0xFFFD;
+	}
+	for (uint32_t ix = 1; ix < length; ix++) {
+		if ((bytes[ix] & 0xC0) != 0x80) {
+			it++;
+			return 0xFFFD;
+		}
+		codePoint = (codePoint << 6) | (bytes[ix] & 0x3F);
+	}
+	if (codePoint < minValue || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+		it++;
+		return 0xFFFD;
+	}
+
+	it += length;
+	return codePoint;
+}
+
+void StringTools::DecodeUtf8(const std::string& text, std::u32string& result)
+{
+	result.clear();
+	result.reserve(text.size());
+	const char* it = text.data();
+	const char* end = it + text.size();
+	while (it < end) {
+		result.push_back(DecodeUtf8(it, end));
+	}
+}
+
+void StringTools::DecodeWide(const std::wstring& text, std::u32string& result)
+{
+	result.clear();
+	result.reserve(text.size());
+	for (size_t ix = 0; ix < text.size(); ix++) {
+		uint32_t codePoint = static_cast<uint32_t>(text[ix]);
+		// Combine UTF-16 surrogate pairs, this never triggers when wchar_t is 32 bits
+		if (sizeof(wchar_t) == 2 && codePoint >= 0xD800 && codePoint <= 0xDBFF && ix + 1 < text.size()) {
+			uint32_t low = static_cast<uint32_t>(text[ix + 1]);
+			if (low >= 0xDC00 && low <= 0xDFFF) {
+				codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+				ix++;
+			}
+		}
+		result.push_back(codePoint);
+	}
+}
+
+void StringTools::EncodeUtf8(uint32_t codePoint, std::string& result)
+{
+	if (codePoint < 0x80) {
+		result.push_back(static_cast<char>(codePoint));
+	} else if (codePoint < 0x800) {
+		result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+		result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	} else if (codePoint < 0x10000) {
+		result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+		result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	} else {
+		result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+		result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+		result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+}
+
+std::wstring StringTools::Utf8ToWide(const std::string& text)
+{
+	std::wstring result;
+	result.reserve(text.size());
+	const char* it = text.data();
+	const char* end = it + text.size();
+	while (it < end) {
+		uint32_t codePoint = DecodeUtf8(it, end);
+		// Split into a surrogate pair if wchar_t can't hold the codepoint
+		if (sizeof(wchar_t) == 2 && codePoint >= 0x10000) {
+			codePoint -= 0x10000;
+			result.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+			result.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+		} else {
+			result.push_back(static_cast<wchar_t>(codePoint));
+		}
+	}
+	return result;
+}
+
+std::string StringTools::WideToUtf8(const std::wstring& text)
+{
+	std::u32string codePoints;
+	DecodeWide(text, codePoints);
+
+	std::string result;
+	result.reserve(codePoints.size());
+	for (uint32_t codePoint : codePoints) {
+		EncodeUtf8(codePoint, result);
+	}
+	return result;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <cstdint>
 #include <algorithm>
 #include <vector>
 
@@ -115,4 +116,35 @@ public:
 	/// <param name="splitOn">The delimiter string to split on</param>
 	/// <returns>The number of tokens this command appended to the results</returns>
 	static int Split(const std::string& s, std::vector<std::string>& results, const std::string& splitOn = ",");
+
+	/// <summary>
+	/// Decodes a single codepoint from UTF-8 text and advances past it. Invalid or
+	/// truncated sequences decode to U+FFFD and skip a single byte
+	/// </summary>
+	/// <param name="it">The current position in the text, will be advanced past the codepoint</param>
+	/// <param name="end">The end of the text</param>
+	/// <returns>The decoded codepoint</returns>
+	static uint32_t DecodeUtf8(const char*& it, const char* end);
+	/// <summary>
+	/// Decodes UTF-8 text into codepoints, replacing the contents of result
+	/// </summary>
+	static void DecodeUtf8(const std::string& text, std::u32string& result);
+	/// <summary>
+	/// Decodes a wide string into codepoints, replacing the contents of result. Handles
+	/// surrogate pairs on platforms where wchar_t is UTF-16
+	/// </summary>
+	static void DecodeWide(const std::wstring& text, std::u32string& result);
+	/// <summary>
+	/// Appends the UTF-8 encoding of a codepoint to a string
+	/// </summary>
+	static void EncodeUtf8(uint32_t codePoint, std::string& result);
+
+	/// <summary>
+	/// Converts UTF-8 text to a wide string
+	/// </summary>
+	static std::wstring Utf8ToWide(const std::string& text);
+	/// <summary>
+	/// Converts a wide string to UTF-8 text
+	/// </summary>
+	static std::string WideToUtf8(const std::wstring& text);
 };
\ No newline at end of file
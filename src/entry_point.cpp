@@ -1,9 +1,27 @@
 #define GLM_SWIZZLE 
+#include <cstring>
 #include "Application/Application.h"
+#include "Utils/AssetCooker.h"
+#include "Utils/ObjParser.h"
 
 int main(int argc, char** args) {
 	Logger::Init();
 
+	// --cook <manifest> [output] converts all the assets in a manifest without starting the application,
+	// so it can be run headless as part of a build
+	if (argc >= 3 && strcmp(args[1], "--cook") == 0) {
+		int failures = AssetCooker::CookManifest(args[2], argc >= 4 ? args[3] : "");
+		Logger::Uninitialize();
+		return failures == 0 ? 0 : 1;
+	}
+
+	// --bench-obj <files...> times the OBJ parser on the given files, for comparing parser changes
+	if (argc >= 3 && strcmp(args[1], "--bench-obj") == 0) {
+		int failures = ObjParser::Benchmark(std::vector<std::string>(args + 2, args + argc));
+		Logger::Uninitialize();
+		return failures == 0 ? 0 : 1;
+	}
+
 	// TODO: parse arguments?
 
 	Application::Start(argc, args);